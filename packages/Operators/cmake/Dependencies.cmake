@@ -0,0 +1,11 @@
+TRIBITS_PACKAGE_DEFINE_DEPENDENCIES(
+  LIB_REQUIRED_PACKAGES
+  DataTransferKitUtils
+  DataTransferKitInterface
+  DataTransferKitSearch
+  Kokkos
+  Teuchos
+  Tpetra
+  LIB_REQUIRED_TPLS
+  Boost
+  )
@@ -0,0 +1,241 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+// Measure the throughput of the nearest-neighbor transfer between matching
+// node sets. The target points are the source nodes of the next process,
+// shuffled and slightly perturbed, so that every value crosses the network.
+// Applying the operator is a pure gather so that its throughput should be
+// bound by the memory and network bandwidth, e.g.
+//
+//   mpirun -np 4 nearest_neighbor --n-nodes=1000000 --n-components=3
+//
+// The times reported are the maximum over all the processes.
+
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_CommandLineProcessor.hpp>
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_GlobalMPISession.hpp>
+#include <Teuchos_StandardCatchMacros.hpp>
+#include <Teuchos_Time.hpp>
+
+#include <Kokkos_DefaultNode.hpp>
+
+#include <DTK_ConfigDefs.hpp>
+
+#include <DTK_NearestNeighborOperator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// n random points in the slab of process rank, the generator only depends on
+// rank so that any process can regenerate the points of another one
+std::vector<std::array<double, 3>> makeSlab( int rank, int n, double L,
+                                             double h )
+{
+    std::default_random_engine generator( rank );
+    std::uniform_real_distribution<double> distribution( 0., L );
+    std::uniform_real_distribution<double> distribution_z( rank * h,
+                                                           ( rank + 1 ) * h );
+    std::vector<std::array<double, 3>> points( n );
+    for ( int i = 0; i < n; ++i )
+    {
+        double const x = distribution( generator );
+        double const y = distribution( generator );
+        double const z = distribution_z( generator );
+        points[i] = {{x, y, z}};
+    }
+    return points;
+}
+
+template <class NO>
+int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
+{
+    using DeviceType = typename NO::device_type;
+
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    int n = 100000;
+    int n_components = 1;
+    int n_repeats = 10;
+
+    clp.setOption( "n-nodes", &n, "number of source nodes per process." );
+    clp.setOption( "n-components", &n_components,
+                   "number of components of the field." );
+    clp.setOption( "repeats", &n_repeats,
+                   "number of times the operator is applied." );
+
+    clp.recogniseAllOptions( true );
+    switch ( clp.parse( argc, argv ) )
+    {
+    case Teuchos::CommandLineProcessor::PARSE_HELP_PRINTED:
+        return EXIT_SUCCESS;
+    case Teuchos::CommandLineProcessor::PARSE_ERROR:
+    case Teuchos::CommandLineProcessor::PARSE_UNRECOGNIZED_OPTION:
+        return EXIT_FAILURE;
+    case Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL:
+        break;
+    }
+
+    // The nodes are random within a cube of unit density split into slabs
+    // along the z-axis, one per process.
+    double const L = std::cbrt( static_cast<double>( n ) * comm_size );
+    double const h = L / comm_size;
+    int const next_rank = ( comm_rank + 1 ) % comm_size;
+    auto const nodes = makeSlab( comm_rank, n, L, h );
+    auto const next_nodes = makeSlab( next_rank, n, L, h );
+    std::vector<int> permutation( n );
+    std::iota( permutation.begin(), permutation.end(), 0 );
+    std::shuffle( permutation.begin(), permutation.end(),
+                  std::default_random_engine( comm_size + comm_rank ) );
+
+    DataTransferKit::NodeList<Kokkos::LayoutLeft, DeviceType> source;
+    source.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n, 3 );
+    DataTransferKit::EvaluationSet<Kokkos::LayoutLeft, DeviceType> target;
+    target.evaluation_points =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "evaluation_points", n, 3 );
+    auto coordinates_host = Kokkos::create_mirror_view( source.coordinates );
+    auto evaluation_points_host =
+        Kokkos::create_mirror_view( target.evaluation_points );
+    for ( int i = 0; i < n; ++i )
+        for ( int d = 0; d < 3; ++d )
+        {
+            coordinates_host( i, d ) = nodes[i][d];
+            evaluation_points_host( i, d ) =
+                next_nodes[permutation[i]][d] + 1e-6;
+        }
+    Kokkos::deep_copy( source.coordinates, coordinates_host );
+    Kokkos::deep_copy( target.evaluation_points, evaluation_points_host );
+
+    Kokkos::View<double **, DeviceType> source_values( "source_values", n,
+                                                       n_components );
+    Kokkos::View<double **, DeviceType> target_values( "target_values", n,
+                                                       n_components );
+    Kokkos::deep_copy( source_values, 1. );
+
+    DataTransferKit::NearestNeighborOperator<DeviceType> nearest_neighbor(
+        comm );
+    comm->barrier();
+    double start = Teuchos::Time::wallTime();
+    nearest_neighbor.setup( source, target );
+    double const setup = Teuchos::Time::wallTime() - start;
+
+    comm->barrier();
+    start = Teuchos::Time::wallTime();
+    for ( int i = 0; i < n_repeats; ++i )
+        nearest_neighbor.apply( source_values, target_values );
+    double const apply = ( Teuchos::Time::wallTime() - start ) / n_repeats;
+
+    double const local_times[2] = {setup, apply};
+    double max_times[2];
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_MAX, 2, local_times,
+                        max_times );
+    // every value is read once on the source side and written once on the
+    // target side
+    double const gigabytes = 2. * comm_size * n * n_components *
+                             sizeof( double ) / ( 1024. * 1024. * 1024. );
+    if ( comm_rank == 0 )
+        std::cout << comm_size << " processes, " << n << " nodes and "
+                  << n_components << " components per process\n"
+                  << "setup " << max_times[0] << " s, apply " << max_times[1]
+                  << " s, " << gigabytes / max_times[1] << " GB/s"
+                  << std::endl;
+
+    return 0;
+}
+
+int main( int argc, char *argv[] )
+{
+    Teuchos::GlobalMPISession mpi_session( &argc, &argv );
+    Kokkos::initialize( argc, argv );
+
+    bool success = false;
+    bool verbose = true;
+
+    int rv = 0;
+    try
+    {
+        const bool throwExceptions = false;
+
+        Teuchos::CommandLineProcessor clp( throwExceptions );
+
+        std::string node = "";
+        clp.setOption( "node", &node, "node type (serial | openmp | cuda)" );
+
+        clp.recogniseAllOptions( false );
+        switch ( clp.parse( argc, argv, NULL ) )
+        {
+        case Teuchos::CommandLineProcessor::PARSE_ERROR:
+            rv = 1;
+        case Teuchos::CommandLineProcessor::PARSE_HELP_PRINTED:
+        case Teuchos::CommandLineProcessor::PARSE_UNRECOGNIZED_OPTION:
+        case Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL:
+            break;
+        }
+
+        if ( rv )
+        {
+            // do nothing, just skip other if clauses
+        }
+        else if ( node == "" )
+        {
+            typedef KokkosClassic::DefaultNode::DefaultNodeType Node;
+            rv = main_<Node>( clp, argc, argv );
+        }
+        else if ( node == "serial" )
+        {
+#ifdef KOKKOS_HAVE_SERIAL
+            typedef Kokkos::Compat::KokkosSerialWrapperNode Node;
+            rv = main_<Node>( clp, argc, argv );
+#else
+            throw std::runtime_error( "Serial node type is disabled" );
+#endif
+        }
+        else if ( node == "openmp" )
+        {
+#ifdef KOKKOS_HAVE_OPENMP
+            typedef Kokkos::Compat::KokkosOpenMPWrapperNode Node;
+            rv = main_<Node>( clp, argc, argv );
+#else
+            throw std::runtime_error( "OpenMP node type is disabled" );
+#endif
+        }
+        else if ( node == "cuda" )
+        {
+#ifdef KOKKOS_HAVE_CUDA
+            typedef Kokkos::Compat::KokkosCudaWrapperNode Node;
+            rv = main_<Node>( clp, argc, argv );
+#else
+            throw std::runtime_error( "CUDA node type is disabled" );
+#endif
+        }
+        else
+        {
+            throw std::runtime_error( "Unrecognized node type" );
+        }
+
+        if ( rv )
+            success = false;
+    }
+    TEUCHOS_STANDARD_CATCH_STATEMENTS( verbose, std::cerr, success );
+
+    Kokkos::finalize();
+
+    return ( success ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,188 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_BOUNDING_BOXES_HPP
+#define DTK_BOUNDING_BOXES_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsConnectivity.hpp>
+#include <DTK_PolyhedronList.hpp>
+
+#include <Kokkos_Core.hpp>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// Expand the box to include the node of the given index, of which only the
+// first dim coordinates are set.
+template <typename Coordinates>
+KOKKOS_INLINE_FUNCTION void expandByNode( Box &box,
+                                          Coordinates const &coordinates,
+                                          int node, int dim )
+{
+    for ( int d = 0; d < dim; ++d )
+    {
+        double const x = coordinates( node, d );
+        if ( x < box[2 * d] )
+            box[2 * d] = x;
+        if ( x > box[2 * d + 1] )
+            box[2 * d + 1] = x;
+    }
+}
+
+// Zero the missing coordinates of a box computed from nodes of dimension dim
+// and enlarge it by inflation in every direction.
+KOKKOS_INLINE_FUNCTION
+void inflate( Box &box, int dim, double inflation )
+{
+    for ( int d = 0; d < 3; ++d )
+    {
+        if ( d >= dim )
+        {
+            box[2 * d] = 0.;
+            box[2 * d + 1] = 0.;
+        }
+        box[2 * d] -= inflation;
+        box[2 * d + 1] += inflation;
+    }
+}
+}
+
+/**
+ * Bounding boxes of the cells of the input lists, computed on the device
+ * from the connectivity so that they can be passed to the constructor of a
+ * BVH or of a DistributedSearchTree as they are. Each box is enlarged by
+ * inflation in every direction, e.g. to catch the points that lie on the
+ * boundary of the cells up to some tolerance. Missing coordinates of two
+ * dimensional lists are zero.
+ */
+
+// Cells of a single topology, cell_list.cells is rank-2.
+template <typename DeviceType, class... ViewProperties>
+void computeBoundingBoxes( CellList<ViewProperties...> const &cell_list,
+                           Kokkos::View<Box *, DeviceType> boxes,
+                           double inflation = 0. )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = cell_list.coordinates;
+    auto const cells = cell_list.cells;
+    DTK_REQUIRE( cells.rank() == 2 );
+    int const n_cells = cells.extent( 0 );
+    int const nodes_per_cell = cells.extent( 1 );
+    int const dim = coordinates.extent( 1 );
+    DTK_REQUIRE( static_cast<int>( boxes.extent( 0 ) ) == n_cells );
+    DTK_REQUIRE( n_cells == 0 || dim <= 3 );
+    DTK_REQUIRE( inflation >= 0. );
+
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_cell_bounding_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int c ) {
+            Box box;
+            for ( int k = 0; k < nodes_per_cell; ++k )
+                Details::expandByNode( box, coordinates, cells( c, k ), dim );
+            Details::inflate( box, dim, inflation );
+            boxes( c ) = box;
+        } );
+    Kokkos::fence();
+}
+
+// Cells of mixed topologies, cell_list.cells is rank-1 and the cell c has
+// nodes_per_topology(cell_list.cell_topology_ids(c)) nodes. The box of a cell
+// without any node is empty.
+template <typename DeviceType, class... ViewProperties>
+void computeBoundingBoxes(
+    CellList<ViewProperties...> const &cell_list,
+    Kokkos::View<unsigned *, DeviceType> nodes_per_topology,
+    Kokkos::View<Box *, DeviceType> boxes, double inflation = 0. )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = cell_list.coordinates;
+    auto const cells = cell_list.cells;
+    auto const cell_topology_ids = cell_list.cell_topology_ids;
+    DTK_REQUIRE( cells.rank() == 1 );
+    int const n_cells = cell_topology_ids.extent( 0 );
+    int const dim = coordinates.extent( 1 );
+    DTK_REQUIRE( static_cast<int>( boxes.extent( 0 ) ) == n_cells );
+    DTK_REQUIRE( n_cells == 0 || dim <= 3 );
+    DTK_REQUIRE( inflation >= 0. );
+
+    auto const cell_offset = Details::computeOffsets<DeviceType>(
+        "cell_offset", n_cells, KOKKOS_LAMBDA( int c ) {
+            return static_cast<int>(
+                nodes_per_topology( cell_topology_ids( c ) ) );
+        } );
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_cell_bounding_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int c ) {
+            Box box;
+            for ( int k = cell_offset( c ); k < cell_offset( c + 1 ); ++k )
+                Details::expandByNode( box, coordinates, cells( k ), dim );
+            Details::inflate( box, dim, inflation );
+            boxes( c ) = box;
+        } );
+    Kokkos::fence();
+}
+
+// Polyhedra, the box of a cell is that of the nodes of its faces.
+template <typename DeviceType, class... ViewProperties>
+void computeBoundingBoxes( PolyhedronList<ViewProperties...> const &polyhedra,
+                           Kokkos::View<Box *, DeviceType> boxes,
+                           double inflation = 0. )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = polyhedra.coordinates;
+    auto const faces = polyhedra.faces;
+    auto const cells = polyhedra.cells;
+    auto const nodes_per_face = polyhedra.nodes_per_face;
+    auto const faces_per_cell = polyhedra.faces_per_cell;
+    int const n_cells = faces_per_cell.extent( 0 );
+    int const dim = coordinates.extent( 1 );
+    DTK_REQUIRE( static_cast<int>( boxes.extent( 0 ) ) == n_cells );
+    DTK_REQUIRE( n_cells == 0 || dim <= 3 );
+    DTK_REQUIRE( inflation >= 0. );
+
+    auto const face_offset = Details::computeOffsets<DeviceType>(
+        "face_offset", nodes_per_face.extent( 0 ),
+        KOKKOS_LAMBDA( int f ) {
+            return static_cast<int>( nodes_per_face( f ) );
+        } );
+    auto const cell_offset = Details::computeOffsets<DeviceType>(
+        "cell_offset", n_cells, KOKKOS_LAMBDA( int c ) {
+            return static_cast<int>( faces_per_cell( c ) );
+        } );
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_polyhedron_bounding_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int c ) {
+            Box box;
+            for ( int l = cell_offset( c ); l < cell_offset( c + 1 ); ++l )
+            {
+                int const face = cells( l );
+                for ( int m = face_offset( face ); m < face_offset( face + 1 );
+                      ++m )
+                    Details::expandByNode( box, coordinates, faces( m ), dim );
+            }
+            Details::inflate( box, dim, inflation );
+            boxes( c ) = box;
+        } );
+    Kokkos::fence();
+}
+
+} // end namespace DataTransferKit
+
+#endif
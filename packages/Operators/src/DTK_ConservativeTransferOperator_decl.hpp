@@ -0,0 +1,104 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_CONSERVATIVE_TRANSFER_OPERATOR_DECL_HPP
+#define DTK_CONSERVATIVE_TRANSFER_OPERATOR_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsCellPacking.hpp>
+#include <DTK_DetailsReferenceCell.hpp>
+#include <DTK_Map.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Conservative transfer of a cell-wise constant field, e.g. the cell averages
+ * of a density. The value on a target cell is the sum of the values of the
+ * source cells weighted by the volume of their intersection with the target
+ * cell divided by the volume of the target cell. The integral of the field
+ * is preserved over the part of the source mesh covered by the target mesh.
+ *
+ * setup() finds the candidate pairs of source and target cells with an
+ * overlap search of their bounding boxes and fetches the geometry of the
+ * candidate source cells from their owners. Both cells of a pair are split
+ * into tetrahedra and the exact volumes of the intersections of the
+ * tetrahedra are computed by clipping, one thread per candidate pair. Pairs
+ * that do not intersect are dropped from the sparse operator of the Map.
+ *
+ * The source and target cells each have a single topology, tetrahedra,
+ * hexahedra, wedges or pyramids, not necessarily the same. The faces of the
+ * cells are assumed to be planar.
+ */
+template <typename DeviceType>
+class ConservativeTransferOperator : public Map<DeviceType>
+{
+  public:
+    explicit ConservativeTransferOperator(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm )
+        : Map<DeviceType>( comm )
+    {
+    }
+
+    // The rows of the operator are the cells of target on this process and
+    // the source values are given per cell of source. Collective.
+    template <class... ViewProperties>
+    void setup( CellList<ViewProperties...> const &source,
+                CellList<ViewProperties...> const &target );
+
+    // Fraction of the volume of each target cell on this process that is
+    // covered by source cells, one inside of the source mesh. Dividing the
+    // transferred values by it gives the average over the covered part
+    // instead, at the expense of conservation.
+    Kokkos::View<double *, DeviceType> getCoveredFraction() const
+    {
+        return _covered_fraction;
+    }
+
+  private:
+    void build( Details::CellTopology source_topology,
+                Kokkos::View<Box const *, DeviceType> source_boxes,
+                Kokkos::View<double **, DeviceType> source_node_coordinates,
+                Details::CellTopology target_topology,
+                Kokkos::View<Box const *, DeviceType> target_boxes,
+                Kokkos::View<double **, DeviceType> target_node_coordinates );
+
+    Kokkos::View<double *, DeviceType> _covered_fraction;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void ConservativeTransferOperator<DeviceType>::setup(
+    CellList<ViewProperties...> const &source,
+    CellList<ViewProperties...> const &target )
+{
+    Details::CellTopology source_topology;
+    Kokkos::View<Box *, DeviceType> source_boxes;
+    Kokkos::View<double **, DeviceType> source_node_coordinates;
+    Details::packCells( *this->_comm, source, source_topology, source_boxes,
+                        source_node_coordinates );
+
+    Details::CellTopology target_topology;
+    Kokkos::View<Box *, DeviceType> target_boxes;
+    Kokkos::View<double **, DeviceType> target_node_coordinates;
+    Details::packCells( *this->_comm, target, target_topology, target_boxes,
+                        target_node_coordinates );
+
+    build( source_topology, source_boxes, source_node_coordinates,
+           target_topology, target_boxes, target_node_coordinates );
+}
+
+} // end namespace DataTransferKit
+
+#endif
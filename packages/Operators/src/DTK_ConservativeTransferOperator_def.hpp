@@ -0,0 +1,229 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_CONSERVATIVE_TRANSFER_OPERATOR_DEF_HPP
+#define DTK_CONSERVATIVE_TRANSFER_OPERATOR_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsAlgorithms.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DetailsTetrahedronIntersection.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+void ConservativeTransferOperator<DeviceType>::build(
+    Details::CellTopology source_topology,
+    Kokkos::View<Box const *, DeviceType> source_boxes,
+    Kokkos::View<double **, DeviceType> source_node_coordinates,
+    Details::CellTopology target_topology,
+    Kokkos::View<Box const *, DeviceType> target_boxes,
+    Kokkos::View<double **, DeviceType> target_node_coordinates )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    DistributedSearchTree<DeviceType> tree( this->_comm, source_boxes );
+
+    int const n_targets = target_boxes.extent( 0 );
+    Kokkos::View<Details::Overlap *, DeviceType> queries( "queries",
+                                                          n_targets );
+    Kokkos::parallel_for( REGION_NAME( "register_overlap_queries" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              queries( i ) =
+                                  Details::overlap( target_boxes( i ) );
+                          } );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    // fetch the nodes of the candidate source cells, the candidate cell j
+    // has the nodes n_source_nodes * j + k
+    int const n_candidates = indices.extent( 0 );
+    int const n_source_nodes = Details::nodesPerCell( source_topology );
+    Kokkos::View<int *, DeviceType> node_ranks(
+        "node_ranks", n_candidates * n_source_nodes );
+    Kokkos::View<int *, DeviceType> node_indices(
+        "node_indices", n_candidates * n_source_nodes );
+    Kokkos::View<int *, DeviceType> query_ids( "query_ids", n_candidates );
+    Kokkos::parallel_for(
+        REGION_NAME( "register_candidates" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+        KOKKOS_LAMBDA( int i ) {
+            for ( int j = offset( i ); j < offset( i + 1 ); ++j )
+            {
+                query_ids( j ) = i;
+                for ( int k = 0; k < n_source_nodes; ++k )
+                {
+                    node_ranks( n_source_nodes * j + k ) = ranks( j );
+                    node_indices( n_source_nodes * j + k ) =
+                        n_source_nodes * indices( j ) + k;
+                }
+            }
+        } );
+    Kokkos::fence();
+    CommunicationPlan<DeviceType> plan( this->_comm, node_ranks,
+                                        node_indices );
+    Kokkos::View<double **, DeviceType> candidate_coordinates(
+        "candidate_coordinates", n_candidates * n_source_nodes, 3 );
+    plan.doExchange( source_node_coordinates, candidate_coordinates );
+
+    int const n_target_nodes = Details::nodesPerCell( target_topology );
+    int const n_source_tetrahedra =
+        Details::numberOfSubTetrahedra( source_topology );
+    int const n_target_tetrahedra =
+        Details::numberOfSubTetrahedra( target_topology );
+    Kokkos::View<double *, DeviceType> target_volumes( "target_volumes",
+                                                       n_targets );
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_target_volumes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+        KOKKOS_LAMBDA( int i ) {
+            double volume = 0.;
+            for ( int t = 0; t < n_target_tetrahedra; ++t )
+            {
+                Point v[4];
+                for ( int k = 0; k < 4; ++k )
+                {
+                    int const node =
+                        n_target_nodes * i +
+                        Details::subTetrahedronNode( target_topology, t, k );
+                    for ( int d = 0; d < 3; ++d )
+                        v[k][d] = target_node_coordinates( node, d );
+                }
+                volume += std::abs( Details::signedTetrahedronVolume(
+                    v[0], v[1], v[2], v[3] ) );
+            }
+            target_volumes( i ) = volume;
+        } );
+
+    // All the candidate pairs are intersected in a single batch, one thread
+    // per pair. The tetrahedra of the two cells are gathered in registers
+    // and the pairs of tetrahedra whose bounding boxes do not overlap are
+    // skipped.
+    Kokkos::View<double *, DeviceType> intersection_volumes(
+        "intersection_volumes", n_candidates );
+    Kokkos::parallel_for(
+        REGION_NAME( "intersect_candidate_cells" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_candidates ),
+        KOKKOS_LAMBDA( int j ) {
+            int const i = query_ids( j );
+            double volume = 0.;
+            for ( int t = 0; t < n_target_tetrahedra; ++t )
+            {
+                Point a[4];
+                Box a_box;
+                for ( int k = 0; k < 4; ++k )
+                {
+                    int const node =
+                        n_target_nodes * i +
+                        Details::subTetrahedronNode( target_topology, t, k );
+                    for ( int d = 0; d < 3; ++d )
+                        a[k][d] = target_node_coordinates( node, d );
+                    Details::expand( a_box, {{a[k][0], a[k][0], a[k][1],
+                                              a[k][1], a[k][2], a[k][2]}} );
+                }
+                for ( int s = 0; s < n_source_tetrahedra; ++s )
+                {
+                    Point b[4];
+                    Box b_box;
+                    for ( int k = 0; k < 4; ++k )
+                    {
+                        int const node =
+                            n_source_nodes * j +
+                            Details::subTetrahedronNode( source_topology, s,
+                                                         k );
+                        for ( int d = 0; d < 3; ++d )
+                            b[k][d] = candidate_coordinates( node, d );
+                        Details::expand( b_box,
+                                         {{b[k][0], b[k][0], b[k][1], b[k][1],
+                                           b[k][2], b[k][2]}} );
+                    }
+                    if ( Details::overlaps( a_box, b_box ) )
+                        volume += Details::intersectionVolume( a, b );
+                }
+            }
+            intersection_volumes( j ) = volume;
+        } );
+    Kokkos::fence();
+
+    // Keep the pairs that intersect, those whose bounding boxes merely
+    // overlap or that only share a face have a volume of zero up to the
+    // round-off.
+    double const tolerance = 1e-12;
+    _covered_fraction =
+        Kokkos::View<double *, DeviceType>( "covered_fraction", n_targets );
+    auto const covered_fraction = _covered_fraction;
+    Kokkos::View<int *, DeviceType> row_offset( "row_offset", n_targets + 1 );
+    Kokkos::parallel_scan(
+        REGION_NAME( "compute_row_offset" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets + 1 ),
+        KOKKOS_LAMBDA( int i, int &update, bool final_pass ) {
+            if ( final_pass )
+                row_offset( i ) = update;
+            if ( i == n_targets )
+                return;
+            int count_i = 0;
+            double covered_volume = 0.;
+            for ( int j = offset( i ); j < offset( i + 1 ); ++j )
+                if ( intersection_volumes( j ) >
+                     tolerance * target_volumes( i ) )
+                {
+                    ++count_i;
+                    covered_volume += intersection_volumes( j );
+                }
+            if ( final_pass )
+                covered_fraction( i ) = covered_volume / target_volumes( i );
+            update += count_i;
+        } );
+    Kokkos::fence();
+
+    auto n_entries = Kokkos::subview( row_offset, n_targets );
+    auto n_entries_host = Kokkos::create_mirror_view( n_entries );
+    Kokkos::deep_copy( n_entries_host, n_entries );
+    Kokkos::View<int *, DeviceType> entry_indices( "entry_indices",
+                                                   n_entries_host( 0 ) );
+    Kokkos::View<int *, DeviceType> entry_ranks( "entry_ranks",
+                                                 n_entries_host( 0 ) );
+    Kokkos::View<double *, DeviceType> weights( "weights",
+                                                n_entries_host( 0 ) );
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_weights" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+        KOKKOS_LAMBDA( int i ) {
+            int entry = row_offset( i );
+            for ( int j = offset( i ); j < offset( i + 1 ); ++j )
+                if ( intersection_volumes( j ) >
+                     tolerance * target_volumes( i ) )
+                {
+                    entry_indices( entry ) = indices( j );
+                    entry_ranks( entry ) = ranks( j );
+                    weights( entry ) =
+                        intersection_volumes( j ) / target_volumes( i );
+                    ++entry;
+                }
+        } );
+    Kokkos::fence();
+
+    this->setOperator( row_offset, entry_indices, entry_ranks, weights );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_CONSERVATIVETRANSFEROPERATOR_INSTANT( NODE )                       \
+    template class ConservativeTransferOperator<typename NODE::device_type>;
+
+#endif
@@ -0,0 +1,132 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_CONSISTENT_INTERPOLATION_OPERATOR_DECL_HPP
+#define DTK_CONSISTENT_INTERPOLATION_OPERATOR_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DOFMap.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsCellPacking.hpp>
+#include <DTK_DetailsReferenceCell.hpp>
+#include <DTK_EvaluationSet.hpp>
+#include <DTK_Map.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Consistent interpolation of a finite element field. The value at a target
+ * point is the value of the source field at that point, i.e. the sum of the
+ * degrees of freedom of the source cell that contains it weighted by the
+ * basis functions of that cell evaluated at the point.
+ *
+ * setup() finds the candidate cells of each target point with an overlap
+ * search of the bounding boxes of the cells, fetches their geometry from
+ * their owners and keeps the first one that actually contains the point.
+ * The values of the basis functions at its reference coordinates are stored
+ * in the sparse operator of the Map against the degrees of freedom of the
+ * cell, so that apply() never calls back into the application. Target points
+ * outside of the source mesh get zero.
+ *
+ * The cells must all have the same topology, tetrahedra, hexahedra, wedges
+ * or pyramids, with one degree of freedom per node.
+ */
+template <typename DeviceType>
+class ConsistentInterpolationOperator : public Map<DeviceType>
+{
+  public:
+    explicit ConsistentInterpolationOperator(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm )
+        : Map<DeviceType>( comm )
+    {
+    }
+
+    // dof_map.object_dof_ids(c, k) is the degree of freedom of the source
+    // field attached to the k-th node of cell c of source. Collective.
+    template <class... ViewProperties>
+    void setup( CellList<ViewProperties...> const &source,
+                DOFMap<ViewProperties...> const &dof_map,
+                EvaluationSet<ViewProperties...> const &target );
+
+    // Whether each target point on this process lies in a source cell.
+    Kokkos::View<bool *, DeviceType> getFound() const { return _found; }
+
+  private:
+    // node_coordinates(n_nodes * c + k, d) is the d-th coordinate of the
+    // k-th node of cell c and node_dofs(n_nodes * c + k) its degree of
+    // freedom, n_nodes being the number of nodes per cell.
+    void build( Details::CellTopology topology,
+                Kokkos::View<Box const *, DeviceType> cell_boxes,
+                Kokkos::View<double **, DeviceType> node_coordinates,
+                Kokkos::View<int *, DeviceType> node_dofs,
+                Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>
+                    target_points );
+
+    Kokkos::View<bool *, DeviceType> _found;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void ConsistentInterpolationOperator<DeviceType>::setup(
+    CellList<ViewProperties...> const &source,
+    DOFMap<ViewProperties...> const &dof_map,
+    EvaluationSet<ViewProperties...> const &target )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const cells = source.cells;
+    auto const object_dof_ids = dof_map.object_dof_ids;
+    DTK_REQUIRE( object_dof_ids.rank() == 2 );
+    int const n_cells = cells.extent( 0 );
+    DTK_REQUIRE( static_cast<int>( object_dof_ids.extent( 0 ) ) == n_cells );
+    DTK_REQUIRE( static_cast<int>( object_dof_ids.extent( 1 ) ) ==
+                 static_cast<int>( cells.extent( 1 ) ) );
+
+    Details::CellTopology topology;
+    Kokkos::View<Box *, DeviceType> cell_boxes;
+    Kokkos::View<double **, DeviceType> node_coordinates;
+    Details::packCells( *this->_comm, source, topology, cell_boxes,
+                        node_coordinates );
+    int const n_nodes = Details::nodesPerCell( topology );
+    Kokkos::View<int *, DeviceType> node_dofs( "node_dofs",
+                                               n_cells * n_nodes );
+    Kokkos::parallel_for( REGION_NAME( "pack_dofs" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+                          KOKKOS_LAMBDA( int c ) {
+                              for ( int k = 0; k < n_nodes; ++k )
+                                  node_dofs( n_nodes * c + k ) =
+                                      object_dof_ids( c, k );
+                          } );
+
+    auto const evaluation_points = target.evaluation_points;
+    int const n_targets = evaluation_points.extent( 0 );
+    DTK_REQUIRE( n_targets == 0 || evaluation_points.extent( 1 ) == 3 );
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> target_points(
+        "target_points", n_targets, 3 );
+    Kokkos::parallel_for( REGION_NAME( "copy_points" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              for ( int d = 0; d < 3; ++d )
+                                  target_points( i, d ) =
+                                      evaluation_points( i, d );
+                          } );
+    Kokkos::fence();
+
+    build( topology, cell_boxes, node_coordinates, node_dofs, target_points );
+}
+
+} // end namespace DataTransferKit
+
+#endif
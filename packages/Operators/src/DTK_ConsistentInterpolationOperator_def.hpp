@@ -0,0 +1,177 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_CONSISTENT_INTERPOLATION_OPERATOR_DEF_HPP
+#define DTK_CONSISTENT_INTERPOLATION_OPERATOR_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsPointInCell.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+void ConsistentInterpolationOperator<DeviceType>::build(
+    Details::CellTopology topology,
+    Kokkos::View<Box const *, DeviceType> cell_boxes,
+    Kokkos::View<double **, DeviceType> node_coordinates,
+    Kokkos::View<int *, DeviceType> node_dofs,
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> target_points )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    DistributedSearchTree<DeviceType> tree( this->_comm, cell_boxes );
+
+    int const n_targets = target_points.extent( 0 );
+    Kokkos::View<Details::Overlap *, DeviceType> queries( "queries",
+                                                          n_targets );
+    Kokkos::parallel_for( REGION_NAME( "register_overlap_queries" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Box const box = {
+                                  {target_points( i, 0 ), target_points( i, 0 ),
+                                   target_points( i, 1 ), target_points( i, 1 ),
+                                   target_points( i, 2 ),
+                                   target_points( i, 2 )}};
+                              queries( i ) = Details::overlap( box );
+                          } );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    // fetch the nodes and the degrees of freedom of the candidate cells, the
+    // candidate cell j has the nodes n_nodes * j + k
+    int const n_candidates = indices.extent( 0 );
+    int const n_nodes = Details::nodesPerCell( topology );
+    Kokkos::View<int *, DeviceType> node_ranks( "node_ranks",
+                                                n_candidates * n_nodes );
+    Kokkos::View<int *, DeviceType> node_indices( "node_indices",
+                                                  n_candidates * n_nodes );
+    Kokkos::View<int *, DeviceType> query_ids( "query_ids", n_candidates );
+    Kokkos::View<int *, DeviceType> cell_ids( "cell_ids", n_candidates );
+    Kokkos::View<int **, DeviceType> candidate_cells( "candidate_cells",
+                                                      n_candidates, n_nodes );
+    Kokkos::parallel_for(
+        REGION_NAME( "register_candidates" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+        KOKKOS_LAMBDA( int i ) {
+            for ( int j = offset( i ); j < offset( i + 1 ); ++j )
+            {
+                query_ids( j ) = i;
+                cell_ids( j ) = j;
+                for ( int k = 0; k < n_nodes; ++k )
+                {
+                    node_ranks( n_nodes * j + k ) = ranks( j );
+                    node_indices( n_nodes * j + k ) =
+                        n_nodes * indices( j ) + k;
+                    candidate_cells( j, k ) = n_nodes * j + k;
+                }
+            }
+        } );
+    Kokkos::fence();
+    CommunicationPlan<DeviceType> plan( this->_comm, node_ranks,
+                                        node_indices );
+    Kokkos::View<double **, DeviceType> candidate_coordinates(
+        "candidate_coordinates", n_candidates * n_nodes, 3 );
+    plan.doExchange( node_coordinates, candidate_coordinates );
+    Kokkos::View<int *, DeviceType> candidate_dofs( "candidate_dofs",
+                                                    n_candidates * n_nodes );
+    plan.doExchange( node_dofs, candidate_dofs );
+
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> reference_points(
+        "reference_points", n_candidates, 3 );
+    Kokkos::View<bool *, DeviceType> inside( "inside", n_candidates );
+    Details::PointInCell<DeviceType>::search(
+        topology, candidate_coordinates, candidate_cells, target_points,
+        query_ids, cell_ids, reference_points, inside );
+
+    // A point on the boundary between cells belongs to the first candidate
+    // that contains it, any of them gives the same value for a continuous
+    // field.
+    Kokkos::View<int *, DeviceType> containing( "containing", n_targets );
+    Kokkos::parallel_for( REGION_NAME( "select_containing_cells" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              containing( i ) = -1;
+                              for ( int j = offset( i ); j < offset( i + 1 );
+                                    ++j )
+                                  if ( inside( j ) )
+                                  {
+                                      containing( i ) = j;
+                                      break;
+                                  }
+                          } );
+    Kokkos::fence();
+
+    _found = Kokkos::View<bool *, DeviceType>( "found", n_targets );
+    Kokkos::View<int *, DeviceType> row_offset( "row_offset", n_targets + 1 );
+    auto const found = _found;
+    Kokkos::parallel_scan(
+        REGION_NAME( "compute_row_offset" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets + 1 ),
+        KOKKOS_LAMBDA( int i, int &update, bool final_pass ) {
+            int const count_i =
+                ( i < n_targets && containing( i ) >= 0 ) ? n_nodes : 0;
+            if ( final_pass )
+            {
+                row_offset( i ) = update;
+                if ( i < n_targets )
+                    found( i ) = ( count_i > 0 );
+            }
+            update += count_i;
+        } );
+    Kokkos::fence();
+
+    auto n_entries = Kokkos::subview( row_offset, n_targets );
+    auto n_entries_host = Kokkos::create_mirror_view( n_entries );
+    Kokkos::deep_copy( n_entries_host, n_entries );
+    Kokkos::View<int *, DeviceType> entry_indices( "entry_indices",
+                                                   n_entries_host( 0 ) );
+    Kokkos::View<int *, DeviceType> entry_ranks( "entry_ranks",
+                                                 n_entries_host( 0 ) );
+    Kokkos::View<double *, DeviceType> weights( "weights",
+                                                n_entries_host( 0 ) );
+    Kokkos::parallel_for(
+        REGION_NAME( "evaluate_basis_functions" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+        KOKKOS_LAMBDA( int i ) {
+            int const j = containing( i );
+            if ( j < 0 )
+                return;
+            Point const xi = {{reference_points( j, 0 ),
+                               reference_points( j, 1 ),
+                               reference_points( j, 2 )}};
+            double values[Details::MAX_NODES_PER_CELL];
+            Details::evaluateShapeFunctions( topology, xi, values );
+            for ( int k = 0; k < n_nodes; ++k )
+            {
+                int const entry = row_offset( i ) + k;
+                entry_indices( entry ) = candidate_dofs( n_nodes * j + k );
+                entry_ranks( entry ) = ranks( j );
+                weights( entry ) = values[k];
+            }
+        } );
+    Kokkos::fence();
+
+    this->setOperator( row_offset, entry_indices, entry_ranks, weights );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_CONSISTENTINTERPOLATIONOPERATOR_INSTANT( NODE )                    \
+    template class ConsistentInterpolationOperator<typename NODE::device_type>;
+
+#endif
@@ -0,0 +1,76 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_CELL_PACKING_HPP
+#define DTK_DETAILS_CELL_PACKING_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_BoundingBoxes.hpp>
+#include <DTK_CellList.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsReferenceCell.hpp>
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_CommHelpers.hpp>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// Gather the nodes of the cells of a single topology list so that the
+// operators do not need the connectivity anymore: node_coordinates(n_nodes *
+// c + k, d) is the d-th coordinate of the k-th node of cell c, n_nodes being
+// the number of nodes per cell. cell_boxes holds the bounding boxes of the
+// cells. Collective since every process needs to agree on the topology,
+// including those that do not have any cell.
+template <typename DeviceType, class... ViewProperties>
+void packCells( Teuchos::Comm<int> const &comm,
+                CellList<ViewProperties...> const &cell_list,
+                CellTopology &topology,
+                Kokkos::View<Box *, DeviceType> &cell_boxes,
+                Kokkos::View<double **, DeviceType> &node_coordinates )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = cell_list.coordinates;
+    auto const cells = cell_list.cells;
+    DTK_REQUIRE( cells.rank() == 2 );
+    int const n_cells = cells.extent( 0 );
+    int const nodes_per_cell = cells.extent( 1 );
+    DTK_REQUIRE( n_cells == 0 || coordinates.extent( 1 ) == 3 );
+
+    int global_nodes_per_cell = 0;
+    Teuchos::reduceAll( comm, Teuchos::REDUCE_MAX, nodes_per_cell,
+                        Teuchos::ptr( &global_nodes_per_cell ) );
+    DTK_INSIST(
+        cellTopologyFromNodesPerCell( global_nodes_per_cell, topology ) );
+    DTK_REQUIRE( n_cells == 0 || nodes_per_cell == global_nodes_per_cell );
+    int const n_nodes = global_nodes_per_cell;
+
+    cell_boxes = Kokkos::View<Box *, DeviceType>( "cell_boxes", n_cells );
+    computeBoundingBoxes( cell_list, cell_boxes );
+    node_coordinates = Kokkos::View<double **, DeviceType>(
+        "node_coordinates", n_cells * n_nodes, 3 );
+    auto const packed_coordinates = node_coordinates;
+    Kokkos::parallel_for(
+        REGION_NAME( "pack_cells" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int c ) {
+            for ( int k = 0; k < n_nodes; ++k )
+                for ( int d = 0; d < 3; ++d )
+                    packed_coordinates( n_nodes * c + k, d ) =
+                        coordinates( cells( c, k ), d );
+        } );
+    Kokkos::fence();
+}
+}
+}
+
+#endif
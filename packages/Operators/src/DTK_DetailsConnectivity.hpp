@@ -0,0 +1,49 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_CONNECTIVITY_HPP
+#define DTK_DETAILS_CONNECTIVITY_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// The unstructured connectivities of the input lists (rank-1 cells of a
+// mixed topology CellList, faces and cells of a PolyhedronList) are given by
+// the number of entries of each object. Return the offsets of the objects
+// in the connectivity, i.e. offsets(i) is the sum of count(k) for k < i and
+// offsets(n) the size of the connectivity.
+template <typename DeviceType, typename Count>
+Kokkos::View<int *, DeviceType> computeOffsets( std::string const &label,
+                                                int n, Count count )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    Kokkos::View<int *, DeviceType> offsets( label, n + 1 );
+    Kokkos::parallel_scan( REGION_NAME( "compute_offsets" ),
+                           Kokkos::RangePolicy<ExecutionSpace>( 0, n + 1 ),
+                           KOKKOS_LAMBDA( int i, int &update,
+                                          bool final_pass ) {
+                               if ( final_pass )
+                                   offsets( i ) = update;
+                               if ( i < n )
+                                   update += count( i );
+                           } );
+    Kokkos::fence();
+    return offsets;
+}
+}
+}
+
+#endif
@@ -0,0 +1,117 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_MOVING_LEAST_SQUARES_HPP
+#define DTK_DETAILS_MOVING_LEAST_SQUARES_HPP
+
+#include <DTK_DetailsPoint.hpp>
+
+#include <Kokkos_Macros.hpp>
+
+#include <cmath>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// Largest number of polynomials in the basis, i.e. quadratic polynomials in
+// three dimensions. The small systems are stored in fixed size arrays so
+// that each thread solves its own system in registers.
+constexpr int MAX_BASIS_SIZE = 10;
+
+// Number of polynomials of degree at most degree in three dimensions.
+KOKKOS_INLINE_FUNCTION
+int polynomialBasisSize( int degree )
+{
+    return ( degree + 1 ) * ( degree + 2 ) * ( degree + 3 ) / 6;
+}
+
+// Evaluate the monomials of degree at most degree (0, 1 or 2) at x. The
+// constant comes first.
+KOKKOS_INLINE_FUNCTION
+void evaluatePolynomialBasis( int degree, Point const &x, double *p )
+{
+    p[0] = 1.;
+    if ( degree < 1 )
+        return;
+    for ( int d = 0; d < 3; ++d )
+        p[1 + d] = x[d];
+    if ( degree < 2 )
+        return;
+    int k = 4;
+    for ( int d = 0; d < 3; ++d )
+        for ( int e = d; e < 3; ++e )
+            p[k++] = x[d] * x[e];
+}
+
+// Wendland's compactly supported C2 function, r is the distance divided by
+// the radius of the support.
+KOKKOS_INLINE_FUNCTION
+double wendland( double r )
+{
+    if ( r >= 1. )
+        return 0.;
+    double const s = 1. - r;
+    return s * s * s * s * ( 4. * r + 1. );
+}
+
+// Solve a x = b in place for the symmetric positive semidefinite matrix a of
+// size n stored row-major with leading dimension MAX_BASIS_SIZE, using a
+// Cholesky factorization. The unknowns whose pivot is negligible compared to
+// their diagonal entry, e.g. the linear terms when all the points lie in a
+// plane, are removed from the system and set to zero. Only the lower
+// triangle of a is used and it is overwritten by the factor.
+KOKKOS_INLINE_FUNCTION
+void choleskySolve( int n, double ( *a )[MAX_BASIS_SIZE], double *b )
+{
+    double const tolerance = 1e-10;
+    bool dropped[MAX_BASIS_SIZE];
+    for ( int k = 0; k < n; ++k )
+    {
+        double const diagonal = a[k][k];
+        double pivot = diagonal;
+        for ( int l = 0; l < k; ++l )
+            pivot -= a[k][l] * a[k][l];
+        dropped[k] = !( pivot > tolerance * diagonal ) || !( diagonal > 0. );
+        if ( dropped[k] )
+        {
+            a[k][k] = 1.;
+            for ( int l = 0; l < k; ++l )
+                a[k][l] = 0.;
+            for ( int r = k + 1; r < n; ++r )
+                a[r][k] = 0.;
+            continue;
+        }
+        a[k][k] = std::sqrt( pivot );
+        for ( int r = k + 1; r < n; ++r )
+        {
+            double value = a[r][k];
+            for ( int l = 0; l < k; ++l )
+                value -= a[r][l] * a[k][l];
+            a[r][k] = value / a[k][k];
+        }
+    }
+    for ( int k = 0; k < n; ++k )
+    {
+        double value = b[k];
+        for ( int l = 0; l < k; ++l )
+            value -= a[k][l] * b[l];
+        b[k] = dropped[k] ? 0. : value / a[k][k];
+    }
+    for ( int k = n - 1; k >= 0; --k )
+    {
+        double value = b[k];
+        for ( int l = k + 1; l < n; ++l )
+            value -= a[l][k] * b[l];
+        b[k] = dropped[k] ? 0. : value / a[k][k];
+    }
+}
+}
+}
+
+#endif
@@ -0,0 +1,167 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_POINT_IN_CELL_HPP
+#define DTK_DETAILS_POINT_IN_CELL_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DetailsReferenceCell.hpp>
+
+#include <Kokkos_Core.hpp>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// One thread per pair of a point and a candidate cell. The nodes of the cell
+// are gathered in registers and the Newton iterations run without touching
+// global memory.
+template <CellTopology topology, typename DeviceType, typename Coordinates,
+          typename Cells, typename Points>
+class MapToReferenceCellFunctor
+{
+  public:
+    MapToReferenceCellFunctor(
+        Coordinates coordinates, Cells cells, Points points,
+        Kokkos::View<int const *, DeviceType> query_ids,
+        Kokkos::View<int const *, DeviceType> cell_ids,
+        Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>
+            reference_points,
+        Kokkos::View<bool *, DeviceType> inside, double tolerance )
+        : _coordinates( coordinates )
+        , _cells( cells )
+        , _points( points )
+        , _query_ids( query_ids )
+        , _cell_ids( cell_ids )
+        , _reference_points( reference_points )
+        , _inside( inside )
+        , _tolerance( tolerance )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( int const j ) const
+    {
+        using Cell = ReferenceCell<topology>;
+        int const cell = _cell_ids( j );
+        double nodes[Cell::n_nodes][3];
+        for ( int k = 0; k < Cell::n_nodes; ++k )
+        {
+            int const node = _cells( cell, k );
+            for ( int d = 0; d < 3; ++d )
+                nodes[k][d] = _coordinates( node, d );
+        }
+        int const i = _query_ids( j );
+        Point const x = {{_points( i, 0 ), _points( i, 1 ), _points( i, 2 )}};
+        Point xi;
+        bool const converged = mapToReferenceCell<topology>( nodes, x, xi );
+        for ( int d = 0; d < 3; ++d )
+            _reference_points( j, d ) = xi[d];
+        _inside( j ) = converged && Cell::contains( xi, _tolerance );
+    }
+
+  private:
+    Coordinates _coordinates;
+    Cells _cells;
+    Points _points;
+    Kokkos::View<int const *, DeviceType> _query_ids;
+    Kokkos::View<int const *, DeviceType> _cell_ids;
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> _reference_points;
+    Kokkos::View<bool *, DeviceType> _inside;
+    double _tolerance;
+};
+
+template <typename DeviceType>
+struct PointInCell
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // For each pair j of a point and a candidate cell, e.g. as returned by
+    // an overlap search of the bounding boxes of the cells, compute the
+    // reference coordinates of the point points(query_ids(j), :) in the cell
+    // cell_ids(j) of the cell list given by coordinates and cells, and
+    // whether the point lies inside of it up to tolerance.
+    //
+    // The reference coordinates are returned in structure-of-arrays form,
+    // reference_points(j, d) being contiguous in j, so that neighboring
+    // threads access neighboring addresses.
+    template <typename Coordinates, typename Cells, typename Points>
+    static void
+    search( CellTopology topology, Coordinates coordinates, Cells cells,
+            Points points, Kokkos::View<int const *, DeviceType> query_ids,
+            Kokkos::View<int const *, DeviceType> cell_ids,
+            Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>
+                reference_points,
+            Kokkos::View<bool *, DeviceType> inside,
+            double tolerance = 1e-10 )
+    {
+        int const n_pairs = query_ids.extent( 0 );
+        DTK_REQUIRE( cell_ids.extent( 0 ) == query_ids.extent( 0 ) );
+        DTK_REQUIRE( static_cast<int>( reference_points.extent( 0 ) ) ==
+                     n_pairs );
+        DTK_REQUIRE( n_pairs == 0 || reference_points.extent( 1 ) == 3 );
+        DTK_REQUIRE( static_cast<int>( inside.extent( 0 ) ) == n_pairs );
+        DTK_REQUIRE( n_pairs == 0 ||
+                     static_cast<int>( cells.extent( 1 ) ) ==
+                         nodesPerCell( topology ) );
+
+        switch ( topology )
+        {
+        case CellTopology::TET4:
+            launch<CellTopology::TET4>( coordinates, cells, points,
+                                        query_ids, cell_ids,
+                                        reference_points, inside, tolerance );
+            break;
+        case CellTopology::HEX8:
+            launch<CellTopology::HEX8>( coordinates, cells, points,
+                                        query_ids, cell_ids,
+                                        reference_points, inside, tolerance );
+            break;
+        case CellTopology::WEDGE6:
+            launch<CellTopology::WEDGE6>( coordinates, cells, points,
+                                          query_ids, cell_ids,
+                                          reference_points, inside,
+                                          tolerance );
+            break;
+        case CellTopology::PYRAMID5:
+            launch<CellTopology::PYRAMID5>( coordinates, cells, points,
+                                            query_ids, cell_ids,
+                                            reference_points, inside,
+                                            tolerance );
+            break;
+        }
+    }
+
+  private:
+    template <CellTopology topology, typename Coordinates, typename Cells,
+              typename Points>
+    static void
+    launch( Coordinates coordinates, Cells cells, Points points,
+            Kokkos::View<int const *, DeviceType> query_ids,
+            Kokkos::View<int const *, DeviceType> cell_ids,
+            Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>
+                reference_points,
+            Kokkos::View<bool *, DeviceType> inside, double tolerance )
+    {
+        MapToReferenceCellFunctor<topology, DeviceType, Coordinates, Cells,
+                                  Points>
+            functor( coordinates, cells, points, query_ids, cell_ids,
+                     reference_points, inside, tolerance );
+        Kokkos::parallel_for(
+            REGION_NAME( "map_to_reference_cell" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, query_ids.extent( 0 ) ),
+            functor );
+        Kokkos::fence();
+    }
+};
+}
+}
+
+#endif
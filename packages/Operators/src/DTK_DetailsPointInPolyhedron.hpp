@@ -0,0 +1,180 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_POINT_IN_POLYHEDRON_HPP
+#define DTK_DETAILS_POINT_IN_POLYHEDRON_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsConnectivity.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DetailsTriangle.hpp>
+#include <DTK_PolyhedronList.hpp>
+
+#include <Kokkos_ArithTraits.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <cmath>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// One thread per pair of a point and a candidate polyhedron. Each face is
+// split into the triangles joining its edges to its centroid, which closes
+// the surface even if the faces are not planar since the centroid of a face
+// is the same for both cells that share it.
+template <typename DeviceType, typename Polyhedra, typename Points>
+class PointInPolyhedronFunctor
+{
+  public:
+    PointInPolyhedronFunctor( Polyhedra polyhedra,
+                              Kokkos::View<int *, DeviceType> face_offset,
+                              Kokkos::View<int *, DeviceType> cell_offset,
+                              Points points,
+                              Kokkos::View<int const *, DeviceType> query_ids,
+                              Kokkos::View<int const *, DeviceType> cell_ids,
+                              Kokkos::View<bool *, DeviceType> inside,
+                              double tolerance )
+        : _polyhedra( polyhedra )
+        , _face_offset( face_offset )
+        , _cell_offset( cell_offset )
+        , _points( points )
+        , _query_ids( query_ids )
+        , _cell_ids( cell_ids )
+        , _inside( inside )
+        , _tolerance( tolerance )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( int const j ) const
+    {
+        int const i = _query_ids( j );
+        int const cell = _cell_ids( j );
+        Point const p = {{_points( i, 0 ), _points( i, 1 ), _points( i, 2 )}};
+
+        // The sum of the solid angles of the oriented faces is 4 pi inside
+        // and zero outside, even for non-convex cells. It is not reliable on
+        // the boundary so that the distance to the faces is kept too.
+        double solid_angle = 0.;
+        double distance_squared = Kokkos::ArithTraits<double>::max();
+        double size_squared = 0.;
+        int const first =
+            _face_offset( _polyhedra.cells( _cell_offset( cell ) ) );
+        Point const origin = {
+            {node( first, 0 ), node( first, 1 ), node( first, 2 )}};
+        for ( int l = _cell_offset( cell ); l < _cell_offset( cell + 1 ); ++l )
+        {
+            int const face = _polyhedra.cells( l );
+            double const orientation = _polyhedra.face_orientation( l );
+            int const begin = _face_offset( face );
+            int const end = _face_offset( face + 1 );
+            Point centroid = {{0., 0., 0.}};
+            for ( int m = begin; m < end; ++m )
+                for ( int d = 0; d < 3; ++d )
+                    centroid[d] += node( m, d );
+            for ( int d = 0; d < 3; ++d )
+                centroid[d] /= ( end - begin );
+            for ( int m = begin; m < end; ++m )
+            {
+                int const next = ( m + 1 < end ) ? m + 1 : begin;
+                Point const a = {{node( m, 0 ), node( m, 1 ), node( m, 2 )}};
+                Point const b = {
+                    {node( next, 0 ), node( next, 1 ), node( next, 2 )}};
+                solid_angle += orientation * solidAngle( p, centroid, a, b );
+                double u;
+                double v;
+                Point const q = closestPointOnTriangle( p, centroid, a, b, u,
+                                                        v );
+                Point const pq = difference( q, p );
+                double const q_distance_squared = dot( pq, pq );
+                if ( q_distance_squared < distance_squared )
+                    distance_squared = q_distance_squared;
+
+                // rough size of the cell for the tolerance
+                Point const r = difference( a, origin );
+                if ( dot( r, r ) > size_squared )
+                    size_squared = dot( r, r );
+            }
+        }
+        double const pi = std::acos( -1. );
+        _inside( j ) =
+            ( solid_angle > 2. * pi ) ||
+            ( distance_squared <= _tolerance * _tolerance * size_squared );
+    }
+
+  private:
+    KOKKOS_INLINE_FUNCTION
+    double node( int m, int d ) const
+    {
+        return _polyhedra.coordinates( _polyhedra.faces( m ), d );
+    }
+
+    Polyhedra _polyhedra;
+    Kokkos::View<int *, DeviceType> _face_offset;
+    Kokkos::View<int *, DeviceType> _cell_offset;
+    Points _points;
+    Kokkos::View<int const *, DeviceType> _query_ids;
+    Kokkos::View<int const *, DeviceType> _cell_ids;
+    Kokkos::View<bool *, DeviceType> _inside;
+    double _tolerance;
+};
+
+template <typename DeviceType>
+struct PointInPolyhedron
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // For each pair j of a point and a candidate polyhedron, e.g. as returned
+    // by a search of the bounding boxes of the cells, decide whether the
+    // point points(query_ids(j), :) lies in the cell cell_ids(j) of
+    // polyhedra. Points within tolerance times the size of the cell of its
+    // boundary are inside. Cells may be non-convex and their faces
+    // non-planar but face_orientation must be consistent.
+    template <typename Points, class... ViewProperties>
+    static void search( PolyhedronList<ViewProperties...> const &polyhedra,
+                        Points points,
+                        Kokkos::View<int const *, DeviceType> query_ids,
+                        Kokkos::View<int const *, DeviceType> cell_ids,
+                        Kokkos::View<bool *, DeviceType> inside,
+                        double tolerance = 1e-10 )
+    {
+        DTK_REQUIRE( cell_ids.extent( 0 ) == query_ids.extent( 0 ) );
+        DTK_REQUIRE( inside.extent( 0 ) == query_ids.extent( 0 ) );
+        DTK_REQUIRE( polyhedra.face_orientation.extent( 0 ) ==
+                     polyhedra.cells.extent( 0 ) );
+
+        auto const nodes_per_face = polyhedra.nodes_per_face;
+        auto const face_offset = computeOffsets<DeviceType>(
+            "face_offset", nodes_per_face.extent( 0 ),
+            KOKKOS_LAMBDA( int f ) {
+                return static_cast<int>( nodes_per_face( f ) );
+            } );
+        auto const faces_per_cell = polyhedra.faces_per_cell;
+        auto const cell_offset = computeOffsets<DeviceType>(
+            "cell_offset", faces_per_cell.extent( 0 ),
+            KOKKOS_LAMBDA( int c ) {
+                return static_cast<int>( faces_per_cell( c ) );
+            } );
+
+        PointInPolyhedronFunctor<DeviceType,
+                                 PolyhedronList<ViewProperties...>, Points>
+            functor( polyhedra, face_offset, cell_offset, points, query_ids,
+                     cell_ids, inside, tolerance );
+        Kokkos::parallel_for(
+            REGION_NAME( "point_in_polyhedron" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, query_ids.extent( 0 ) ),
+            functor );
+        Kokkos::fence();
+    }
+};
+}
+}
+
+#endif
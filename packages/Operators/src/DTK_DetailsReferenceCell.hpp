@@ -0,0 +1,544 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_REFERENCE_CELL_HPP
+#define DTK_DETAILS_REFERENCE_CELL_HPP
+
+#include <DTK_DetailsPoint.hpp>
+
+#include <Kokkos_Macros.hpp>
+
+#include <cmath>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+// Topologies of the three-dimensional cells with linear (or trilinear)
+// Lagrange basis functions. The nodes follow the usual ordering, i.e. the
+// vertices of the bottom face counterclockwise then those of the top face
+// (or the apex of the pyramid).
+enum class CellTopology
+{
+    TET4,
+    HEX8,
+    WEDGE6,
+    PYRAMID5
+};
+
+// Largest number of nodes of the supported topologies.
+constexpr int MAX_NODES_PER_CELL = 8;
+
+// Reference cell and shape functions of each topology, and a split of the
+// cell into tetrahedra with the nodes subTetrahedronNode(t, k), k = 0..3, of
+// the cell. The faces are numbered as in the canonical (Shards) topologies,
+// face f has the nodes faceNode(f, k), k < nodesPerFace(f), counterclockwise
+// seen from outside of the cell. The topology is a template parameter so that
+// the loops over the nodes have a fixed trip count in the kernels.
+template <CellTopology topology>
+struct ReferenceCell;
+
+// The reference tetrahedron has its vertices at the origin and at the unit
+// vectors.
+template <>
+struct ReferenceCell<CellTopology::TET4>
+{
+    static constexpr int n_nodes = 4;
+    static constexpr int n_sub_tetrahedra = 1;
+
+    KOKKOS_INLINE_FUNCTION
+    static int subTetrahedronNode( int, int k ) { return k; }
+
+    static constexpr int n_faces = 4;
+
+    KOKKOS_INLINE_FUNCTION
+    static int nodesPerFace( int ) { return 3; }
+
+    KOKKOS_INLINE_FUNCTION
+    static int faceNode( int f, int k )
+    {
+        int const faces[4][3] = {{0, 1, 3}, {1, 2, 3}, {0, 3, 2}, {0, 2, 1}};
+        return faces[f][k];
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void center( Point &xi )
+    {
+        for ( int d = 0; d < 3; ++d )
+            xi[d] = 0.25;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void values( Point const &xi, double *values )
+    {
+        values[0] = 1. - xi[0] - xi[1] - xi[2];
+        for ( int d = 0; d < 3; ++d )
+            values[d + 1] = xi[d];
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void gradients( Point const &, double ( *gradients )[3] )
+    {
+        for ( int d = 0; d < 3; ++d )
+        {
+            gradients[0][d] = -1.;
+            for ( int k = 1; k < 4; ++k )
+                gradients[k][d] = ( k == d + 1 ) ? 1. : 0.;
+        }
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static bool contains( Point const &xi, double tolerance )
+    {
+        return xi[0] >= -tolerance && xi[1] >= -tolerance &&
+               xi[2] >= -tolerance &&
+               xi[0] + xi[1] + xi[2] <= 1. + tolerance;
+    }
+};
+
+// The reference hexahedron is [-1, 1]^3.
+template <>
+struct ReferenceCell<CellTopology::HEX8>
+{
+    static constexpr int n_nodes = 8;
+    static constexpr int n_sub_tetrahedra = 6;
+
+    // the six tetrahedra share the diagonal from node 0 to node 6
+    KOKKOS_INLINE_FUNCTION
+    static int subTetrahedronNode( int t, int k )
+    {
+        int const tetrahedra[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6},
+                                      {0, 3, 7, 6}, {0, 7, 4, 6},
+                                      {0, 4, 5, 6}, {0, 5, 1, 6}};
+        return tetrahedra[t][k];
+    }
+
+    static constexpr int n_faces = 6;
+
+    KOKKOS_INLINE_FUNCTION
+    static int nodesPerFace( int ) { return 4; }
+
+    KOKKOS_INLINE_FUNCTION
+    static int faceNode( int f, int k )
+    {
+        int const faces[6][4] = {{0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6},
+                                 {0, 4, 7, 3}, {0, 3, 2, 1}, {4, 5, 6, 7}};
+        return faces[f][k];
+    }
+
+    // Coordinates of the k-th node of the reference cell.
+    KOKKOS_INLINE_FUNCTION
+    static double node( int k, int d )
+    {
+        int const bit = ( d == 0 ) ? ( ( k + 1 ) / 2 ) % 2
+                                   : ( d == 1 ) ? ( k / 2 ) % 2 : k / 4;
+        return bit ? 1. : -1.;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void center( Point &xi )
+    {
+        for ( int d = 0; d < 3; ++d )
+            xi[d] = 0.;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void values( Point const &xi, double *values )
+    {
+        for ( int k = 0; k < 8; ++k )
+            values[k] = 0.125 * ( 1. + node( k, 0 ) * xi[0] ) *
+                        ( 1. + node( k, 1 ) * xi[1] ) *
+                        ( 1. + node( k, 2 ) * xi[2] );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void gradients( Point const &xi, double ( *gradients )[3] )
+    {
+        for ( int k = 0; k < 8; ++k )
+        {
+            double const s[3] = {node( k, 0 ), node( k, 1 ), node( k, 2 )};
+            double const f[3] = {1. + s[0] * xi[0], 1. + s[1] * xi[1],
+                                 1. + s[2] * xi[2]};
+            gradients[k][0] = 0.125 * s[0] * f[1] * f[2];
+            gradients[k][1] = 0.125 * f[0] * s[1] * f[2];
+            gradients[k][2] = 0.125 * f[0] * f[1] * s[2];
+        }
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static bool contains( Point const &xi, double tolerance )
+    {
+        for ( int d = 0; d < 3; ++d )
+            if ( std::abs( xi[d] ) > 1. + tolerance )
+                return false;
+        return true;
+    }
+};
+
+// The reference wedge is the product of the reference triangle in the first
+// two coordinates and of [-1, 1] in the third one.
+template <>
+struct ReferenceCell<CellTopology::WEDGE6>
+{
+    static constexpr int n_nodes = 6;
+    static constexpr int n_sub_tetrahedra = 3;
+
+    KOKKOS_INLINE_FUNCTION
+    static int subTetrahedronNode( int t, int k )
+    {
+        int const tetrahedra[3][4] = {{0, 1, 2, 3}, {1, 2, 3, 4}, {2, 3, 4, 5}};
+        return tetrahedra[t][k];
+    }
+
+    static constexpr int n_faces = 5;
+
+    KOKKOS_INLINE_FUNCTION
+    static int nodesPerFace( int f ) { return ( f < 3 ) ? 4 : 3; }
+
+    KOKKOS_INLINE_FUNCTION
+    static int faceNode( int f, int k )
+    {
+        int const faces[5][4] = {{0, 1, 4, 3},
+                                 {1, 2, 5, 4},
+                                 {0, 3, 5, 2},
+                                 {0, 2, 1, -1},
+                                 {3, 4, 5, -1}};
+        return faces[f][k];
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void center( Point &xi )
+    {
+        xi[0] = 1. / 3.;
+        xi[1] = 1. / 3.;
+        xi[2] = 0.;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void values( Point const &xi, double *values )
+    {
+        double const triangle[3] = {1. - xi[0] - xi[1], xi[0], xi[1]};
+        for ( int k = 0; k < 3; ++k )
+        {
+            values[k] = 0.5 * triangle[k] * ( 1. - xi[2] );
+            values[k + 3] = 0.5 * triangle[k] * ( 1. + xi[2] );
+        }
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void gradients( Point const &xi, double ( *gradients )[3] )
+    {
+        double const triangle[3] = {1. - xi[0] - xi[1], xi[0], xi[1]};
+        double const triangle_gradients[3][2] = {
+            {-1., -1.}, {1., 0.}, {0., 1.}};
+        for ( int k = 0; k < 3; ++k )
+            for ( int l = 0; l < 2; ++l )
+            {
+                double const s = ( l == 0 ) ? -1. : 1.;
+                double const f = 0.5 * ( 1. + s * xi[2] );
+                gradients[k + 3 * l][0] = triangle_gradients[k][0] * f;
+                gradients[k + 3 * l][1] = triangle_gradients[k][1] * f;
+                gradients[k + 3 * l][2] = 0.5 * s * triangle[k];
+            }
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static bool contains( Point const &xi, double tolerance )
+    {
+        return xi[0] >= -tolerance && xi[1] >= -tolerance &&
+               xi[0] + xi[1] <= 1. + tolerance &&
+               std::abs( xi[2] ) <= 1. + tolerance;
+    }
+};
+
+// The reference pyramid has its base on [-1, 1]^2 in the plane of the first
+// two coordinates and its apex at (0, 0, 1). The shape functions of the base
+// are rational and are regularized at the apex.
+template <>
+struct ReferenceCell<CellTopology::PYRAMID5>
+{
+    static constexpr int n_nodes = 5;
+    static constexpr int n_sub_tetrahedra = 2;
+
+    KOKKOS_INLINE_FUNCTION
+    static int subTetrahedronNode( int t, int k )
+    {
+        int const tetrahedra[2][4] = {{0, 1, 2, 4}, {0, 2, 3, 4}};
+        return tetrahedra[t][k];
+    }
+
+    static constexpr int n_faces = 5;
+
+    KOKKOS_INLINE_FUNCTION
+    static int nodesPerFace( int f ) { return ( f < 4 ) ? 3 : 4; }
+
+    KOKKOS_INLINE_FUNCTION
+    static int faceNode( int f, int k )
+    {
+        int const faces[5][4] = {{0, 1, 4, -1},
+                                 {1, 2, 4, -1},
+                                 {2, 3, 4, -1},
+                                 {0, 4, 3, -1},
+                                 {0, 3, 2, 1}};
+        return faces[f][k];
+    }
+
+    // the base nodes are ordered as those of the bottom face of a hexahedron
+    using Base = ReferenceCell<CellTopology::HEX8>;
+
+    KOKKOS_INLINE_FUNCTION
+    static double height( Point const &xi )
+    {
+        double const epsilon = 1e-14;
+        double const h = 1. - xi[2];
+        return ( std::abs( h ) > epsilon ) ? h : epsilon;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void center( Point &xi )
+    {
+        xi[0] = 0.;
+        xi[1] = 0.;
+        xi[2] = 0.25;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void values( Point const &xi, double *values )
+    {
+        double const h = height( xi );
+        for ( int k = 0; k < 4; ++k )
+        {
+            double const a = 1. + Base::node( k, 0 ) * xi[0] - xi[2];
+            double const b = 1. + Base::node( k, 1 ) * xi[1] - xi[2];
+            values[k] = 0.25 * a * b / h;
+        }
+        values[4] = xi[2];
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void gradients( Point const &xi, double ( *gradients )[3] )
+    {
+        double const h = height( xi );
+        for ( int k = 0; k < 4; ++k )
+        {
+            double const s[2] = {Base::node( k, 0 ), Base::node( k, 1 )};
+            double const a = 1. + s[0] * xi[0] - xi[2];
+            double const b = 1. + s[1] * xi[1] - xi[2];
+            gradients[k][0] = 0.25 * s[0] * b / h;
+            gradients[k][1] = 0.25 * s[1] * a / h;
+            gradients[k][2] = 0.25 * ( a * b / h - a - b ) / h;
+        }
+        gradients[4][0] = 0.;
+        gradients[4][1] = 0.;
+        gradients[4][2] = 1.;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static bool contains( Point const &xi, double tolerance )
+    {
+        return xi[2] >= -tolerance && xi[2] <= 1. + tolerance &&
+               std::abs( xi[0] ) <= 1. - xi[2] + tolerance &&
+               std::abs( xi[1] ) <= 1. - xi[2] + tolerance;
+    }
+};
+
+KOKKOS_INLINE_FUNCTION
+int nodesPerCell( CellTopology topology )
+{
+    switch ( topology )
+    {
+    case CellTopology::TET4:
+        return ReferenceCell<CellTopology::TET4>::n_nodes;
+    case CellTopology::HEX8:
+        return ReferenceCell<CellTopology::HEX8>::n_nodes;
+    case CellTopology::WEDGE6:
+        return ReferenceCell<CellTopology::WEDGE6>::n_nodes;
+    default:
+        return ReferenceCell<CellTopology::PYRAMID5>::n_nodes;
+    }
+}
+
+// Topology of the cells of a single topology cell list, given the number of
+// nodes of each cell. Returns false if there is no such topology.
+inline bool cellTopologyFromNodesPerCell( int nodes_per_cell,
+                                          CellTopology &topology )
+{
+    switch ( nodes_per_cell )
+    {
+    case 4:
+        topology = CellTopology::TET4;
+        return true;
+    case 5:
+        topology = CellTopology::PYRAMID5;
+        return true;
+    case 6:
+        topology = CellTopology::WEDGE6;
+        return true;
+    case 8:
+        topology = CellTopology::HEX8;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Shape functions of a topology only known at run time.
+KOKKOS_INLINE_FUNCTION
+void evaluateShapeFunctions( CellTopology topology, Point const &xi,
+                             double *values )
+{
+    switch ( topology )
+    {
+    case CellTopology::TET4:
+        ReferenceCell<CellTopology::TET4>::values( xi, values );
+        break;
+    case CellTopology::HEX8:
+        ReferenceCell<CellTopology::HEX8>::values( xi, values );
+        break;
+    case CellTopology::WEDGE6:
+        ReferenceCell<CellTopology::WEDGE6>::values( xi, values );
+        break;
+    case CellTopology::PYRAMID5:
+        ReferenceCell<CellTopology::PYRAMID5>::values( xi, values );
+        break;
+    }
+}
+
+// Split of a cell of a topology only known at run time into tetrahedra.
+KOKKOS_INLINE_FUNCTION
+int numberOfSubTetrahedra( CellTopology topology )
+{
+    switch ( topology )
+    {
+    case CellTopology::TET4:
+        return ReferenceCell<CellTopology::TET4>::n_sub_tetrahedra;
+    case CellTopology::HEX8:
+        return ReferenceCell<CellTopology::HEX8>::n_sub_tetrahedra;
+    case CellTopology::WEDGE6:
+        return ReferenceCell<CellTopology::WEDGE6>::n_sub_tetrahedra;
+    default:
+        return ReferenceCell<CellTopology::PYRAMID5>::n_sub_tetrahedra;
+    }
+}
+
+KOKKOS_INLINE_FUNCTION
+int subTetrahedronNode( CellTopology topology, int t, int k )
+{
+    switch ( topology )
+    {
+    case CellTopology::TET4:
+        return ReferenceCell<CellTopology::TET4>::subTetrahedronNode( t, k );
+    case CellTopology::HEX8:
+        return ReferenceCell<CellTopology::HEX8>::subTetrahedronNode( t, k );
+    case CellTopology::WEDGE6:
+        return ReferenceCell<CellTopology::WEDGE6>::subTetrahedronNode( t, k );
+    default:
+        return ReferenceCell<CellTopology::PYRAMID5>::subTetrahedronNode( t,
+                                                                         k );
+    }
+}
+
+// Faces of a cell of a topology only known at run time.
+KOKKOS_INLINE_FUNCTION
+int nodesPerFace( CellTopology topology, int f )
+{
+    switch ( topology )
+    {
+    case CellTopology::TET4:
+        return ReferenceCell<CellTopology::TET4>::nodesPerFace( f );
+    case CellTopology::HEX8:
+        return ReferenceCell<CellTopology::HEX8>::nodesPerFace( f );
+    case CellTopology::WEDGE6:
+        return ReferenceCell<CellTopology::WEDGE6>::nodesPerFace( f );
+    default:
+        return ReferenceCell<CellTopology::PYRAMID5>::nodesPerFace( f );
+    }
+}
+
+KOKKOS_INLINE_FUNCTION
+int faceNode( CellTopology topology, int f, int k )
+{
+    switch ( topology )
+    {
+    case CellTopology::TET4:
+        return ReferenceCell<CellTopology::TET4>::faceNode( f, k );
+    case CellTopology::HEX8:
+        return ReferenceCell<CellTopology::HEX8>::faceNode( f, k );
+    case CellTopology::WEDGE6:
+        return ReferenceCell<CellTopology::WEDGE6>::faceNode( f, k );
+    default:
+        return ReferenceCell<CellTopology::PYRAMID5>::faceNode( f, k );
+    }
+}
+
+// Find the reference coordinates xi of the physical point x in the cell with
+// the given nodes with Newton's method, starting from the center of the
+// reference cell. Returns false if the iterations do not converge, e.g.
+// because the cell is degenerate. The map is affine for tetrahedra and a
+// single iteration is needed.
+template <CellTopology topology>
+KOKKOS_INLINE_FUNCTION bool mapToReferenceCell( double const ( *nodes )[3],
+                                                Point const &x, Point &xi )
+{
+    using Cell = ReferenceCell<topology>;
+    int const max_iterations = 20;
+    double const tolerance = 1e-12;
+
+    Cell::center( xi );
+    double values[Cell::n_nodes];
+    double gradients[Cell::n_nodes][3];
+    for ( int iteration = 0; iteration < max_iterations; ++iteration )
+    {
+        // residual and jacobian of the map from the reference cell
+        Cell::values( xi, values );
+        Cell::gradients( xi, gradients );
+        double r[3] = {-x[0], -x[1], -x[2]};
+        double j[3][3] = {{0., 0., 0.}, {0., 0., 0.}, {0., 0., 0.}};
+        for ( int k = 0; k < Cell::n_nodes; ++k )
+            for ( int a = 0; a < 3; ++a )
+            {
+                r[a] += values[k] * nodes[k][a];
+                for ( int b = 0; b < 3; ++b )
+                    j[a][b] += gradients[k][b] * nodes[k][a];
+            }
+
+        // solve j delta = r with Cramer's rule
+        double const det =
+            j[0][0] * ( j[1][1] * j[2][2] - j[1][2] * j[2][1] ) -
+            j[0][1] * ( j[1][0] * j[2][2] - j[1][2] * j[2][0] ) +
+            j[0][2] * ( j[1][0] * j[2][1] - j[1][1] * j[2][0] );
+        if ( det == 0. )
+            return false;
+        double delta[3];
+        for ( int c = 0; c < 3; ++c )
+        {
+            double m[3][3];
+            for ( int a = 0; a < 3; ++a )
+                for ( int b = 0; b < 3; ++b )
+                    m[a][b] = ( b == c ) ? r[a] : j[a][b];
+            delta[c] = ( m[0][0] * ( m[1][1] * m[2][2] - m[1][2] * m[2][1] ) -
+                         m[0][1] * ( m[1][0] * m[2][2] - m[1][2] * m[2][0] ) +
+                         m[0][2] * ( m[1][0] * m[2][1] - m[1][1] * m[2][0] ) ) /
+                       det;
+        }
+
+        double norm = 0.;
+        for ( int d = 0; d < 3; ++d )
+        {
+            xi[d] -= delta[d];
+            norm += delta[d] * delta[d];
+        }
+        if ( norm <= tolerance * tolerance )
+            return true;
+    }
+    return false;
+}
+}
+}
+
+#endif
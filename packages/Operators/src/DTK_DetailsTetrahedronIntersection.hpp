@@ -0,0 +1,229 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_TETRAHEDRON_INTERSECTION_HPP
+#define DTK_DETAILS_TETRAHEDRON_INTERSECTION_HPP
+
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DetailsTriangle.hpp>
+
+#include <Kokkos_Macros.hpp>
+
+#include <cmath>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+KOKKOS_INLINE_FUNCTION
+double signedTetrahedronVolume( Point const &a, Point const &b,
+                                Point const &c, Point const &d )
+{
+    return dot( difference( b, a ),
+                cross( difference( c, a ), difference( d, a ) ) ) /
+           6.;
+}
+
+// Convex polyhedron in which every vertex has exactly three neighbors,
+// stored in registers. The neighbors of a vertex are listed counterclockwise
+// seen from outside so that the faces can be walked from the graph alone
+// (Powell and Abel, An exact general remeshing scheme applied to physically
+// conservative voxelization, J. Comput. Phys. 297, 2015).
+//
+// A tetrahedron clipped by the four planes of another one has at most eight
+// faces, hence twelve vertices, and the clipping of a single plane adds at
+// most one vertex per edge before the clipped vertices are removed.
+class ClippedPolyhedron
+{
+  public:
+    static constexpr int capacity = 32;
+
+    // Positively oriented tetrahedron, i.e. with a positive
+    // signedTetrahedronVolume(v[0], v[1], v[2], v[3]).
+    KOKKOS_INLINE_FUNCTION
+    explicit ClippedPolyhedron( Point const ( &v )[4] )
+        : _n_vertices( 4 )
+    {
+        int const neighbors[4][3] = {{1, 3, 2}, {2, 3, 0}, {0, 3, 1},
+                                     {1, 2, 0}};
+        for ( int k = 0; k < 4; ++k )
+        {
+            _vertices[k] = v[k];
+            for ( int l = 0; l < 3; ++l )
+                _neighbors[k][l] = neighbors[k][l];
+        }
+    }
+
+    // Keep the part where dot(normal, x) + offset >= 0.
+    KOKKOS_INLINE_FUNCTION
+    void clip( Point const &normal, double offset )
+    {
+        if ( _n_vertices == 0 )
+            return;
+
+        double distance[capacity];
+        int clipped[capacity];
+        bool any_clipped = false;
+        bool all_clipped = true;
+        for ( int v = 0; v < _n_vertices; ++v )
+        {
+            distance[v] = dot( normal, _vertices[v] ) + offset;
+            clipped[v] = ( distance[v] < 0. ) ? 1 : 0;
+            any_clipped = any_clipped || clipped[v];
+            all_clipped = all_clipped && clipped[v];
+        }
+        if ( !any_clipped )
+            return;
+        if ( all_clipped )
+        {
+            _n_vertices = 0;
+            return;
+        }
+
+        // new vertex on every edge that crosses the plane
+        int const n_old = _n_vertices;
+        for ( int v = 0; v < n_old; ++v )
+        {
+            if ( clipped[v] )
+                continue;
+            for ( int l = 0; l < 3; ++l )
+            {
+                int const w = _neighbors[v][l];
+                if ( !clipped[w] )
+                    continue;
+                int const n = _n_vertices++;
+                double const s = distance[v] / ( distance[v] - distance[w] );
+                for ( int d = 0; d < 3; ++d )
+                    _vertices[n][d] =
+                        _vertices[v][d] + s * ( _vertices[w][d] -
+                                                _vertices[v][d] );
+                _neighbors[n][0] = v;
+                _neighbors[v][l] = n;
+                clipped[n] = 0;
+            }
+        }
+
+        // link the new vertices along the cap by walking the faces that
+        // were cut
+        for ( int start = n_old; start < _n_vertices; ++start )
+        {
+            int current = start;
+            int next = _neighbors[current][0];
+            do
+            {
+                int const l = neighborIndex( next, current );
+                current = next;
+                next = _neighbors[current][( l + 1 ) % 3];
+            } while ( current < n_old );
+            _neighbors[start][2] = current;
+            _neighbors[current][1] = start;
+        }
+
+        // remove the clipped vertices, clipped is reused to store the new
+        // index of the vertices that are kept
+        int n_kept = 0;
+        for ( int v = 0; v < _n_vertices; ++v )
+            if ( !clipped[v] )
+            {
+                _vertices[n_kept] = _vertices[v];
+                for ( int l = 0; l < 3; ++l )
+                    _neighbors[n_kept][l] = _neighbors[v][l];
+                clipped[v] = n_kept++;
+            }
+        _n_vertices = n_kept;
+        for ( int v = 0; v < _n_vertices; ++v )
+            for ( int l = 0; l < 3; ++l )
+                _neighbors[v][l] = clipped[_neighbors[v][l]];
+    }
+
+    // Sum of the tetrahedra joining the origin to the fans of the faces.
+    KOKKOS_INLINE_FUNCTION
+    double volume() const
+    {
+        bool visited[capacity][3] = {};
+        double six_volume = 0.;
+        for ( int start = 0; start < _n_vertices; ++start )
+            for ( int l_start = 0; l_start < 3; ++l_start )
+            {
+                if ( visited[start][l_start] )
+                    continue;
+                visited[start][l_start] = true;
+                Point const &p0 = _vertices[start];
+                int current = start;
+                int next = _neighbors[current][l_start];
+                int l = ( neighborIndex( next, current ) + 1 ) % 3;
+                current = next;
+                visited[current][l] = true;
+                next = _neighbors[current][l];
+                while ( next != start )
+                {
+                    six_volume += dot(
+                        p0, cross( _vertices[next], _vertices[current] ) );
+                    l = ( neighborIndex( next, current ) + 1 ) % 3;
+                    current = next;
+                    visited[current][l] = true;
+                    next = _neighbors[current][l];
+                }
+            }
+        return six_volume / 6.;
+    }
+
+  private:
+    KOKKOS_INLINE_FUNCTION
+    int neighborIndex( int v, int w ) const
+    {
+        int l = 0;
+        while ( l < 2 && _neighbors[v][l] != w )
+            ++l;
+        return l;
+    }
+
+    int _n_vertices;
+    Point _vertices[capacity];
+    int _neighbors[capacity][3];
+};
+
+// Volume of the intersection of the tetrahedra a and b, of either
+// orientation. The coordinates are taken relative to a vertex of a to limit
+// the cancellations in the volume of small intersections.
+KOKKOS_INLINE_FUNCTION
+double intersectionVolume( Point const ( &a )[4], Point const ( &b )[4] )
+{
+    Point const origin = a[0];
+    Point va[4];
+    Point vb[4];
+    for ( int k = 0; k < 4; ++k )
+    {
+        va[k] = difference( a[k], origin );
+        vb[k] = difference( b[k], origin );
+    }
+    if ( signedTetrahedronVolume( va[0], va[1], va[2], va[3] ) < 0. )
+    {
+        Point const tmp = va[0];
+        va[0] = va[1];
+        va[1] = tmp;
+    }
+
+    ClippedPolyhedron polyhedron( va );
+    for ( int k = 0; k < 4; ++k )
+    {
+        // plane of the face of b opposite to vertex k, normal towards it
+        Point const &p = vb[( k + 1 ) % 4];
+        Point normal = cross( difference( vb[( k + 2 ) % 4], p ),
+                              difference( vb[( k + 3 ) % 4], p ) );
+        if ( dot( normal, difference( vb[k], p ) ) < 0. )
+            for ( int d = 0; d < 3; ++d )
+                normal[d] = -normal[d];
+        polyhedron.clip( normal, -dot( normal, p ) );
+    }
+    return polyhedron.volume();
+}
+}
+}
+
+#endif
@@ -0,0 +1,204 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_TRIANGLE_HPP
+#define DTK_DETAILS_TRIANGLE_HPP
+
+#include <DTK_DetailsPoint.hpp>
+
+#include <Kokkos_Macros.hpp>
+
+#include <cmath>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+KOKKOS_INLINE_FUNCTION
+double dot( Point const &u, Point const &v )
+{
+    return u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+}
+
+KOKKOS_INLINE_FUNCTION
+Point cross( Point const &u, Point const &v )
+{
+    return {{u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2],
+             u[0] * v[1] - u[1] * v[0]}};
+}
+
+KOKKOS_INLINE_FUNCTION
+Point difference( Point const &u, Point const &v )
+{
+    return {{u[0] - v[0], u[1] - v[1], u[2] - v[2]}};
+}
+
+// Signed solid angle of the triangle (a, b, c) seen from p, positive if the
+// normal given by the right-hand rule points away from p (Van Oosterom and
+// Strackee).
+KOKKOS_INLINE_FUNCTION
+double solidAngle( Point const &p, Point const &a, Point const &b,
+                   Point const &c )
+{
+    Point const ra = difference( a, p );
+    Point const rb = difference( b, p );
+    Point const rc = difference( c, p );
+    double const la = std::sqrt( dot( ra, ra ) );
+    double const lb = std::sqrt( dot( rb, rb ) );
+    double const lc = std::sqrt( dot( rc, rc ) );
+    double const numerator = dot( ra, cross( rb, rc ) );
+    double const denominator = la * lb * lc + dot( ra, rb ) * lc +
+                               dot( ra, rc ) * lb + dot( rb, rc ) * la;
+    return 2. * std::atan2( numerator, denominator );
+}
+
+// Closest point to p on the triangle (a, b, c), given as a + u (b - a) +
+// v (c - a) with u, v >= 0 and u + v <= 1 (Ericson, Real-Time Collision
+// Detection, 5.1.5).
+KOKKOS_INLINE_FUNCTION
+Point closestPointOnTriangle( Point const &p, Point const &a, Point const &b,
+                              Point const &c, double &u, double &v )
+{
+    Point const ab = difference( b, a );
+    Point const ac = difference( c, a );
+    Point const ap = difference( p, a );
+    double const d1 = dot( ab, ap );
+    double const d2 = dot( ac, ap );
+    if ( d1 <= 0. && d2 <= 0. )
+    {
+        // vertex a
+        u = 0.;
+        v = 0.;
+        return a;
+    }
+
+    Point const bp = difference( p, b );
+    double const d3 = dot( ab, bp );
+    double const d4 = dot( ac, bp );
+    if ( d3 >= 0. && d4 <= d3 )
+    {
+        // vertex b
+        u = 1.;
+        v = 0.;
+        return b;
+    }
+
+    double const vc = d1 * d4 - d3 * d2;
+    if ( vc <= 0. && d1 >= 0. && d3 <= 0. )
+    {
+        // edge ab
+        u = d1 / ( d1 - d3 );
+        v = 0.;
+        return {{a[0] + u * ab[0], a[1] + u * ab[1], a[2] + u * ab[2]}};
+    }
+
+    Point const cp = difference( p, c );
+    double const d5 = dot( ab, cp );
+    double const d6 = dot( ac, cp );
+    if ( d6 >= 0. && d5 <= d6 )
+    {
+        // vertex c
+        u = 0.;
+        v = 1.;
+        return c;
+    }
+
+    double const vb = d5 * d2 - d1 * d6;
+    if ( vb <= 0. && d2 >= 0. && d6 <= 0. )
+    {
+        // edge ac
+        u = 0.;
+        v = d2 / ( d2 - d6 );
+        return {{a[0] + v * ac[0], a[1] + v * ac[1], a[2] + v * ac[2]}};
+    }
+
+    double const va = d3 * d6 - d5 * d4;
+    if ( va <= 0. && ( d4 - d3 ) >= 0. && ( d5 - d6 ) >= 0. )
+    {
+        // edge bc
+        double const w = ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) );
+        u = 1. - w;
+        v = w;
+        return {{b[0] + w * ( c[0] - b[0] ), b[1] + w * ( c[1] - b[1] ),
+                 b[2] + w * ( c[2] - b[2] )}};
+    }
+
+    // interior of the face
+    double const denominator = 1. / ( va + vb + vc );
+    u = vb * denominator;
+    v = vc * denominator;
+    return {{a[0] + u * ab[0] + v * ac[0], a[1] + u * ab[1] + v * ac[1],
+             a[2] + u * ab[2] + v * ac[2]}};
+}
+
+// Closest point to p on the quadrilateral (a, b, c, d), split into the
+// triangles (a, b, c) and (a, c, d), which is exact for planar faces. (s, t)
+// in [0, 1]^2 are the bilinear coordinates of the closest point, i.e. it is
+// (1 - s)(1 - t) a + s (1 - t) b + s t c + (1 - s) t d. They are exact for
+// parallelograms and refined by Gauss-Newton iterations otherwise.
+KOKKOS_INLINE_FUNCTION
+Point closestPointOnQuadrilateral( Point const &p, Point const &a,
+                                   Point const &b, Point const &c,
+                                   Point const &d, double &s, double &t )
+{
+    double u;
+    double v;
+    Point const q1 = closestPointOnTriangle( p, a, b, c, u, v );
+    double w;
+    double z;
+    Point const q2 = closestPointOnTriangle( p, a, c, d, w, z );
+    Point const pq1 = difference( q1, p );
+    Point const pq2 = difference( q2, p );
+    Point q;
+    if ( dot( pq1, pq1 ) <= dot( pq2, pq2 ) )
+    {
+        q = q1;
+        s = u + v;
+        t = v;
+    }
+    else
+    {
+        q = q2;
+        s = w;
+        t = w + z;
+    }
+
+    int const max_iterations = 10;
+    for ( int iteration = 0; iteration < max_iterations; ++iteration )
+    {
+        Point r;
+        Point xs;
+        Point xt;
+        for ( int i = 0; i < 3; ++i )
+        {
+            r[i] = ( 1. - s ) * ( 1. - t ) * a[i] + s * ( 1. - t ) * b[i] +
+                   s * t * c[i] + ( 1. - s ) * t * d[i] - q[i];
+            xs[i] = ( 1. - t ) * ( b[i] - a[i] ) + t * ( c[i] - d[i] );
+            xt[i] = ( 1. - s ) * ( d[i] - a[i] ) + s * ( c[i] - b[i] );
+        }
+        double const ss = dot( xs, xs );
+        double const st = dot( xs, xt );
+        double const tt = dot( xt, xt );
+        double const determinant = ss * tt - st * st;
+        if ( determinant <= 0. )
+            break;
+        double const rs = dot( xs, r );
+        double const rt = dot( xt, r );
+        double const ds = ( st * rt - tt * rs ) / determinant;
+        double const dt = ( st * rs - ss * rt ) / determinant;
+        s = std::fmin( std::fmax( s + ds, 0. ), 1. );
+        t = std::fmin( std::fmax( t + dt, 0. ), 1. );
+        if ( ds * ds + dt * dt < 1e-28 )
+            break;
+    }
+    return q;
+}
+}
+}
+
+#endif
@@ -0,0 +1,232 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_GHOST_LAYER_DECL_HPP
+#define DTK_GHOST_LAYER_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_KokkosHelpers.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Layer of ghost cells around the cells owned by this process. A cell owned
+ * by another process is a ghost if its bounding box lies within a given
+ * distance of the bounding box of one of the cells owned by this process.
+ * The candidates are found with a DistributedSearchTree over the bounding
+ * boxes of all the owned cells, so that only the processes that actually
+ * share a layer exchange data, and the coordinates of their nodes are then
+ * fetched with a CommunicationPlan.
+ */
+template <typename DeviceType>
+class GhostLayer
+{
+  public:
+    // The cells flagged in is_ghost_cell are neither sent to the other
+    // processes nor used to find the ghost layer. Only lists of cells that
+    // share a single topology (rank-2 cells view) are supported. Collective.
+    template <class... ViewProperties>
+    GhostLayer( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                CellList<ViewProperties...> const &cell_list,
+                double halo_width );
+
+    // Return a copy of cell_list with the ghost cells appended and flagged
+    // in is_ghost_cell. The cell list does not carry global node ids so the
+    // nodes of the ghost cells are appended to the coordinates and never
+    // shared with the existing cells.
+    template <class... ViewProperties>
+    CellList<ViewProperties...>
+    appendGhostCells( CellList<ViewProperties...> const &cell_list ) const;
+
+    // Number of ghost cells received by this process.
+    size_t getNumGhostCells() const { return _owner_ranks.extent( 0 ); }
+
+    // Rank of the process that owns each ghost cell and its index in the cell
+    // list of that process. They may be passed directly to a
+    // CommunicationPlan to exchange the fields attached to the cells.
+    Kokkos::View<int *, DeviceType> getOwnerRanks() const
+    {
+        return _owner_ranks;
+    }
+    Kokkos::View<int *, DeviceType> getOwnerIndices() const
+    {
+        return _owner_indices;
+    }
+
+  private:
+    using NodesView = Kokkos::View<Coordinate **, DeviceType>;
+
+    // cell_indices(i) is the index in the cell list of the owned cell i,
+    // cell_nodes(i, k * space_dim + d) the d-th coordinate of its k-th node.
+    void build( Kokkos::View<Box *, DeviceType> cell_boxes,
+                Kokkos::View<int *, DeviceType> cell_indices,
+                NodesView cell_nodes, double halo_width );
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    int _nodes_per_cell;
+    int _space_dim;
+    Kokkos::View<int *, DeviceType> _owner_ranks;
+    Kokkos::View<int *, DeviceType> _owner_indices;
+    // coordinates of the nodes of the ghost cells, stored as cell_nodes
+    NodesView _ghost_nodes;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+GhostLayer<DeviceType>::GhostLayer(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    CellList<ViewProperties...> const &cell_list, double halo_width )
+    : _comm( comm )
+    , _nodes_per_cell( 0 )
+    , _space_dim( 0 )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    DTK_INSIST( cell_list.cells.rank() == 2 );
+    DTK_REQUIRE( halo_width >= 0. );
+
+    auto const coordinates = cell_list.coordinates;
+    auto const cells = cell_list.cells;
+    int const n_cells = cells.extent( 0 );
+    int const nodes_per_cell = n_cells > 0 ? cells.extent( 1 ) : 0;
+    int const space_dim = n_cells > 0 ? coordinates.extent( 1 ) : 0;
+    DTK_INSIST( space_dim <= 3 );
+
+    // list the cells owned by this process
+    auto is_ghost_cell_host =
+        Kokkos::create_mirror_view( cell_list.is_ghost_cell );
+    Kokkos::deep_copy( is_ghost_cell_host, cell_list.is_ghost_cell );
+    bool const has_ghosts = is_ghost_cell_host.extent( 0 ) > 0;
+    DTK_REQUIRE( !has_ghosts ||
+                 static_cast<int>( is_ghost_cell_host.extent( 0 ) ) ==
+                     n_cells );
+    int n_owned = 0;
+    for ( int c = 0; c < n_cells; ++c )
+        if ( !has_ghosts || !is_ghost_cell_host( c ) )
+            ++n_owned;
+    Kokkos::View<int *, DeviceType> cell_indices( "cell_indices", n_owned );
+    auto cell_indices_host = Kokkos::create_mirror_view( cell_indices );
+    for ( int c = 0, i = 0; c < n_cells; ++c )
+        if ( !has_ghosts || !is_ghost_cell_host( c ) )
+            cell_indices_host( i++ ) = c;
+    Kokkos::deep_copy( cell_indices, cell_indices_host );
+
+    // pack their bounding boxes and the coordinates of their nodes
+    Kokkos::View<Box *, DeviceType> cell_boxes( "cell_boxes", n_owned );
+    NodesView cell_nodes( "cell_nodes", n_owned, nodes_per_cell * space_dim );
+    Kokkos::parallel_for(
+        REGION_NAME( "pack_owned_cells" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_owned ),
+        KOKKOS_LAMBDA( int i ) {
+            int const c = cell_indices( i );
+            Box box;
+            for ( int d = space_dim; d < 3; ++d )
+                box[2 * d] = box[2 * d + 1] = 0.;
+            for ( int k = 0; k < nodes_per_cell; ++k )
+                for ( int d = 0; d < space_dim; ++d )
+                {
+                    Coordinate const x = coordinates( cells( c, k ), d );
+                    box[2 * d] = KokkosHelpers::min( box[2 * d], x );
+                    box[2 * d + 1] = KokkosHelpers::max( box[2 * d + 1], x );
+                    cell_nodes( i, k * space_dim + d ) = x;
+                }
+            cell_boxes( i ) = box;
+        } );
+    Kokkos::fence();
+
+    _nodes_per_cell = nodes_per_cell;
+    _space_dim = space_dim;
+    build( cell_boxes, cell_indices, cell_nodes, halo_width );
+}
+
+template <typename DeviceType>
+template <class... ViewProperties>
+CellList<ViewProperties...> GhostLayer<DeviceType>::appendGhostCells(
+    CellList<ViewProperties...> const &cell_list ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    DTK_INSIST( cell_list.cells.rank() == 2 );
+
+    int const n_nodes = cell_list.coordinates.extent( 0 );
+    int const n_cells = cell_list.cells.extent( 0 );
+    int const n_ghosts = getNumGhostCells();
+    int const nodes_per_cell = _nodes_per_cell;
+    int const space_dim = _space_dim;
+    DTK_REQUIRE( n_cells == 0 ||
+                 static_cast<int>( cell_list.cells.extent( 1 ) ) ==
+                     nodes_per_cell );
+    DTK_REQUIRE( n_nodes == 0 ||
+                 static_cast<int>( cell_list.coordinates.extent( 1 ) ) ==
+                     space_dim );
+
+    // the boundary of the cell list is left untouched
+    CellList<ViewProperties...> ghosted_list = cell_list;
+    ghosted_list.coordinates =
+        decltype( cell_list.coordinates )( "coordinates",
+                                           n_nodes + n_ghosts * nodes_per_cell,
+                                           space_dim );
+    ghosted_list.cells = decltype( cell_list.cells )(
+        "cells", n_cells + n_ghosts, nodes_per_cell );
+    ghosted_list.is_ghost_cell =
+        decltype( cell_list.is_ghost_cell )( "is_ghost_cell",
+                                             n_cells + n_ghosts );
+
+    auto const coordinates = cell_list.coordinates;
+    auto const cells = cell_list.cells;
+    auto const is_ghost_cell = cell_list.is_ghost_cell;
+    bool const has_ghosts = is_ghost_cell.extent( 0 ) > 0;
+    auto const ghosted_coordinates = ghosted_list.coordinates;
+    auto const ghosted_cells = ghosted_list.cells;
+    auto const ghosted_is_ghost_cell = ghosted_list.is_ghost_cell;
+    auto const ghost_nodes = _ghost_nodes;
+    Kokkos::parallel_for(
+        REGION_NAME( "copy_nodes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+        KOKKOS_LAMBDA( int i ) {
+            for ( int d = 0; d < space_dim; ++d )
+                ghosted_coordinates( i, d ) = coordinates( i, d );
+        } );
+    Kokkos::parallel_for(
+        REGION_NAME( "copy_cells" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int c ) {
+            for ( int k = 0; k < nodes_per_cell; ++k )
+                ghosted_cells( c, k ) = cells( c, k );
+            ghosted_is_ghost_cell( c ) = has_ghosts && is_ghost_cell( c );
+        } );
+    Kokkos::parallel_for(
+        REGION_NAME( "append_ghost_cells" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_ghosts ),
+        KOKKOS_LAMBDA( int g ) {
+            for ( int k = 0; k < nodes_per_cell; ++k )
+            {
+                int const node = n_nodes + g * nodes_per_cell + k;
+                for ( int d = 0; d < space_dim; ++d )
+                    ghosted_coordinates( node, d ) =
+                        ghost_nodes( g, k * space_dim + d );
+                ghosted_cells( n_cells + g, k ) = node;
+            }
+            ghosted_is_ghost_cell( n_cells + g ) = true;
+        } );
+    Kokkos::fence();
+
+    return ghosted_list;
+}
+
+} // end namespace DataTransferKit
+
+#endif
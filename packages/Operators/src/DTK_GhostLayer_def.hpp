@@ -0,0 +1,121 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_GHOST_LAYER_DEF_HPP
+#define DTK_GHOST_LAYER_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+
+#include <Teuchos_CommHelpers.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+void GhostLayer<DeviceType>::build(
+    Kokkos::View<Box *, DeviceType> cell_boxes,
+    Kokkos::View<int *, DeviceType> cell_indices, NodesView cell_nodes,
+    double halo_width )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const comm_rank = _comm->getRank();
+    int const n_owned = cell_boxes.extent( 0 );
+
+    // the processes without cells do not know the topology of the others
+    int nodes_per_cell = 0;
+    int space_dim = 0;
+    Teuchos::reduceAll( *_comm, Teuchos::REDUCE_MAX, _nodes_per_cell,
+                        Teuchos::ptr( &nodes_per_cell ) );
+    Teuchos::reduceAll( *_comm, Teuchos::REDUCE_MAX, _space_dim,
+                        Teuchos::ptr( &space_dim ) );
+    DTK_INSIST( n_owned == 0 || ( nodes_per_cell == _nodes_per_cell &&
+                                  space_dim == _space_dim ) );
+    _nodes_per_cell = nodes_per_cell;
+    _space_dim = space_dim;
+    int const n_components = nodes_per_cell * space_dim;
+    if ( static_cast<int>( cell_nodes.extent( 1 ) ) != n_components )
+        cell_nodes = NodesView( "cell_nodes", n_owned, n_components );
+
+    // find the cells whose bounding box overlaps the bounding box of an owned
+    // cell inflated by the width of the layer
+    DistributedSearchTree<DeviceType> tree( _comm, cell_boxes );
+    Kokkos::View<Details::Overlap *, DeviceType> queries( "queries",
+                                                          n_owned );
+    Kokkos::parallel_for( REGION_NAME( "inflate_boxes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_owned ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Box box = cell_boxes( i );
+                              for ( int d = 0; d < 3; ++d )
+                              {
+                                  box[2 * d] -= halo_width;
+                                  box[2 * d + 1] += halo_width;
+                              }
+                              queries( i ) = Details::overlap( box );
+                          } );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    // a remote cell may be found by several owned cells but is only received
+    // once
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    std::vector<std::pair<int, int>> ghosts;
+    for ( int j = 0; j < static_cast<int>( ranks_host.extent( 0 ) ); ++j )
+        if ( ranks_host( j ) != comm_rank )
+            ghosts.emplace_back( ranks_host( j ), indices_host( j ) );
+    std::sort( ghosts.begin(), ghosts.end() );
+    ghosts.erase( std::unique( ghosts.begin(), ghosts.end() ), ghosts.end() );
+
+    int const n_ghosts = ghosts.size();
+    Kokkos::View<int *, DeviceType> ghost_ranks( "ghost_ranks", n_ghosts );
+    Kokkos::View<int *, DeviceType> ghost_indices( "ghost_indices",
+                                                   n_ghosts );
+    auto ghost_ranks_host = Kokkos::create_mirror_view( ghost_ranks );
+    auto ghost_indices_host = Kokkos::create_mirror_view( ghost_indices );
+    for ( int g = 0; g < n_ghosts; ++g )
+    {
+        ghost_ranks_host( g ) = ghosts[g].first;
+        ghost_indices_host( g ) = ghosts[g].second;
+    }
+    Kokkos::deep_copy( ghost_ranks, ghost_ranks_host );
+    Kokkos::deep_copy( ghost_indices, ghost_indices_host );
+
+    // fetch the nodes of the ghost cells along with their index in the cell
+    // list of their owner, since the search only knows about owned cells
+    CommunicationPlan<DeviceType> plan( _comm, ghost_ranks, ghost_indices );
+    _owner_ranks = ghost_ranks;
+    _owner_indices = Kokkos::View<int *, DeviceType>( "owner_indices",
+                                                      n_ghosts );
+    _ghost_nodes = NodesView( "ghost_nodes", n_ghosts, n_components );
+    plan.doExchange( cell_indices, _owner_indices );
+    plan.doExchange( cell_nodes, _ghost_nodes );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_GHOSTLAYER_INSTANT( NODE )                                         \
+    template class GhostLayer<typename NODE::device_type>;
+
+#endif
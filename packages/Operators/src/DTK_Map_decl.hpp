@@ -0,0 +1,113 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_MAP_DECL_HPP
+#define DTK_MAP_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_Field.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Transfer operator stored as a sparse matrix. Each row corresponds to a
+ * target point on this process and holds the weights of the source degrees
+ * of freedom, owned by any process, that contribute to its value. The
+ * derived classes compute the matrix once in their setup(), which runs the
+ * search and the computation of the weights. The operator may then be
+ * applied to as many fields as needed, each application only exchanging the
+ * source values required by this process and performing a sparse
+ * matrix-vector product.
+ */
+template <typename DeviceType>
+class Map
+{
+  public:
+    explicit Map( Teuchos::RCP<Teuchos::Comm<int> const> comm )
+        : _comm( comm )
+    {
+    }
+
+    virtual ~Map() = default;
+
+    // target_values(i, d) is the sum over the entries j of row i of
+    // weights(j) times the value source_values(indices(j), d) on process
+    // ranks(j). Collective. Derived classes that do not store the whole
+    // transfer as a matrix, e.g. because it involves a solve, override it.
+    virtual void
+    apply( Kokkos::View<double **, DeviceType> source_values,
+           Kokkos::View<double **, DeviceType> target_values ) const;
+
+    // Same as above for the degrees of freedom of fields.
+    template <class... ViewProperties>
+    void apply( Field<double, ViewProperties...> const &source,
+                Field<double, ViewProperties...> const &target ) const;
+
+    // Whether setup() has been called.
+    bool isSetUp() const { return _plan.get() != nullptr; }
+
+    // Number of target points on this process.
+    size_t getNumRows() const
+    {
+        return _row_offsets.extent( 0 ) > 0 ? _row_offsets.extent( 0 ) - 1
+                                            : 0;
+    }
+
+    // Number of nonzero weights on this process.
+    size_t getNumEntries() const { return _columns.extent( 0 ); }
+
+  protected:
+    // Store the operator. The entries of row i are offset(i) to
+    // offset(i + 1) - 1. Entry j refers to the source degree of freedom
+    // indices(j) on process ranks(j). This is the format of the results of
+    // DistributedSearchTree::query(). Collective.
+    void setOperator( Kokkos::View<int const *, DeviceType> offset,
+                      Kokkos::View<int const *, DeviceType> indices,
+                      Kokkos::View<int const *, DeviceType> ranks,
+                      Kokkos::View<double const *, DeviceType> weights );
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+
+  private:
+    // fetches the source values needed by this process, each only once
+    Teuchos::RCP<CommunicationPlan<DeviceType>> _plan;
+    // compressed sparse rows, the columns index the values fetched by the
+    // plan
+    Kokkos::View<int *, DeviceType> _row_offsets;
+    Kokkos::View<int *, DeviceType> _columns;
+    Kokkos::View<double *, DeviceType> _weights;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void Map<DeviceType>::apply(
+    Field<double, ViewProperties...> const &source,
+    Field<double, ViewProperties...> const &target ) const
+{
+    DTK_REQUIRE( source.dofs.extent( 1 ) == target.dofs.extent( 1 ) );
+
+    int const n_components = source.dofs.extent( 1 );
+    Kokkos::View<double **, DeviceType> source_values(
+        "source_values", source.dofs.extent( 0 ), n_components );
+    Kokkos::View<double **, DeviceType> target_values(
+        "target_values", target.dofs.extent( 0 ), n_components );
+    Kokkos::deep_copy( source_values, source.dofs );
+    apply( source_values, target_values );
+    Kokkos::deep_copy( target.dofs, target_values );
+}
+
+} // end namespace DataTransferKit
+
+#endif
@@ -0,0 +1,122 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_MAP_DEF_HPP
+#define DTK_MAP_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+void Map<DeviceType>::setOperator(
+    Kokkos::View<int const *, DeviceType> offset,
+    Kokkos::View<int const *, DeviceType> indices,
+    Kokkos::View<int const *, DeviceType> ranks,
+    Kokkos::View<double const *, DeviceType> weights )
+{
+    DTK_REQUIRE( offset.extent( 0 ) > 0 );
+    DTK_REQUIRE( ranks.extent( 0 ) == indices.extent( 0 ) );
+    DTK_REQUIRE( weights.extent( 0 ) == indices.extent( 0 ) );
+
+    int const n_entries = indices.extent( 0 );
+
+    // every source degree of freedom is fetched once even if it contributes
+    // to several rows
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    std::vector<std::pair<int, int>> sources( n_entries );
+    for ( int j = 0; j < n_entries; ++j )
+        sources[j] = std::make_pair( ranks_host( j ), indices_host( j ) );
+    std::vector<std::pair<int, int>> unique_sources = sources;
+    std::sort( unique_sources.begin(), unique_sources.end() );
+    unique_sources.erase(
+        std::unique( unique_sources.begin(), unique_sources.end() ),
+        unique_sources.end() );
+
+    int const n_columns = unique_sources.size();
+    Kokkos::View<int *, DeviceType> column_ranks( "column_ranks", n_columns );
+    Kokkos::View<int *, DeviceType> column_indices( "column_indices",
+                                                    n_columns );
+    auto column_ranks_host = Kokkos::create_mirror_view( column_ranks );
+    auto column_indices_host = Kokkos::create_mirror_view( column_indices );
+    for ( int c = 0; c < n_columns; ++c )
+    {
+        column_ranks_host( c ) = unique_sources[c].first;
+        column_indices_host( c ) = unique_sources[c].second;
+    }
+    Kokkos::deep_copy( column_ranks, column_ranks_host );
+    Kokkos::deep_copy( column_indices, column_indices_host );
+
+    _columns = Kokkos::View<int *, DeviceType>( "columns", n_entries );
+    auto columns_host = Kokkos::create_mirror_view( _columns );
+    for ( int j = 0; j < n_entries; ++j )
+        columns_host( j ) = std::lower_bound( unique_sources.begin(),
+                                              unique_sources.end(),
+                                              sources[j] ) -
+                            unique_sources.begin();
+    Kokkos::deep_copy( _columns, columns_host );
+
+    _row_offsets =
+        Kokkos::View<int *, DeviceType>( "row_offsets", offset.extent( 0 ) );
+    Kokkos::deep_copy( _row_offsets, offset );
+    _weights = Kokkos::View<double *, DeviceType>( "weights", n_entries );
+    Kokkos::deep_copy( _weights, weights );
+
+    _plan = Teuchos::rcp(
+        new CommunicationPlan<DeviceType>( _comm, column_ranks,
+                                           column_indices ) );
+}
+
+template <typename DeviceType>
+void Map<DeviceType>::apply(
+    Kokkos::View<double **, DeviceType> source_values,
+    Kokkos::View<double **, DeviceType> target_values ) const
+{
+    DTK_REQUIRE( isSetUp() );
+    DTK_REQUIRE( target_values.extent( 0 ) == getNumRows() );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const n_components = target_values.extent( 1 );
+    Kokkos::View<double **, DeviceType> imports(
+        "imports", _plan->getNumImports(), n_components );
+    _plan->doExchange( source_values, imports );
+
+    auto const row_offsets = _row_offsets;
+    auto const columns = _columns;
+    auto const weights = _weights;
+    Kokkos::parallel_for(
+        REGION_NAME( "sparse_matrix_vector_product" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, getNumRows() ),
+        KOKKOS_LAMBDA( int i ) {
+            for ( int d = 0; d < n_components; ++d )
+            {
+                double value = 0.;
+                for ( int j = row_offsets( i ); j < row_offsets( i + 1 ); ++j )
+                    value += weights( j ) * imports( columns( j ), d );
+                target_values( i, d ) = value;
+            }
+        } );
+    Kokkos::fence();
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_MAP_INSTANT( NODE ) template class Map<typename NODE::device_type>;
+
+#endif
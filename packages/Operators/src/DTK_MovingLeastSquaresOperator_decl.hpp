@@ -0,0 +1,106 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_MOVING_LEAST_SQUARES_OPERATOR_DECL_HPP
+#define DTK_MOVING_LEAST_SQUARES_OPERATOR_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_EvaluationSet.hpp>
+#include <DTK_Map.hpp>
+#include <DTK_NodeList.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Mesh-free transfer by moving least squares. The value at a target point is
+ * the value at that point of the polynomial that best fits, in the least
+ * squares sense, the values of its nearest source nodes weighted by a
+ * compactly supported function of their distance. The fit is linear in the
+ * source values so that setup() computes the weights once and stores them in
+ * the sparse operator of the Map.
+ *
+ * The small systems of the least squares fits, one per target point, are
+ * assembled and solved together in a single kernel, each thread factoring
+ * its own system in registers.
+ */
+template <typename DeviceType>
+class MovingLeastSquaresOperator : public Map<DeviceType>
+{
+  public:
+    // The fits use polynomials of degree at most polynomial_degree (0, 1 or
+    // 2) through the n_neighbors nearest source nodes of each target point.
+    MovingLeastSquaresOperator( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                                int polynomial_degree = 1,
+                                int n_neighbors = 10 );
+
+    // Compute the weights of the fit at each point of target. Collective.
+    template <class... ViewProperties>
+    void setup( NodeList<ViewProperties...> const &source,
+                EvaluationSet<ViewProperties...> const &target );
+
+  private:
+    void build( Kokkos::View<Point *, DeviceType> source_points,
+                Kokkos::View<Point const *, DeviceType> target_points );
+
+    int _polynomial_degree;
+    int _n_neighbors;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void MovingLeastSquaresOperator<DeviceType>::setup(
+    NodeList<ViewProperties...> const &source,
+    EvaluationSet<ViewProperties...> const &target )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = source.coordinates;
+    int const n_nodes = coordinates.extent( 0 );
+    int const source_dim = coordinates.extent( 1 );
+    DTK_REQUIRE( n_nodes == 0 || source_dim <= 3 );
+    Kokkos::View<Point *, DeviceType> source_points( "source_points",
+                                                     n_nodes );
+    Kokkos::parallel_for( REGION_NAME( "convert_nodes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < source_dim; ++d )
+                                  p[d] = coordinates( i, d );
+                              source_points( i ) = p;
+                          } );
+
+    auto const evaluation_points = target.evaluation_points;
+    int const n_targets = evaluation_points.extent( 0 );
+    int const target_dim = evaluation_points.extent( 1 );
+    DTK_REQUIRE( n_targets == 0 || target_dim <= 3 );
+    Kokkos::View<Point *, DeviceType> target_points( "target_points",
+                                                     n_targets );
+    Kokkos::parallel_for( REGION_NAME( "convert_points" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < target_dim; ++d )
+                                  p[d] = evaluation_points( i, d );
+                              target_points( i ) = p;
+                          } );
+    Kokkos::fence();
+
+    build( source_points, target_points );
+}
+
+} // end namespace DataTransferKit
+
+#endif
@@ -0,0 +1,153 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_MOVING_LEAST_SQUARES_OPERATOR_DEF_HPP
+#define DTK_MOVING_LEAST_SQUARES_OPERATOR_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsAlgorithms.hpp>
+#include <DTK_DetailsMovingLeastSquares.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_KokkosHelpers.hpp>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+MovingLeastSquaresOperator<DeviceType>::MovingLeastSquaresOperator(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm, int polynomial_degree,
+    int n_neighbors )
+    : Map<DeviceType>( comm )
+    , _polynomial_degree( polynomial_degree )
+    , _n_neighbors( n_neighbors )
+{
+    DTK_REQUIRE( polynomial_degree >= 0 && polynomial_degree <= 2 );
+    DTK_REQUIRE( n_neighbors > 0 );
+}
+
+template <typename DeviceType>
+void MovingLeastSquaresOperator<DeviceType>::build(
+    Kokkos::View<Point *, DeviceType> source_points,
+    Kokkos::View<Point const *, DeviceType> target_points )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const n_nodes = source_points.extent( 0 );
+    Kokkos::View<Box *, DeviceType> boxes( "boxes", n_nodes );
+    Kokkos::parallel_for( REGION_NAME( "compute_bounding_boxes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point const p = source_points( i );
+                              boxes( i ) = {{p[0], p[0], p[1], p[1], p[2],
+                                             p[2]}};
+                          } );
+    Kokkos::fence();
+    DistributedSearchTree<DeviceType> tree( this->_comm, boxes );
+
+    int const n_targets = target_points.extent( 0 );
+    int const n_neighbors = _n_neighbors;
+    Kokkos::View<Details::Nearest<Point> *, DeviceType> queries( "queries",
+                                                                 n_targets );
+    Kokkos::parallel_for( REGION_NAME( "register_nearest_queries" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              queries( i ) = Details::nearest(
+                                  target_points( i ), n_neighbors );
+                          } );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    // fetch the coordinates of the neighbors owned by other processes
+    int const n_entries = indices.extent( 0 );
+    Kokkos::View<Point *, DeviceType> neighbors( "neighbors", n_entries );
+    CommunicationPlan<DeviceType> plan( this->_comm, ranks, indices );
+    plan.doExchange( source_points, neighbors );
+
+    // The coordinates are centered on the target point and scaled by the
+    // radius of the support so that the systems are well conditioned and the
+    // tolerance on the pivots does not depend on the size of the domain.
+    // The radius is slightly larger than the distance to the farthest
+    // neighbor so that every neighbor has a positive weight.
+    int const degree = _polynomial_degree;
+    int const basis_size = Details::polynomialBasisSize( degree );
+    Kokkos::View<double *, DeviceType> weights( "weights", n_entries );
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_moving_least_squares_weights" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+        KOKKOS_LAMBDA( int i ) {
+            Point const x = target_points( i );
+            int const first = offset( i );
+            int const last = offset( i + 1 );
+
+            double radius = 0.;
+            for ( int j = first; j < last; ++j )
+                radius = KokkosHelpers::max(
+                    radius, Details::distance( x, neighbors( j ) ) );
+            radius = ( radius > 0. ) ? 1.1 * radius : 1.;
+
+            double moments[Details::MAX_BASIS_SIZE][Details::MAX_BASIS_SIZE];
+            for ( int k = 0; k < basis_size; ++k )
+                for ( int l = 0; l <= k; ++l )
+                    moments[k][l] = 0.;
+            double p[Details::MAX_BASIS_SIZE];
+            for ( int j = first; j < last; ++j )
+            {
+                Point y;
+                for ( int d = 0; d < 3; ++d )
+                    y[d] = ( neighbors( j )[d] - x[d] ) / radius;
+                double const w =
+                    Details::wendland( Details::distance( x, neighbors( j ) ) /
+                                       radius );
+                Details::evaluatePolynomialBasis( degree, y, p );
+                for ( int k = 0; k < basis_size; ++k )
+                    for ( int l = 0; l <= k; ++l )
+                        moments[k][l] += w * p[k] * p[l];
+            }
+
+            // the target point is the origin where only the constant term of
+            // the basis does not vanish
+            double a[Details::MAX_BASIS_SIZE];
+            a[0] = 1.;
+            for ( int k = 1; k < basis_size; ++k )
+                a[k] = 0.;
+            Details::choleskySolve( basis_size, moments, a );
+
+            for ( int j = first; j < last; ++j )
+            {
+                Point y;
+                for ( int d = 0; d < 3; ++d )
+                    y[d] = ( neighbors( j )[d] - x[d] ) / radius;
+                double const w =
+                    Details::wendland( Details::distance( x, neighbors( j ) ) /
+                                       radius );
+                Details::evaluatePolynomialBasis( degree, y, p );
+                double value = 0.;
+                for ( int k = 0; k < basis_size; ++k )
+                    value += p[k] * a[k];
+                weights( j ) = w * value;
+            }
+        } );
+    Kokkos::fence();
+
+    this->setOperator( offset, indices, ranks, weights );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_MOVINGLEASTSQUARESOPERATOR_INSTANT( NODE )                         \
+    template class MovingLeastSquaresOperator<typename NODE::device_type>;
+
+#endif
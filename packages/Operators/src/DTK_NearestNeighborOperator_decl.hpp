@@ -0,0 +1,151 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_NEAREST_NEIGHBOR_OPERATOR_DECL_HPP
+#define DTK_NEAREST_NEIGHBOR_OPERATOR_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_EvaluationSet.hpp>
+#include <DTK_Field.hpp>
+#include <DTK_NodeList.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Transfer that assigns to each target point the value of its nearest
+ * source node. The nearest nodes are found once in setup() and the operator
+ * is stored as a gather index into the source degrees of freedom, so that
+ * applying it only moves data: the owner of each source node sends its value
+ * directly to the position of the target point, without any arithmetic.
+ */
+template <typename DeviceType>
+class NearestNeighborOperator
+{
+  public:
+    explicit NearestNeighborOperator(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm )
+        : _comm( comm )
+    {
+    }
+
+    // Find the nearest node of source for each point of target, among the
+    // nodes of all processes. Ghost nodes are candidates like any other node
+    // so the source values must be valid on them too. Collective.
+    template <class... ViewProperties>
+    void setup( NodeList<ViewProperties...> const &source,
+                EvaluationSet<ViewProperties...> const &target );
+
+    // target_values(i, d) = source_values(indices(i), d) on process ranks(i)
+    // where (ranks(i), indices(i)) is the nearest node of target point i.
+    // Collective.
+    void apply( Kokkos::View<double **, DeviceType> source_values,
+                Kokkos::View<double **, DeviceType> target_values ) const;
+
+    // Same as above for the degrees of freedom of fields.
+    template <class... ViewProperties>
+    void apply( Field<double, ViewProperties...> const &source,
+                Field<double, ViewProperties...> const &target ) const;
+
+    // Whether setup() has been called.
+    bool isSetUp() const { return _plan.get() != nullptr; }
+
+    // Number of target points on this process.
+    size_t getNumTargets() const { return _ranks.extent( 0 ); }
+
+    // Rank of the process that owns the nearest source node of each target
+    // point and the index of that node on that process.
+    Kokkos::View<int *, DeviceType> getSourceRanks() const { return _ranks; }
+    Kokkos::View<int *, DeviceType> getSourceIndices() const
+    {
+        return _indices;
+    }
+
+  private:
+    void build( Kokkos::View<Box const *, DeviceType> source_boxes,
+                Kokkos::View<Point const *, DeviceType> target_points );
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    Kokkos::View<int *, DeviceType> _ranks;
+    Kokkos::View<int *, DeviceType> _indices;
+    // the imports are ordered as the target points
+    Teuchos::RCP<CommunicationPlan<DeviceType>> _plan;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void NearestNeighborOperator<DeviceType>::setup(
+    NodeList<ViewProperties...> const &source,
+    EvaluationSet<ViewProperties...> const &target )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = source.coordinates;
+    int const n_nodes = coordinates.extent( 0 );
+    int const source_dim = coordinates.extent( 1 );
+    DTK_REQUIRE( n_nodes == 0 || source_dim <= 3 );
+    Kokkos::View<Box *, DeviceType> boxes( "boxes", n_nodes );
+    Kokkos::parallel_for( REGION_NAME( "convert_nodes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < source_dim; ++d )
+                                  p[d] = coordinates( i, d );
+                              boxes( i ) = {{p[0], p[0], p[1], p[1], p[2],
+                                             p[2]}};
+                          } );
+
+    auto const evaluation_points = target.evaluation_points;
+    int const n_targets = evaluation_points.extent( 0 );
+    int const target_dim = evaluation_points.extent( 1 );
+    DTK_REQUIRE( n_targets == 0 || target_dim <= 3 );
+    Kokkos::View<Point *, DeviceType> points( "points", n_targets );
+    Kokkos::parallel_for( REGION_NAME( "convert_points" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < target_dim; ++d )
+                                  p[d] = evaluation_points( i, d );
+                              points( i ) = p;
+                          } );
+    Kokkos::fence();
+
+    build( boxes, points );
+}
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void NearestNeighborOperator<DeviceType>::apply(
+    Field<double, ViewProperties...> const &source,
+    Field<double, ViewProperties...> const &target ) const
+{
+    DTK_REQUIRE( source.dofs.extent( 1 ) == target.dofs.extent( 1 ) );
+
+    int const n_components = source.dofs.extent( 1 );
+    Kokkos::View<double **, DeviceType> source_values(
+        "source_values", source.dofs.extent( 0 ), n_components );
+    Kokkos::View<double **, DeviceType> target_values(
+        "target_values", target.dofs.extent( 0 ), n_components );
+    Kokkos::deep_copy( source_values, source.dofs );
+    apply( source_values, target_values );
+    Kokkos::deep_copy( target.dofs, target_values );
+}
+
+} // end namespace DataTransferKit
+
+#endif
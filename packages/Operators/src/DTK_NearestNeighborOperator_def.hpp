@@ -0,0 +1,67 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_NEAREST_NEIGHBOR_OPERATOR_DEF_HPP
+#define DTK_NEAREST_NEIGHBOR_OPERATOR_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+void NearestNeighborOperator<DeviceType>::build(
+    Kokkos::View<Box const *, DeviceType> source_boxes,
+    Kokkos::View<Point const *, DeviceType> target_points )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    DistributedSearchTree<DeviceType> tree( _comm, source_boxes );
+
+    int const n_targets = target_points.extent( 0 );
+    Kokkos::View<Details::Nearest<Point> *, DeviceType> queries( "queries",
+                                                                 n_targets );
+    Kokkos::parallel_for( REGION_NAME( "register_nearest_queries" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              queries( i ) =
+                                  Details::nearest( target_points( i ), 1 );
+                          } );
+    Kokkos::fence();
+
+    // every query has exactly one result as long as some process has source
+    // nodes
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    _indices = Kokkos::View<int *, DeviceType>( "indices" );
+    _ranks = Kokkos::View<int *, DeviceType>( "ranks" );
+    tree.query( queries, _indices, offset, _ranks );
+    DTK_INSIST( static_cast<int>( _indices.extent( 0 ) ) == n_targets );
+
+    _plan = Teuchos::rcp(
+        new CommunicationPlan<DeviceType>( _comm, _ranks, _indices ) );
+}
+
+template <typename DeviceType>
+void NearestNeighborOperator<DeviceType>::apply(
+    Kokkos::View<double **, DeviceType> source_values,
+    Kokkos::View<double **, DeviceType> target_values ) const
+{
+    DTK_REQUIRE( isSetUp() );
+    DTK_REQUIRE( target_values.extent( 0 ) == getNumTargets() );
+
+    _plan->doExchange( source_values, target_values );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_NEARESTNEIGHBOROPERATOR_INSTANT( NODE )                            \
+    template class NearestNeighborOperator<typename NODE::device_type>;
+
+#endif
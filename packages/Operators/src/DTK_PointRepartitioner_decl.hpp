@@ -0,0 +1,159 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_POINT_REPARTITIONER_DECL_HPP
+#define DTK_POINT_REPARTITIONER_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_EvaluationSet.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Redistribution of evaluation points that balances the work of a transfer
+ * across the processes. The points are ordered along the Z-order curve and
+ * the curve is split into contiguous ranges that carry approximately the
+ * same total work, regardless of how the points were initially distributed.
+ * The values attached to the points may then be moved to the balanced layout
+ * and the results sent back to the original owners of the points.
+ */
+template <typename DeviceType>
+class PointRepartitioner
+{
+  public:
+    // The work of each point is estimated from the number of source objects
+    // of source_tree within radius of it. Collective.
+    template <class... ViewProperties>
+    PointRepartitioner(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm,
+        EvaluationSet<ViewProperties...> const &evaluation_set,
+        DistributedSearchTree<DeviceType> const &source_tree, double radius );
+
+    // weights(i) is the work of points(i). Collective.
+    PointRepartitioner( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                        Kokkos::View<Point const *, DeviceType> points,
+                        Kokkos::View<double const *, DeviceType> weights );
+
+    // Number of points assigned to this process.
+    size_t size() const { return _points.extent( 0 ); }
+
+    // Points assigned to this process.
+    Kokkos::View<Point *, DeviceType> getPoints() const { return _points; }
+
+    // Rank of the process that originally owned each point assigned to this
+    // process and its index on that process.
+    Kokkos::View<int *, DeviceType> getOriginalRanks() const
+    {
+        return _original_ranks;
+    }
+    Kokkos::View<int *, DeviceType> getOriginalIndices() const
+    {
+        return _original_indices;
+    }
+
+    // Move values attached to the points in their original layout to the
+    // points assigned to this process. Collective.
+    template <typename T>
+    void doForward( Kokkos::View<T *, DeviceType> values,
+                    Kokkos::View<T *, DeviceType> repartitioned_values ) const
+    {
+        _forward_plan->doExchange( values, repartitioned_values );
+    }
+    template <typename T>
+    void doForward( Kokkos::View<T **, DeviceType> values,
+                    Kokkos::View<T **, DeviceType> repartitioned_values ) const
+    {
+        _forward_plan->doExchange( values, repartitioned_values );
+    }
+
+    // Send results computed on the points assigned to this process back to
+    // the original owners of the points. Collective.
+    template <typename T>
+    void doReverse( Kokkos::View<T *, DeviceType> repartitioned_values,
+                    Kokkos::View<T *, DeviceType> values ) const
+    {
+        _reverse_plan->doExchange( repartitioned_values, values );
+    }
+    template <typename T>
+    void doReverse( Kokkos::View<T **, DeviceType> repartitioned_values,
+                    Kokkos::View<T **, DeviceType> values ) const
+    {
+        _reverse_plan->doExchange( repartitioned_values, values );
+    }
+
+  private:
+    void build( Kokkos::View<Point const *, DeviceType> points,
+                Kokkos::View<double const *, DeviceType> weights );
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    Kokkos::View<Point *, DeviceType> _points;
+    Kokkos::View<int *, DeviceType> _original_ranks;
+    Kokkos::View<int *, DeviceType> _original_indices;
+    Teuchos::RCP<CommunicationPlan<DeviceType>> _forward_plan;
+    Teuchos::RCP<CommunicationPlan<DeviceType>> _reverse_plan;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+PointRepartitioner<DeviceType>::PointRepartitioner(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    EvaluationSet<ViewProperties...> const &evaluation_set,
+    DistributedSearchTree<DeviceType> const &source_tree, double radius )
+    : _comm( comm )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const evaluation_points = evaluation_set.evaluation_points;
+    int const n = evaluation_points.extent( 0 );
+    int const space_dim = evaluation_points.extent( 1 );
+    DTK_REQUIRE( n == 0 || space_dim <= 3 );
+
+    Kokkos::View<Point *, DeviceType> points( "points", n );
+    Kokkos::View<Details::Within<Point> *, DeviceType> queries( "queries",
+                                                                n );
+    Kokkos::parallel_for( REGION_NAME( "convert_points" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < space_dim; ++d )
+                                  p[d] = evaluation_points( i, d );
+                              points( i ) = p;
+                              queries( i ) = Details::within( p, radius );
+                          } );
+    Kokkos::fence();
+
+    // every point costs at least its own evaluation on top of the candidates
+    // found by the search
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    source_tree.query( queries, indices, offset, ranks );
+    Kokkos::View<double *, DeviceType> weights( "weights", n );
+    Kokkos::parallel_for( REGION_NAME( "count_hits" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          KOKKOS_LAMBDA( int i ) {
+                              weights( i ) = 1 + offset( i + 1 ) - offset( i );
+                          } );
+    Kokkos::fence();
+
+    build( points, weights );
+}
+
+} // end namespace DataTransferKit
+
+#endif
@@ -0,0 +1,153 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_POINT_REPARTITIONER_DEF_HPP
+#define DTK_POINT_REPARTITIONER_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+#include <DTK_DetailsRendezvousImpl.hpp>
+#include <DTK_DetailsTreeConstruction.hpp>
+#include <DTK_KokkosHelpers.hpp>
+
+#include <Teuchos_ArrayView.hpp>
+#include <Tpetra_Distributor.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+PointRepartitioner<DeviceType>::PointRepartitioner(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Point const *, DeviceType> points,
+    Kokkos::View<double const *, DeviceType> weights )
+    : _comm( comm )
+{
+    build( points, weights );
+}
+
+template <typename DeviceType>
+void PointRepartitioner<DeviceType>::build(
+    Kokkos::View<Point const *, DeviceType> points,
+    Kokkos::View<double const *, DeviceType> weights )
+{
+    DTK_REQUIRE( weights.extent( 0 ) == points.extent( 0 ) );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const comm_rank = _comm->getRank();
+    int const n = points.extent( 0 );
+
+    // order the points along the Z-order curve like the objects of a tree
+    Kokkos::View<Box *, DeviceType> boxes( "boxes", n );
+    Kokkos::parallel_for( REGION_NAME( "points_to_boxes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Box box;
+                              for ( int d = 0; d < 3; ++d )
+                                  box[2 * d] = box[2 * d + 1] = points( i )[d];
+                              boxes( i ) = box;
+                          } );
+    Kokkos::fence();
+    Box const global_box =
+        Details::RendezvousImpl<DeviceType>::globalBoundingBox( *_comm, boxes );
+    Kokkos::View<unsigned int *, DeviceType> morton_codes( "morton", n );
+    Details::TreeConstruction<DeviceType>::assignMortonCodes(
+        boxes, morton_codes, global_box );
+
+    std::vector<unsigned int> const splitters =
+        Details::RendezvousImpl<DeviceType>::computeSplitters(
+            *_comm, morton_codes, weights );
+
+    auto morton_codes_host = Kokkos::create_mirror_view( morton_codes );
+    Kokkos::deep_copy( morton_codes_host, morton_codes );
+    Kokkos::View<int *, DeviceType> destinations( "destinations", n );
+    auto destinations_host = Kokkos::create_mirror_view( destinations );
+    for ( int i = 0; i < n; ++i )
+        destinations_host( i ) =
+            std::upper_bound( splitters.begin(), splitters.end(),
+                              morton_codes_host( i ) ) -
+            splitters.begin();
+    Kokkos::deep_copy( destinations, destinations_host );
+
+    // send the points to their new owner
+    Tpetra::Distributor distributor( _comm );
+    int const n_imports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( destinations_host.data(), n ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+    Kokkos::View<int *, DeviceType> export_indices( "export_indices", n );
+    Iota<DeviceType> export_iota( export_indices );
+    Kokkos::parallel_for( REGION_NAME( "set_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          export_iota );
+    Kokkos::fence();
+
+    _points = Kokkos::View<Point *, DeviceType>( "points", n_imports );
+    _original_ranks =
+        Kokkos::View<int *, DeviceType>( "original_ranks", n_imports );
+    _original_indices =
+        Kokkos::View<int *, DeviceType>( "original_indices", n_imports );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, points, _points );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_ranks, _original_ranks );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_indices, _original_indices );
+
+    // tell the original owners where their points went so that the results
+    // can be sent back
+    auto original_ranks_host = Kokkos::create_mirror_view( _original_ranks );
+    Kokkos::deep_copy( original_ranks_host, _original_ranks );
+    Tpetra::Distributor reply_distributor( _comm );
+    reply_distributor.createFromSends( Teuchos::ArrayView<int const>(
+        original_ranks_host.data(), n_imports ) );
+
+    Kokkos::View<int *, DeviceType> import_indices( "import_indices",
+                                                    n_imports );
+    Iota<DeviceType> import_iota( import_indices );
+    Kokkos::parallel_for( REGION_NAME( "set_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+                          import_iota );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> reply_ids( "reply_ids", n );
+    Kokkos::View<int *, DeviceType> reply_indices( "reply_indices", n );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        reply_distributor, _original_indices, reply_ids );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        reply_distributor, import_indices, reply_indices );
+
+    Kokkos::View<int *, DeviceType> new_indices( "new_indices", n );
+    Kokkos::parallel_for( REGION_NAME( "scatter_new_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          KOKKOS_LAMBDA( int i ) {
+                              new_indices( reply_ids( i ) ) =
+                                  reply_indices( i );
+                          } );
+    Kokkos::fence();
+
+    _forward_plan = Teuchos::rcp( new CommunicationPlan<DeviceType>(
+        _comm, _original_ranks, _original_indices ) );
+    _reverse_plan = Teuchos::rcp(
+        new CommunicationPlan<DeviceType>( _comm, destinations, new_indices ) );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_POINTREPARTITIONER_INSTANT( NODE )                                 \
+    template class PointRepartitioner<typename NODE::device_type>;
+
+#endif
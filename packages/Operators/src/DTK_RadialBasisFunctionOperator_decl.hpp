@@ -0,0 +1,146 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_RADIAL_BASIS_FUNCTION_OPERATOR_DECL_HPP
+#define DTK_RADIAL_BASIS_FUNCTION_OPERATOR_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_EvaluationSet.hpp>
+#include <DTK_Map.hpp>
+#include <DTK_NodeList.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Interpolation with compactly supported radial basis functions. The
+ * interpolant is the sum over the source nodes x_j of c_j phi(|x - x_j| / r)
+ * where phi is Wendland's C2 function and r the radius of the support. The
+ * coefficients c_j are such that the interpolant matches the source values
+ * at the source nodes.
+ *
+ * Since phi vanishes beyond r, the interpolation matrix only couples the
+ * pairs of source nodes within r of each other and the evaluation matrix the
+ * target points and the source nodes within r of them. Both are sparse and
+ * stored as Maps so that setup() only runs two radius searches. The
+ * interpolation matrix is symmetric positive definite and each apply()
+ * solves for the coefficients with the conjugate gradient method before
+ * evaluating the interpolant at the target points.
+ */
+template <typename DeviceType>
+class RadialBasisFunctionOperator : public Map<DeviceType>
+{
+  public:
+    // The conjugate gradient stops when the norm of the residual is smaller
+    // than tolerance times the norm of the source values.
+    RadialBasisFunctionOperator( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                                 double radius, double tolerance = 1e-10,
+                                 int max_iterations = 1000 );
+
+    // Build the interpolation and evaluation matrices. Collective.
+    template <class... ViewProperties>
+    void setup( NodeList<ViewProperties...> const &source,
+                EvaluationSet<ViewProperties...> const &target );
+
+    // Solve for the coefficients of the interpolant of source_values and
+    // evaluate it at the target points. Target points with no source node
+    // within the radius get zero. Collective.
+    void apply( Kokkos::View<double **, DeviceType> source_values,
+                Kokkos::View<double **, DeviceType> target_values ) const;
+
+    using Map<DeviceType>::apply;
+
+    // Largest number of iterations of the conjugate gradient over the
+    // components of the source values during the last apply().
+    int getNumIterations() const { return _num_iterations; }
+
+  private:
+    // Distributed sparse matrix whose rows are the source nodes.
+    class InterpolationMatrix : public Map<DeviceType>
+    {
+      public:
+        using Map<DeviceType>::Map;
+        using Map<DeviceType>::setOperator;
+    };
+
+    void build( Kokkos::View<Point *, DeviceType> source_points,
+                Kokkos::View<Point const *, DeviceType> target_points );
+
+    // Entries of the rows of the matrix of phi between the query points and
+    // the source nodes within the radius.
+    void computeEntries( DistributedSearchTree<DeviceType> const &tree,
+                         Kokkos::View<Point *, DeviceType> source_points,
+                         Kokkos::View<Point const *, DeviceType> query_points,
+                         Kokkos::View<int *, DeviceType> &offset,
+                         Kokkos::View<int *, DeviceType> &indices,
+                         Kokkos::View<int *, DeviceType> &ranks,
+                         Kokkos::View<double *, DeviceType> &values ) const;
+
+    // Dot product of the first columns of u and v over all the processes.
+    double dot( Kokkos::View<double **, DeviceType> u,
+                Kokkos::View<double **, DeviceType> v ) const;
+
+    double _radius;
+    double _tolerance;
+    int _max_iterations;
+    Teuchos::RCP<InterpolationMatrix> _interpolation_matrix;
+    mutable int _num_iterations = 0;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+void RadialBasisFunctionOperator<DeviceType>::setup(
+    NodeList<ViewProperties...> const &source,
+    EvaluationSet<ViewProperties...> const &target )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = source.coordinates;
+    int const n_nodes = coordinates.extent( 0 );
+    int const source_dim = coordinates.extent( 1 );
+    DTK_REQUIRE( n_nodes == 0 || source_dim <= 3 );
+    Kokkos::View<Point *, DeviceType> source_points( "source_points",
+                                                     n_nodes );
+    Kokkos::parallel_for( REGION_NAME( "convert_nodes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < source_dim; ++d )
+                                  p[d] = coordinates( i, d );
+                              source_points( i ) = p;
+                          } );
+
+    auto const evaluation_points = target.evaluation_points;
+    int const n_targets = evaluation_points.extent( 0 );
+    int const target_dim = evaluation_points.extent( 1 );
+    DTK_REQUIRE( n_targets == 0 || target_dim <= 3 );
+    Kokkos::View<Point *, DeviceType> target_points( "target_points",
+                                                     n_targets );
+    Kokkos::parallel_for( REGION_NAME( "convert_points" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_targets ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point p = {{0., 0., 0.}};
+                              for ( int d = 0; d < target_dim; ++d )
+                                  p[d] = evaluation_points( i, d );
+                              target_points( i ) = p;
+                          } );
+    Kokkos::fence();
+
+    build( source_points, target_points );
+}
+
+} // end namespace DataTransferKit
+
+#endif
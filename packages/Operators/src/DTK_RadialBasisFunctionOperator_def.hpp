@@ -0,0 +1,222 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_RADIAL_BASIS_FUNCTION_OPERATOR_DEF_HPP
+#define DTK_RADIAL_BASIS_FUNCTION_OPERATOR_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsAlgorithms.hpp>
+#include <DTK_DetailsMovingLeastSquares.hpp>
+#include <DTK_DetailsPredicate.hpp>
+
+#include <Teuchos_CommHelpers.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+RadialBasisFunctionOperator<DeviceType>::RadialBasisFunctionOperator(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm, double radius,
+    double tolerance, int max_iterations )
+    : Map<DeviceType>( comm )
+    , _radius( radius )
+    , _tolerance( tolerance )
+    , _max_iterations( max_iterations )
+{
+    DTK_REQUIRE( radius > 0. );
+    DTK_REQUIRE( tolerance > 0. );
+    DTK_REQUIRE( max_iterations > 0 );
+}
+
+template <typename DeviceType>
+void RadialBasisFunctionOperator<DeviceType>::computeEntries(
+    DistributedSearchTree<DeviceType> const &tree,
+    Kokkos::View<Point *, DeviceType> source_points,
+    Kokkos::View<Point const *, DeviceType> query_points,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<double *, DeviceType> &values ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const n_queries = query_points.extent( 0 );
+    double const radius = _radius;
+    Kokkos::View<Details::Within<Point> *, DeviceType> queries( "queries",
+                                                                n_queries );
+    Kokkos::parallel_for( REGION_NAME( "register_within_queries" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+                          KOKKOS_LAMBDA( int i ) {
+                              queries( i ) =
+                                  Details::within( query_points( i ), radius );
+                          } );
+    Kokkos::fence();
+
+    tree.query( queries, indices, offset, ranks );
+
+    // fetch the coordinates of the source nodes owned by other processes
+    int const n_entries = indices.extent( 0 );
+    Kokkos::View<Point *, DeviceType> neighbors( "neighbors", n_entries );
+    CommunicationPlan<DeviceType> plan( this->_comm, ranks, indices );
+    plan.doExchange( source_points, neighbors );
+
+    values = Kokkos::View<double *, DeviceType>( "values", n_entries );
+    auto const row_offset = offset;
+    Kokkos::parallel_for(
+        REGION_NAME( "evaluate_radial_basis_functions" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int i ) {
+            for ( int j = row_offset( i ); j < row_offset( i + 1 ); ++j )
+                values( j ) = Details::wendland(
+                    Details::distance( query_points( i ), neighbors( j ) ) /
+                    radius );
+        } );
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+void RadialBasisFunctionOperator<DeviceType>::build(
+    Kokkos::View<Point *, DeviceType> source_points,
+    Kokkos::View<Point const *, DeviceType> target_points )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const n_nodes = source_points.extent( 0 );
+    Kokkos::View<Box *, DeviceType> boxes( "boxes", n_nodes );
+    Kokkos::parallel_for( REGION_NAME( "compute_bounding_boxes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+                          KOKKOS_LAMBDA( int i ) {
+                              Point const p = source_points( i );
+                              boxes( i ) = {{p[0], p[0], p[1], p[1], p[2],
+                                             p[2]}};
+                          } );
+    Kokkos::fence();
+    DistributedSearchTree<DeviceType> tree( this->_comm, boxes );
+
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    Kokkos::View<double *, DeviceType> values( "values" );
+
+    // self search of the source nodes
+    computeEntries( tree, source_points, source_points, offset, indices,
+                    ranks, values );
+    _interpolation_matrix =
+        Teuchos::rcp( new InterpolationMatrix( this->_comm ) );
+    _interpolation_matrix->setOperator( offset, indices, ranks, values );
+
+    computeEntries( tree, source_points, target_points, offset, indices,
+                    ranks, values );
+    this->setOperator( offset, indices, ranks, values );
+}
+
+template <typename DeviceType>
+double RadialBasisFunctionOperator<DeviceType>::dot(
+    Kokkos::View<double **, DeviceType> u,
+    Kokkos::View<double **, DeviceType> v ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    double local = 0.;
+    Kokkos::parallel_reduce(
+        REGION_NAME( "dot_product" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, u.extent( 0 ) ),
+        KOKKOS_LAMBDA( int i, double &partial ) {
+            partial += u( i, 0 ) * v( i, 0 );
+        },
+        local );
+    double global = 0.;
+    Teuchos::reduceAll( *this->_comm, Teuchos::REDUCE_SUM, local,
+                        Teuchos::ptr( &global ) );
+    return global;
+}
+
+template <typename DeviceType>
+void RadialBasisFunctionOperator<DeviceType>::apply(
+    Kokkos::View<double **, DeviceType> source_values,
+    Kokkos::View<double **, DeviceType> target_values ) const
+{
+    DTK_REQUIRE( this->isSetUp() );
+    DTK_REQUIRE( source_values.extent( 0 ) ==
+                 _interpolation_matrix->getNumRows() );
+    DTK_REQUIRE( source_values.extent( 1 ) == target_values.extent( 1 ) );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    int const n = source_values.extent( 0 );
+    int const n_components = source_values.extent( 1 );
+
+    // the components are solved for one after the other
+    Kokkos::View<double **, DeviceType> coefficients( "coefficients", n,
+                                                      n_components );
+    Kokkos::View<double **, DeviceType> x( "x", n, 1 );
+    Kokkos::View<double **, DeviceType> r( "r", n, 1 );
+    Kokkos::View<double **, DeviceType> p( "p", n, 1 );
+    Kokkos::View<double **, DeviceType> q( "q", n, 1 );
+    _num_iterations = 0;
+    for ( int d = 0; d < n_components; ++d )
+    {
+        Kokkos::parallel_for( REGION_NAME( "initialize_conjugate_gradient" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                              KOKKOS_LAMBDA( int i ) {
+                                  x( i, 0 ) = 0.;
+                                  r( i, 0 ) = source_values( i, d );
+                                  p( i, 0 ) = source_values( i, d );
+                              } );
+        Kokkos::fence();
+
+        double rr = dot( r, r );
+        double const threshold = _tolerance * _tolerance * rr;
+        int iteration = 0;
+        while ( rr > threshold && iteration < _max_iterations )
+        {
+            _interpolation_matrix->apply( p, q );
+            double const alpha = rr / dot( p, q );
+            Kokkos::parallel_for( REGION_NAME( "update_solution" ),
+                                  Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                                  KOKKOS_LAMBDA( int i ) {
+                                      x( i, 0 ) += alpha * p( i, 0 );
+                                      r( i, 0 ) -= alpha * q( i, 0 );
+                                  } );
+            Kokkos::fence();
+            double const rr_new = dot( r, r );
+            double const beta = rr_new / rr;
+            Kokkos::parallel_for( REGION_NAME( "update_direction" ),
+                                  Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                                  KOKKOS_LAMBDA( int i ) {
+                                      p( i, 0 ) = r( i, 0 ) + beta * p( i, 0 );
+                                  } );
+            Kokkos::fence();
+            rr = rr_new;
+            ++iteration;
+        }
+        DTK_INSIST( rr <= threshold );
+        _num_iterations = std::max( _num_iterations, iteration );
+
+        Kokkos::parallel_for( REGION_NAME( "copy_coefficients" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                              KOKKOS_LAMBDA( int i ) {
+                                  coefficients( i, d ) = x( i, 0 );
+                              } );
+        Kokkos::fence();
+    }
+
+    Map<DeviceType>::apply( coefficients, target_values );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_RADIALBASISFUNCTIONOPERATOR_INSTANT( NODE )                        \
+    template class RadialBasisFunctionOperator<typename NODE::device_type>;
+
+#endif
@@ -0,0 +1,182 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_SURFACE_PROJECTION_DECL_HPP
+#define DTK_SURFACE_PROJECTION_DECL_HPP
+
+#include <Kokkos_Core.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsPoint.hpp>
+#include <DTK_DetailsReferenceCell.hpp>
+#include <DTK_DetailsTriangle.hpp>
+#include <DTK_LinearBVH.hpp>
+
+namespace DataTransferKit
+{
+/**
+ * Projection of points on the boundary of a mesh, e.g. the nodes of a fluid
+ * mesh on the wetted surface of a structure. The boundary faces, triangles
+ * or quadrilaterals, are stored in a BVH of their bounding boxes. The search
+ * is a best-first traversal of the hierarchy that uses the exact distance
+ * from the point to the faces at the leaves, so that the faces are found by
+ * increasing distance and no candidate needs to be checked afterwards.
+ *
+ * The search is local to the process, the points and the boundary must be
+ * on the same process.
+ */
+template <typename DeviceType>
+class SurfaceProjection
+{
+  public:
+    // The boundary faces are given by cell_list.boundary_cells and
+    // cell_list.cell_faces_on_boundary, face i being the face
+    // cell_faces_on_boundary(i) of the cell boundary_cells(i). The cells all
+    // have the same topology, tetrahedra, hexahedra, wedges or pyramids.
+    template <class... ViewProperties>
+    explicit SurfaceProjection( CellList<ViewProperties...> const &cell_list )
+        : _nodes_per_face( countFaceNodes( cell_list ) )
+        , _face_nodes( packFaceNodes( cell_list ) )
+        , _bvh( computeFaceBoxes( _nodes_per_face, _face_nodes ) )
+    {
+    }
+
+    // Find the k faces closest to each point points(i, :), fewer if there
+    // are not that many faces. They are faces(j) for offset(i) <= j <
+    // offset(i + 1) by increasing distance distances(j) from the point. The
+    // closest point on the face has the parametric coordinates
+    // parametric_coordinates(j, :), (u, v) of closestPointOnTriangle() for a
+    // triangle and (s, t) of closestPointOnQuadrilateral() for a
+    // quadrilateral, the nodes being taken in the order of the face.
+    void query( Kokkos::View<double **, DeviceType> points, int k,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<int *, DeviceType> &faces,
+                Kokkos::View<double **, DeviceType> &parametric_coordinates,
+                Kokkos::View<double *, DeviceType> &distances ) const;
+
+    // Number of boundary faces.
+    size_t size() const { return _nodes_per_face.extent( 0 ); }
+
+  private:
+    template <class... ViewProperties>
+    static Kokkos::View<int *, DeviceType>
+    countFaceNodes( CellList<ViewProperties...> const &cell_list );
+
+    template <class... ViewProperties>
+    static Kokkos::View<double **, DeviceType>
+    packFaceNodes( CellList<ViewProperties...> const &cell_list );
+
+    static Kokkos::View<Box *, DeviceType>
+    computeFaceBoxes( Kokkos::View<int *, DeviceType> nodes_per_face,
+                      Kokkos::View<double **, DeviceType> face_nodes );
+
+    // Closest point to p on the face f, returns its distance to p.
+    KOKKOS_INLINE_FUNCTION
+    static double projectOnFace( Kokkos::View<int *, DeviceType> nodes_per_face,
+                                 Kokkos::View<double **, DeviceType> face_nodes,
+                                 int f, Point const &p, double &s, double &t )
+    {
+        Point nodes[4];
+        for ( int k = 0; k < nodes_per_face( f ); ++k )
+            for ( int d = 0; d < 3; ++d )
+                nodes[k][d] = face_nodes( 4 * f + k, d );
+        Point const q =
+            ( nodes_per_face( f ) == 3 )
+                ? Details::closestPointOnTriangle( p, nodes[0], nodes[1],
+                                                   nodes[2], s, t )
+                : Details::closestPointOnQuadrilateral(
+                      p, nodes[0], nodes[1], nodes[2], nodes[3], s, t );
+        Point const pq = Details::difference( q, p );
+        return std::sqrt( Details::dot( pq, pq ) );
+    }
+
+    // face_nodes(4 * f + k, d) is the d-th coordinate of the k-th node of
+    // the face f, which has nodes_per_face(f) nodes
+    Kokkos::View<int *, DeviceType> _nodes_per_face;
+    Kokkos::View<double **, DeviceType> _face_nodes;
+    BVH<DeviceType> _bvh;
+};
+
+template <typename DeviceType>
+template <class... ViewProperties>
+Kokkos::View<int *, DeviceType> SurfaceProjection<DeviceType>::countFaceNodes(
+    CellList<ViewProperties...> const &cell_list )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const cells = cell_list.cells;
+    auto const cell_faces_on_boundary = cell_list.cell_faces_on_boundary;
+    int const n_faces = cell_list.boundary_cells.extent( 0 );
+    DTK_REQUIRE( cell_faces_on_boundary.extent( 0 ) ==
+                 cell_list.boundary_cells.extent( 0 ) );
+    Kokkos::View<int *, DeviceType> nodes_per_face( "nodes_per_face",
+                                                    n_faces );
+    if ( n_faces == 0 )
+        return nodes_per_face;
+
+    DTK_REQUIRE( cells.rank() == 2 );
+    Details::CellTopology topology;
+    DTK_INSIST( Details::cellTopologyFromNodesPerCell( cells.extent( 1 ),
+                                                       topology ) );
+    Kokkos::parallel_for( REGION_NAME( "count_face_nodes" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_faces ),
+                          KOKKOS_LAMBDA( int f ) {
+                              nodes_per_face( f ) = Details::nodesPerFace(
+                                  topology, cell_faces_on_boundary( f ) );
+                          } );
+    Kokkos::fence();
+    return nodes_per_face;
+}
+
+template <typename DeviceType>
+template <class... ViewProperties>
+Kokkos::View<double **, DeviceType>
+SurfaceProjection<DeviceType>::packFaceNodes(
+    CellList<ViewProperties...> const &cell_list )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    auto const coordinates = cell_list.coordinates;
+    auto const cells = cell_list.cells;
+    auto const boundary_cells = cell_list.boundary_cells;
+    auto const cell_faces_on_boundary = cell_list.cell_faces_on_boundary;
+    int const n_faces = boundary_cells.extent( 0 );
+    Kokkos::View<double **, DeviceType> face_nodes( "face_nodes", 4 * n_faces,
+                                                    3 );
+    if ( n_faces == 0 )
+        return face_nodes;
+
+    DTK_REQUIRE( coordinates.extent( 1 ) == 3 );
+    Details::CellTopology topology;
+    DTK_INSIST( Details::cellTopologyFromNodesPerCell( cells.extent( 1 ),
+                                                       topology ) );
+    Kokkos::parallel_for(
+        REGION_NAME( "pack_face_nodes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_faces ),
+        KOKKOS_LAMBDA( int f ) {
+            int const cell = boundary_cells( f );
+            int const face = cell_faces_on_boundary( f );
+            for ( int k = 0; k < Details::nodesPerFace( topology, face ); ++k )
+            {
+                int const node =
+                    cells( cell, Details::faceNode( topology, face, k ) );
+                for ( int d = 0; d < 3; ++d )
+                    face_nodes( 4 * f + k, d ) = coordinates( node, d );
+            }
+        } );
+    Kokkos::fence();
+    return face_nodes;
+}
+
+} // end namespace DataTransferKit
+
+#endif
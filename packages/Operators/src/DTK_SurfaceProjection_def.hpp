@@ -0,0 +1,145 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_SURFACE_PROJECTION_DEF_HPP
+#define DTK_SURFACE_PROJECTION_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_BoundingBoxes.hpp>
+#include <DTK_DetailsPriorityQueue.hpp>
+#include <DTK_DetailsTreeTraversal.hpp>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+Kokkos::View<Box *, DeviceType> SurfaceProjection<DeviceType>::computeFaceBoxes(
+    Kokkos::View<int *, DeviceType> nodes_per_face,
+    Kokkos::View<double **, DeviceType> face_nodes )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const n_faces = nodes_per_face.extent( 0 );
+    Kokkos::View<Box *, DeviceType> boxes( "face_boxes", n_faces );
+    Kokkos::parallel_for(
+        REGION_NAME( "compute_face_bounding_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_faces ),
+        KOKKOS_LAMBDA( int f ) {
+            Box box;
+            for ( int k = 0; k < nodes_per_face( f ); ++k )
+                Details::expandByNode( box, face_nodes, 4 * f + k, 3 );
+            boxes( f ) = box;
+        } );
+    Kokkos::fence();
+    return boxes;
+}
+
+template <typename DeviceType>
+void SurfaceProjection<DeviceType>::query(
+    Kokkos::View<double **, DeviceType> points, int k,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &faces,
+    Kokkos::View<double **, DeviceType> &parametric_coordinates,
+    Kokkos::View<double *, DeviceType> &distances ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    DTK_REQUIRE( k >= 0 );
+    int const n_points = points.extent( 0 );
+    DTK_REQUIRE( n_points == 0 || points.extent( 1 ) == 3 );
+
+    // the traversal always finds min(k, number of faces) faces so that the
+    // offsets are known before the search, as many as its priority queue can
+    // hold at most
+    using Queue = Details::PriorityQueue<Kokkos::pair<Node const *, double>>;
+    int const n_found = ( k < static_cast<int>( size() ) ) ? k : size();
+    DTK_REQUIRE( n_found <= static_cast<int>( Queue::maxSize() ) );
+    Kokkos::realloc( offset, n_points + 1 );
+    Kokkos::realloc( faces, n_points * n_found );
+    Kokkos::realloc( parametric_coordinates, n_points * n_found, 2 );
+    Kokkos::realloc( distances, n_points * n_found );
+    auto const nodes_per_face = _nodes_per_face;
+    auto const face_nodes = _face_nodes;
+    BVH<DeviceType> bvh = _bvh;
+    Kokkos::parallel_for(
+        REGION_NAME( "project_on_surface" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points + 1 ),
+        KOKKOS_LAMBDA( int i ) {
+            offset( i ) = n_found * i;
+            if ( i == n_points || n_found == 0 )
+                return;
+            Point const p = {{points( i, 0 ), points( i, 1 ), points( i, 2 )}};
+
+            // The faces reported are the n_found closest to p among those
+            // evaluated at the leaves, keep the parametric coordinates of
+            // these instead of projecting p again when inserting them.
+            int cached_faces[Queue::maxSize()];
+            double cached_distances[Queue::maxSize()];
+            double cached_coordinates[Queue::maxSize()][2];
+            int n_cached = 0;
+            auto const leaf_distance = [&]( int f, Box const & ) {
+                double s;
+                double t;
+                double const distance =
+                    projectOnFace( nodes_per_face, face_nodes, f, p, s, t );
+                int l = n_cached;
+                if ( n_cached < n_found )
+                    ++n_cached;
+                else
+                {
+                    // replace the farthest face if this one is closer
+                    l = 0;
+                    for ( int m = 1; m < n_cached; ++m )
+                        if ( cached_distances[m] > cached_distances[l] )
+                            l = m;
+                    if ( distance >= cached_distances[l] )
+                        return distance;
+                }
+                cached_faces[l] = f;
+                cached_distances[l] = distance;
+                cached_coordinates[l][0] = s;
+                cached_coordinates[l][1] = t;
+                return distance;
+            };
+            int count = 0;
+            auto const insert = [&]( int f, double distance ) {
+                int const j = n_found * i + count++;
+                int l = 0;
+                while ( l < n_cached && cached_faces[l] != f )
+                    ++l;
+                double s;
+                double t;
+                if ( l < n_cached )
+                {
+                    s = cached_coordinates[l][0];
+                    t = cached_coordinates[l][1];
+                }
+                else
+                {
+                    // lost a tie with another face at the same distance
+                    projectOnFace( nodes_per_face, face_nodes, f, p, s, t );
+                }
+                faces( j ) = f;
+                parametric_coordinates( j, 0 ) = s;
+                parametric_coordinates( j, 1 ) = t;
+                distances( j ) = distance;
+            };
+            Details::TreeTraversal<DeviceType>::queryNearest(
+                bvh, p, n_found, leaf_distance, insert );
+        } );
+    Kokkos::fence();
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_SURFACEPROJECTION_INSTANT( NODE )                                  \
+    template class SurfaceProjection<typename NODE::device_type>;
+
+#endif
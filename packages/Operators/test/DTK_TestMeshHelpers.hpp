@@ -0,0 +1,118 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_TESTMESHHELPERS_HPP
+#define DTK_TESTMESHHELPERS_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+#include <vector>
+
+// Copy a std::vector into a new view.
+template <typename T, typename DeviceType>
+Kokkos::View<T *, Kokkos::LayoutLeft, DeviceType>
+toView( std::vector<T> const &v, std::string const &label )
+{
+    Kokkos::View<T *, Kokkos::LayoutLeft, DeviceType> view( label, v.size() );
+    auto view_host = Kokkos::create_mirror_view( view );
+    for ( unsigned int i = 0; i < v.size(); ++i )
+        view_host( i ) = v[i];
+    Kokkos::deep_copy( view, view_host );
+    return view;
+}
+
+// Structured mesh of p^3 cubes of side h with the lower corner at
+// (0, 0, z0), either as hexahedra or cut into six tetrahedra, two wedges or
+// six pyramids each. The tetrahedra share the diagonal from vertex 0 to
+// vertex 6 of the cube, the wedges the vertical face through vertices 0, 2,
+// 4 and 6 and the pyramids have their apex at the center of the cube. The
+// node (a, b, c) of the grid has the index a + (p + 1) * (b + (p + 1) * c),
+// the centers of the cubes of the pyramids come after the grid nodes.
+template <typename DeviceType>
+DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType>
+buildStructuredMesh( int nodes_per_cell, int p, double h = 1., double z0 = 0. )
+{
+    int const n_grid_nodes = ( p + 1 ) * ( p + 1 ) * ( p + 1 );
+    int const n_nodes = n_grid_nodes + ( nodes_per_cell == 5 ? p * p * p : 0 );
+    int const cells_per_cube =
+        ( nodes_per_cell == 8 ) ? 1 : ( nodes_per_cell == 6 ) ? 2 : 6;
+    int const n_cells = cells_per_cube * p * p * p;
+
+    DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType> mesh;
+    mesh.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n_nodes, 3 );
+    mesh.cells =
+        Kokkos::DynRankView<DataTransferKit::LocalOrdinal, Kokkos::LayoutLeft,
+                            DeviceType>( "cells", n_cells, nodes_per_cell );
+    auto coordinates_host = Kokkos::create_mirror_view( mesh.coordinates );
+    auto cells_host = Kokkos::create_mirror_view( mesh.cells );
+    auto node = [p]( int a, int b, int c ) {
+        return a + ( p + 1 ) * ( b + ( p + 1 ) * c );
+    };
+    auto center = [p, n_grid_nodes]( int a, int b, int c ) {
+        return n_grid_nodes + a + p * ( b + p * c );
+    };
+    for ( int c = 0; c <= p; ++c )
+        for ( int b = 0; b <= p; ++b )
+            for ( int a = 0; a <= p; ++a )
+            {
+                coordinates_host( node( a, b, c ), 0 ) = h * a;
+                coordinates_host( node( a, b, c ), 1 ) = h * b;
+                coordinates_host( node( a, b, c ), 2 ) = z0 + h * c;
+                if ( nodes_per_cell == 5 && a < p && b < p && c < p )
+                {
+                    coordinates_host( center( a, b, c ), 0 ) = h * ( a + .5 );
+                    coordinates_host( center( a, b, c ), 1 ) = h * ( b + .5 );
+                    coordinates_host( center( a, b, c ), 2 ) =
+                        z0 + h * ( c + .5 );
+                }
+            }
+    int const tets[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+                            {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+    int const wedges[2][6] = {{0, 1, 2, 4, 5, 6}, {0, 2, 3, 4, 6, 7}};
+    // the bases of the pyramids are counterclockwise seen from their apex
+    int const faces[6][4] = {{0, 1, 2, 3}, {4, 7, 6, 5}, {0, 4, 5, 1},
+                             {1, 5, 6, 2}, {2, 6, 7, 3}, {3, 7, 4, 0}};
+    int cell = 0;
+    for ( int c = 0; c < p; ++c )
+        for ( int b = 0; b < p; ++b )
+            for ( int a = 0; a < p; ++a )
+            {
+                int const hex[8] = {node( a, b, c ),
+                                    node( a + 1, b, c ),
+                                    node( a + 1, b + 1, c ),
+                                    node( a, b + 1, c ),
+                                    node( a, b, c + 1 ),
+                                    node( a + 1, b, c + 1 ),
+                                    node( a + 1, b + 1, c + 1 ),
+                                    node( a, b + 1, c + 1 )};
+                for ( int t = 0; t < cells_per_cube; ++t, ++cell )
+                    for ( int k = 0; k < nodes_per_cell; ++k )
+                    {
+                        int vertex = hex[k];
+                        if ( nodes_per_cell == 4 )
+                            vertex = hex[tets[t][k]];
+                        else if ( nodes_per_cell == 6 )
+                            vertex = hex[wedges[t][k]];
+                        else if ( nodes_per_cell == 5 )
+                            vertex = ( k < 4 ) ? hex[faces[t][k]]
+                                               : center( a, b, c );
+                        cells_host( cell, k ) = vertex;
+                    }
+            }
+    Kokkos::deep_copy( mesh.coordinates, coordinates_host );
+    Kokkos::deep_copy( mesh.cells, cells_host );
+    return mesh;
+}
+
+#endif
@@ -0,0 +1,180 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#include "DTK_ConfigDefs.hpp"
+#include "DTK_TestMeshHelpers.hpp"
+#include <DTK_BoundingBoxes.hpp>
+#include <DTK_LinearBVH.hpp>
+
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <vector>
+
+// Check the boxes against the expected ones, given as (xmin, xmax, ymin,
+// ymax, zmin, zmax).
+template <typename BoxView>
+void checkBoxes( BoxView boxes,
+                 std::vector<std::vector<double>> const &boxes_ref,
+                 Teuchos::FancyOStream &out, bool &success )
+{
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    Kokkos::deep_copy( boxes_host, boxes );
+    TEST_EQUALITY( boxes_host.extent( 0 ), boxes_ref.size() );
+    for ( unsigned int c = 0; c < boxes_ref.size(); ++c )
+        for ( int k = 0; k < 6; ++k )
+            TEST_FLOATING_EQUALITY( boxes_host( c )[k] + 10.,
+                                    boxes_ref[c][k] + 10., 1e-14 );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( BoundingBoxes, single_topology,
+                                   DeviceType )
+{
+    // two quadrilaterals in the plane, the second one rotated
+    DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType> cell_list;
+    std::vector<std::vector<double>> const nodes = {
+        {0., 0.}, {1., 0.}, {1., 1.}, {0., 1.}, {2., 0.5}, {1.5, 1.}};
+    std::vector<std::vector<int>> const quads = {{0, 1, 2, 3}, {1, 4, 5, 2}};
+    cell_list.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", nodes.size(), 2 );
+    cell_list.cells =
+        Kokkos::DynRankView<DataTransferKit::LocalOrdinal, Kokkos::LayoutLeft,
+                            DeviceType>( "cells", quads.size(), 4 );
+    auto coordinates_host = Kokkos::create_mirror_view( cell_list.coordinates );
+    for ( unsigned int i = 0; i < nodes.size(); ++i )
+        for ( int d = 0; d < 2; ++d )
+            coordinates_host( i, d ) = nodes[i][d];
+    Kokkos::deep_copy( cell_list.coordinates, coordinates_host );
+    auto cells_host = Kokkos::create_mirror_view( cell_list.cells );
+    for ( unsigned int c = 0; c < quads.size(); ++c )
+        for ( int k = 0; k < 4; ++k )
+            cells_host( c, k ) = quads[c][k];
+    Kokkos::deep_copy( cell_list.cells, cells_host );
+
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes",
+                                                           quads.size() );
+    DataTransferKit::computeBoundingBoxes( cell_list, boxes );
+    checkBoxes( boxes, {{0., 1., 0., 1., 0., 0.}, {1., 2., 0., 1., 0., 0.}},
+                out, success );
+
+    DataTransferKit::computeBoundingBoxes( cell_list, boxes, 0.1 );
+    checkBoxes( boxes,
+                {{-0.1, 1.1, -0.1, 1.1, -0.1, 0.1},
+                 {0.9, 2.1, -0.1, 1.1, -0.1, 0.1}},
+                out, success );
+
+    // the boxes feed the search tree directly
+    DataTransferKit::BVH<DeviceType> bvh( boxes );
+    TEST_EQUALITY( bvh.size(), quads.size() );
+    std::vector<double> const bounds_ref = {-0.1, 2.1, -0.1, 1.1, -0.1, 0.1};
+    for ( int k = 0; k < 6; ++k )
+        TEST_FLOATING_EQUALITY( bvh.bounds()[k] + 10., bounds_ref[k] + 10.,
+                                1e-14 );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( BoundingBoxes, mixed_topology, DeviceType )
+{
+    // a pyramid (topology 1) on top of the unit square, a tetrahedron
+    // (topology 0) below it and a cell without any node (topology 2)
+    DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType> cell_list;
+    std::vector<std::vector<double>> const nodes = {
+        {0., 0., 0.}, {1., 0., 0.}, {1., 1., 0.},
+        {0., 1., 0.}, {0.5, 0.5, 2.}, {0.2, 0.3, -1.}};
+    std::vector<DataTransferKit::LocalOrdinal> const cells = {0, 1, 2, 3, 4,
+                                                              0, 1, 3, 5};
+    std::vector<unsigned> const cell_topology_ids = {1, 0, 2};
+    cell_list.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", nodes.size(), 3 );
+    auto coordinates_host = Kokkos::create_mirror_view( cell_list.coordinates );
+    for ( unsigned int i = 0; i < nodes.size(); ++i )
+        for ( int d = 0; d < 3; ++d )
+            coordinates_host( i, d ) = nodes[i][d];
+    Kokkos::deep_copy( cell_list.coordinates, coordinates_host );
+    cell_list.cells =
+        toView<DataTransferKit::LocalOrdinal, DeviceType>( cells, "cells" );
+    cell_list.cell_topology_ids = toView<unsigned, DeviceType>(
+        cell_topology_ids, "cell_topology_ids" );
+
+    Kokkos::View<unsigned *, DeviceType> nodes_per_topology(
+        "nodes_per_topology", 3 );
+    auto nodes_per_topology_host =
+        Kokkos::create_mirror_view( nodes_per_topology );
+    nodes_per_topology_host( 0 ) = 4;
+    nodes_per_topology_host( 1 ) = 5;
+    nodes_per_topology_host( 2 ) = 0;
+    Kokkos::deep_copy( nodes_per_topology, nodes_per_topology_host );
+
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", 3 );
+    DataTransferKit::computeBoundingBoxes( cell_list, nodes_per_topology,
+                                           boxes, 0.5 );
+    checkBoxes( Kokkos::subview( boxes, Kokkos::make_pair( 0, 2 ) ),
+                {{-0.5, 1.5, -0.5, 1.5, -0.5, 2.5},
+                 {-0.5, 1.5, -0.5, 1.5, -1.5, 0.5}},
+                out, success );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    Kokkos::deep_copy( boxes_host, boxes );
+    for ( int d = 0; d < 3; ++d )
+        TEST_ASSERT( boxes_host( 2 )[2 * d] > boxes_host( 2 )[2 * d + 1] );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( BoundingBoxes, polyhedra, DeviceType )
+{
+    // a tetrahedron and a triangular prism sharing the face (1, 2, 3)
+    DataTransferKit::PolyhedronList<Kokkos::LayoutLeft, DeviceType> polyhedra;
+    std::vector<std::vector<double>> const nodes = {
+        {0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.},
+        {3., 0., 0.}, {2., 1., 0.}, {2., 0., 1.}};
+    std::vector<DataTransferKit::LocalOrdinal> const faces = {
+        0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3, 4, 5,
+        6, 1, 4, 6, 3, 2, 3, 6, 5, 1, 2, 5, 4};
+    std::vector<unsigned> const nodes_per_face = {3, 3, 3, 3, 3, 4, 4, 4};
+    std::vector<DataTransferKit::LocalOrdinal> const cells = {0, 1, 2, 3, 3,
+                                                              4, 5, 6, 7};
+    std::vector<unsigned> const faces_per_cell = {4, 5};
+    polyhedra.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", nodes.size(), 3 );
+    auto coordinates_host = Kokkos::create_mirror_view( polyhedra.coordinates );
+    for ( unsigned int i = 0; i < nodes.size(); ++i )
+        for ( int d = 0; d < 3; ++d )
+            coordinates_host( i, d ) = nodes[i][d];
+    Kokkos::deep_copy( polyhedra.coordinates, coordinates_host );
+    polyhedra.faces =
+        toView<DataTransferKit::LocalOrdinal, DeviceType>( faces, "faces" );
+    polyhedra.nodes_per_face =
+        toView<unsigned, DeviceType>( nodes_per_face, "nodes_per_face" );
+    polyhedra.cells =
+        toView<DataTransferKit::LocalOrdinal, DeviceType>( cells, "cells" );
+    polyhedra.faces_per_cell =
+        toView<unsigned, DeviceType>( faces_per_cell, "faces_per_cell" );
+
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", 2 );
+    DataTransferKit::computeBoundingBoxes( polyhedra, boxes );
+    checkBoxes( boxes, {{0., 1., 0., 1., 0., 1.}, {0., 3., 0., 1., 0., 1.}},
+                out, success );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( BoundingBoxes, single_topology,      \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( BoundingBoxes, mixed_topology,       \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( BoundingBoxes, polyhedra,            \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
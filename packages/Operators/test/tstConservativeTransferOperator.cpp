@@ -0,0 +1,299 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include "DTK_TestMeshHelpers.hpp"
+#include <DTK_ConservativeTransferOperator.hpp>
+#include <DTK_DetailsReferenceCell.hpp>
+#include <DTK_DetailsTetrahedronIntersection.hpp>
+
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <vector>
+
+TEUCHOS_UNIT_TEST( DetailsTetrahedronIntersection, intersection_volume )
+{
+    using DataTransferKit::Point;
+    using DataTransferKit::Details::intersectionVolume;
+
+    Point const a[4] = {
+        {{0., 0., 0.}}, {{1., 0., 0.}}, {{0., 1., 0.}}, {{0., 0., 1.}}};
+    // same tetrahedron with the opposite orientation
+    Point const b[4] = {
+        {{1., 0., 0.}}, {{0., 0., 0.}}, {{0., 1., 0.}}, {{0., 0., 1.}}};
+    TEST_FLOATING_EQUALITY( intersectionVolume( a, a ), 1. / 6., 1e-14 );
+    TEST_FLOATING_EQUALITY( intersectionVolume( a, b ), 1. / 6., 1e-14 );
+    TEST_FLOATING_EQUALITY( intersectionVolume( b, a ), 1. / 6., 1e-14 );
+
+    // a scaled by one half is inside of it
+    Point const c[4] = {
+        {{0., 0., 0.}}, {{.5, 0., 0.}}, {{0., .5, 0.}}, {{0., 0., .5}}};
+    TEST_FLOATING_EQUALITY( intersectionVolume( a, c ), 1. / 48., 1e-14 );
+    TEST_FLOATING_EQUALITY( intersectionVolume( c, a ), 1. / 48., 1e-14 );
+
+    // sharing a face or disjoint
+    Point const d[4] = {
+        {{1., 0., 0.}}, {{0., 1., 0.}}, {{0., 0., 1.}}, {{1., 1., 1.}}};
+    Point const e[4] = {
+        {{2., 0., 0.}}, {{3., 0., 0.}}, {{2., 1., 0.}}, {{2., 0., 1.}}};
+    TEST_COMPARE( std::abs( intersectionVolume( a, d ) ), <, 1e-15 );
+    TEST_EQUALITY( intersectionVolume( a, e ), 0. );
+
+    // The six tetrahedra of the unit cube against those of the cube shifted
+    // by (1/2, 1/2, 1/2) overlap by the cube of side 1/2, most pairs
+    // intersect along general polyhedra.
+    int const tets[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+                            {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+    Point const hex[8] = {{{0., 0., 0.}}, {{1., 0., 0.}}, {{1., 1., 0.}},
+                          {{0., 1., 0.}}, {{0., 0., 1.}}, {{1., 0., 1.}},
+                          {{1., 1., 1.}}, {{0., 1., 1.}}};
+    double volume = 0.;
+    for ( int s = 0; s < 6; ++s )
+        for ( int t = 0; t < 6; ++t )
+        {
+            Point f[4];
+            Point g[4];
+            for ( int k = 0; k < 4; ++k )
+                for ( int d = 0; d < 3; ++d )
+                {
+                    f[k][d] = hex[tets[s][k]][d];
+                    g[k][d] = hex[tets[t][k]][d] + .5;
+                }
+            volume += intersectionVolume( f, g );
+        }
+    TEST_FLOATING_EQUALITY( volume, 1. / 8., 1e-14 );
+}
+
+// Every sub-tetrahedron of every cell has a positive volume, i.e. the nodes
+// are ordered as in the reference cell, and the cells have the given volume.
+// The transfer itself does not depend on the orientation of the cells.
+template <typename DeviceType>
+void checkCellVolumes(
+    DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType> const &mesh,
+    double volume, Teuchos::FancyOStream &out, bool &success )
+{
+    namespace details = DataTransferKit::Details;
+    details::CellTopology topology;
+    TEST_ASSERT( details::cellTopologyFromNodesPerCell( mesh.cells.extent( 1 ),
+                                                        topology ) );
+    auto coordinates_host = Kokkos::create_mirror_view( mesh.coordinates );
+    auto cells_host = Kokkos::create_mirror_view( mesh.cells );
+    Kokkos::deep_copy( coordinates_host, mesh.coordinates );
+    Kokkos::deep_copy( cells_host, mesh.cells );
+    int const n_cells = mesh.cells.extent( 0 );
+    int const n_tetrahedra = details::numberOfSubTetrahedra( topology );
+    for ( int c = 0; c < n_cells; ++c )
+    {
+        double cell_volume = 0.;
+        for ( int t = 0; t < n_tetrahedra; ++t )
+        {
+            DataTransferKit::Point v[4];
+            for ( int k = 0; k < 4; ++k )
+                for ( int d = 0; d < 3; ++d )
+                    v[k][d] = coordinates_host(
+                        cells_host( c, details::subTetrahedronNode( topology,
+                                                                    t, k ) ),
+                        d );
+            double const tetrahedron_volume =
+                details::signedTetrahedronVolume( v[0], v[1], v[2], v[3] );
+            TEST_COMPARE( tetrahedron_volume, >, 0. );
+            cell_volume += tetrahedron_volume;
+        }
+        TEST_FLOATING_EQUALITY( cell_volume, volume, 1e-12 );
+    }
+}
+
+// Transfer from the slab of m^3 unit cubes of each process to the same slab,
+// meshed with cubes of side 2/3 and another topology, on the previous
+// process. The first component is a field that varies from cell to cell and
+// the second one is constant.
+template <typename DeviceType>
+void checkConservation( Teuchos::RCP<const Teuchos::Comm<int>> comm,
+                        int source_nodes_per_cell, int target_nodes_per_cell,
+                        Teuchos::FancyOStream &out, bool &success )
+{
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+    int const next_rank = ( comm_rank + 1 ) % comm_size;
+    int const m = 2;
+    int const p = 3;
+    double const h = 2. / 3.;
+    auto cells_per_cube = []( int nodes_per_cell ) {
+        return ( nodes_per_cell == 8 ) ? 1 : ( nodes_per_cell == 6 ) ? 2 : 6;
+    };
+    auto f = []( double x, double y, double z ) {
+        return 10. + x - 2. * y * y + 0.5 * x * z;
+    };
+
+    auto source = buildStructuredMesh<DeviceType>( source_nodes_per_cell, m,
+                                                   1., comm_rank * m );
+    auto target = buildStructuredMesh<DeviceType>( target_nodes_per_cell, p,
+                                                   h, next_rank * m );
+    int const n_source_cells = source.cells.extent( 0 );
+    int const n_target_cells = target.cells.extent( 0 );
+    double const source_volume = 1. / cells_per_cube( source_nodes_per_cell );
+    double const target_volume =
+        h * h * h / cells_per_cube( target_nodes_per_cell );
+    checkCellVolumes( source, source_volume, out, success );
+    checkCellVolumes( target, target_volume, out, success );
+
+    // the source value of a cell is f at its centroid
+    Kokkos::View<double **, DeviceType> source_values( "source_values",
+                                                       n_source_cells, 2 );
+    auto source_values_host = Kokkos::create_mirror_view( source_values );
+    auto coordinates_host = Kokkos::create_mirror_view( source.coordinates );
+    auto cells_host = Kokkos::create_mirror_view( source.cells );
+    Kokkos::deep_copy( coordinates_host, source.coordinates );
+    Kokkos::deep_copy( cells_host, source.cells );
+    double source_integral = 0.;
+    for ( int c = 0; c < n_source_cells; ++c )
+    {
+        double x[3] = {0., 0., 0.};
+        for ( int k = 0; k < source_nodes_per_cell; ++k )
+            for ( int d = 0; d < 3; ++d )
+                x[d] += coordinates_host( cells_host( c, k ), d ) /
+                        source_nodes_per_cell;
+        source_values_host( c, 0 ) = f( x[0], x[1], x[2] );
+        source_values_host( c, 1 ) = 1.;
+        source_integral += source_volume * source_values_host( c, 0 );
+    }
+    Kokkos::deep_copy( source_values, source_values_host );
+
+    DataTransferKit::ConservativeTransferOperator<DeviceType> transfer( comm );
+    transfer.setup( source, target );
+    TEST_EQUALITY( transfer.getNumRows(), n_target_cells );
+    TEST_COMPARE( transfer.getNumEntries(), >=, n_target_cells );
+
+    Kokkos::View<double **, DeviceType> target_values( "target_values",
+                                                       n_target_cells, 2 );
+    transfer.apply( source_values, target_values );
+
+    auto target_values_host = Kokkos::create_mirror_view( target_values );
+    Kokkos::deep_copy( target_values_host, target_values );
+    auto covered_fraction = transfer.getCoveredFraction();
+    auto covered_fraction_host = Kokkos::create_mirror_view( covered_fraction );
+    Kokkos::deep_copy( covered_fraction_host, covered_fraction );
+    double target_integral = 0.;
+    for ( int c = 0; c < n_target_cells; ++c )
+    {
+        TEST_FLOATING_EQUALITY( covered_fraction_host( c ), 1., 1e-12 );
+        TEST_FLOATING_EQUALITY( target_values_host( c, 1 ), 1., 1e-12 );
+        target_integral += target_volume * target_values_host( c, 0 );
+    }
+
+    double global_source_integral = 0.;
+    double global_target_integral = 0.;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_SUM, source_integral,
+                        Teuchos::ptr( &global_source_integral ) );
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_SUM, target_integral,
+                        Teuchos::ptr( &global_target_integral ) );
+    TEST_FLOATING_EQUALITY( global_target_integral, global_source_integral,
+                            1e-12 );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConservativeTransferOperator,
+                                   hexahedra_to_tetrahedra, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    checkConservation<DeviceType>( comm, 8, 4, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConservativeTransferOperator,
+                                   tetrahedra_to_hexahedra, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    checkConservation<DeviceType>( comm, 4, 8, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConservativeTransferOperator,
+                                   wedges_to_pyramids, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    checkConservation<DeviceType>( comm, 6, 5, out, success );
+}
+
+// A target hexahedron that sticks out of the source mesh only gets the
+// contribution of the part that is covered.
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConservativeTransferOperator,
+                                   partial_overlap, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+    int const next_rank = ( comm_rank + 1 ) % comm_size;
+    int const m = 2;
+
+    auto source = buildStructuredMesh<DeviceType>( 8, m, 1., comm_rank * m );
+    auto target =
+        buildStructuredMesh<DeviceType>( 8, 1, 1., next_rank * m + .5 );
+    auto target_coordinates_host =
+        Kokkos::create_mirror_view( target.coordinates );
+    Kokkos::deep_copy( target_coordinates_host, target.coordinates );
+    for ( unsigned int i = 0; i < target.coordinates.extent( 0 ); ++i )
+        target_coordinates_host( i, 0 ) += 1.5;
+    Kokkos::deep_copy( target.coordinates, target_coordinates_host );
+
+    // source cell (a, b, c) gets 1 + a + 2 b + 4 c
+    int const n_source_cells = m * m * m;
+    Kokkos::View<double **, DeviceType> source_values( "source_values",
+                                                       n_source_cells, 1 );
+    auto source_values_host = Kokkos::create_mirror_view( source_values );
+    for ( int c = 0; c < n_source_cells; ++c )
+        source_values_host( c, 0 ) = 1. + c;
+    Kokkos::deep_copy( source_values, source_values_host );
+
+    DataTransferKit::ConservativeTransferOperator<DeviceType> transfer( comm );
+    transfer.setup( source, target );
+    TEST_EQUALITY( transfer.getNumRows(), 1 );
+    TEST_EQUALITY( transfer.getNumEntries(), 2 );
+
+    Kokkos::View<double **, DeviceType> target_values( "target_values", 1,
+                                                       1 );
+    transfer.apply( source_values, target_values );
+    auto target_values_host = Kokkos::create_mirror_view( target_values );
+    Kokkos::deep_copy( target_values_host, target_values );
+    auto covered_fraction = transfer.getCoveredFraction();
+    auto covered_fraction_host = Kokkos::create_mirror_view( covered_fraction );
+    Kokkos::deep_copy( covered_fraction_host, covered_fraction );
+
+    // [1.5, 2.5] x [0, 1] x [.5, 1.5] covers a quarter of the source cells
+    // (1, 0, 0) and (1, 0, 1)
+    TEST_FLOATING_EQUALITY( covered_fraction_host( 0 ), .5, 1e-12 );
+    TEST_FLOATING_EQUALITY( target_values_host( 0, 0 ), .25 * ( 2. + 6. ),
+                            1e-12 );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConservativeTransferOperator,        \
+                                          hexahedra_to_tetrahedra,             \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConservativeTransferOperator,        \
+                                          tetrahedra_to_hexahedra,             \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConservativeTransferOperator,        \
+                                          wedges_to_pyramids,                  \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConservativeTransferOperator,        \
+                                          partial_overlap, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -0,0 +1,157 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include "DTK_TestMeshHelpers.hpp"
+#include <DTK_ConsistentInterpolationOperator.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <vector>
+
+// Interpolate a linear field from a structured mesh of unit cubes, split into
+// slabs of m^3 cubes stacked along the z-axis, either as hexahedra or cut
+// into six tetrahedra or two wedges each. The targets of each process lie in
+// the slab of the next process, except for one outside of the mesh.
+template <typename DeviceType>
+void checkInterpolation( Teuchos::RCP<const Teuchos::Comm<int>> comm,
+                         int nodes_per_cell, Teuchos::FancyOStream &out,
+                         bool &success )
+{
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+    int const m = 2;
+    auto f = []( double x, double y, double z ) {
+        return 10. + x - 2. * y + 0.5 * z;
+    };
+
+    auto const source = buildStructuredMesh<DeviceType>( nodes_per_cell, m,
+                                                         1., comm_rank * m );
+    int const n_nodes = source.coordinates.extent( 0 );
+    int const n_cells = source.cells.extent( 0 );
+
+    // the degrees of freedom are the nodes of the mesh
+    DataTransferKit::DOFMap<Kokkos::LayoutLeft, DeviceType> dof_map;
+    dof_map.object_dof_ids =
+        Kokkos::DynRankView<DataTransferKit::LocalOrdinal, Kokkos::LayoutLeft,
+                            DeviceType>( "object_dof_ids", n_cells,
+                                         nodes_per_cell );
+    Kokkos::deep_copy( dof_map.object_dof_ids, source.cells );
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        source_field;
+    source_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "source_dofs", n_nodes, 2 );
+    auto coordinates_host = Kokkos::create_mirror_view( source.coordinates );
+    Kokkos::deep_copy( coordinates_host, source.coordinates );
+    auto source_dofs_host = Kokkos::create_mirror_view( source_field.dofs );
+    for ( int i = 0; i < n_nodes; ++i )
+    {
+        source_dofs_host( i, 0 ) =
+            f( coordinates_host( i, 0 ), coordinates_host( i, 1 ),
+               coordinates_host( i, 2 ) );
+        source_dofs_host( i, 1 ) = -1.;
+    }
+    Kokkos::deep_copy( source_field.dofs, source_dofs_host );
+
+    int const next_rank = ( comm_rank + 1 ) % comm_size;
+    int const n_targets = 6;
+    DataTransferKit::EvaluationSet<Kokkos::LayoutLeft, DeviceType> target;
+    target.evaluation_points =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "evaluation_points", n_targets, 3 );
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        target_field;
+    target_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "target_dofs", n_targets, 2 );
+    auto evaluation_points_host =
+        Kokkos::create_mirror_view( target.evaluation_points );
+    std::vector<double> expected( n_targets );
+    for ( int i = 0; i < n_targets; ++i )
+    {
+        // the fifth point is a node of the mesh and the last one is outside
+        double const x = ( i < 4 ) ? 0.3 + 0.5 * i : ( i == 4 ) ? 1. : -0.5;
+        double const y = ( i < 4 ) ? 1.7 - 0.3 * i : 1.;
+        double const z =
+            next_rank * m + ( ( i < 4 ) ? 0.2 + 0.35 * i : 1. );
+        evaluation_points_host( i, 0 ) = x;
+        evaluation_points_host( i, 1 ) = y;
+        evaluation_points_host( i, 2 ) = z;
+        expected[i] = f( x, y, z );
+    }
+    Kokkos::deep_copy( target.evaluation_points, evaluation_points_host );
+
+    DataTransferKit::ConsistentInterpolationOperator<DeviceType> interpolation(
+        comm );
+    interpolation.setup( source, dof_map, target );
+    TEST_EQUALITY( interpolation.getNumRows(), n_targets );
+    TEST_EQUALITY( interpolation.getNumEntries(),
+                   ( n_targets - 1 ) * nodes_per_cell );
+
+    auto found = interpolation.getFound();
+    auto found_host = Kokkos::create_mirror_view( found );
+    Kokkos::deep_copy( found_host, found );
+    for ( int i = 0; i < n_targets; ++i )
+        TEST_EQUALITY( found_host( i ), i < n_targets - 1 );
+
+    interpolation.apply( source_field, target_field );
+
+    auto target_dofs_host = Kokkos::create_mirror_view( target_field.dofs );
+    Kokkos::deep_copy( target_dofs_host, target_field.dofs );
+    for ( int i = 0; i < n_targets - 1; ++i )
+    {
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 0 ), expected[i],
+                                1e-12 );
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 1 ), -1., 1e-12 );
+    }
+    TEST_EQUALITY( target_dofs_host( n_targets - 1, 0 ), 0. );
+    TEST_EQUALITY( target_dofs_host( n_targets - 1, 1 ), 0. );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConsistentInterpolationOperator,
+                                   hexahedra, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    checkInterpolation<DeviceType>( comm, 8, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConsistentInterpolationOperator,
+                                   tetrahedra, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    checkInterpolation<DeviceType>( comm, 4, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( ConsistentInterpolationOperator, wedges,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    checkInterpolation<DeviceType>( comm, 6, out, success );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConsistentInterpolationOperator,     \
+                                          hexahedra, DeviceType##NODE )        \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConsistentInterpolationOperator,     \
+                                          tetrahedra, DeviceType##NODE )       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( ConsistentInterpolationOperator,     \
+                                          wedges, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
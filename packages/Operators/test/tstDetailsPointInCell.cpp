@@ -0,0 +1,194 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#include "DTK_ConfigDefs.hpp"
+#include <DTK_CellList.hpp>
+#include <DTK_DetailsPointInCell.hpp>
+
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <vector>
+
+namespace dtk = DataTransferKit::Details;
+
+// Map the given reference points to the physical space through a cell whose
+// nodes are the image of the reference nodes by an affine map, the second
+// node being moved off so that the map is not affine for hexahedra, and check
+// that they are found back by the batched kernel.
+template <dtk::CellTopology topology, typename DeviceType>
+void checkPointInCell( std::vector<std::vector<double>> const &reference_nodes,
+                       std::vector<std::vector<double>> const &xi_ref,
+                       std::vector<bool> const &inside_ref,
+                       Teuchos::FancyOStream &out, bool &success )
+{
+    using Cell = dtk::ReferenceCell<topology>;
+    int const n_nodes = Cell::n_nodes;
+    int const n_points = xi_ref.size();
+    double const a[3][3] = {{2., 0.3, 0.}, {0.1, 1.5, 0.2}, {0., 0.4, 1.}};
+    double const b[3] = {1., -2., 3.};
+
+    // a single cell whose nodes are numbered backward
+    DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType> cell_list;
+    cell_list.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n_nodes, 3 );
+    cell_list.cells =
+        Kokkos::DynRankView<DataTransferKit::LocalOrdinal, Kokkos::LayoutLeft,
+                            DeviceType>( "cells", 1, n_nodes );
+    auto coordinates_host =
+        Kokkos::create_mirror_view( cell_list.coordinates );
+    auto cells_host = Kokkos::create_mirror_view( cell_list.cells );
+    double nodes[Cell::n_nodes][3];
+    for ( int k = 0; k < n_nodes; ++k )
+    {
+        for ( int d = 0; d < 3; ++d )
+        {
+            nodes[k][d] = b[d] + ( k == 1 ? 0.1 : 0. );
+            for ( int e = 0; e < 3; ++e )
+                nodes[k][d] += a[d][e] * reference_nodes[k][e];
+            coordinates_host( n_nodes - 1 - k, d ) = nodes[k][d];
+        }
+        cells_host( 0, k ) = n_nodes - 1 - k;
+    }
+    Kokkos::deep_copy( cell_list.coordinates, coordinates_host );
+    Kokkos::deep_copy( cell_list.cells, cells_host );
+
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> points(
+        "points", n_points, 3 );
+    Kokkos::View<int *, DeviceType> query_ids( "query_ids", n_points );
+    Kokkos::View<int *, DeviceType> cell_ids( "cell_ids", n_points );
+    auto points_host = Kokkos::create_mirror_view( points );
+    auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+    auto cell_ids_host = Kokkos::create_mirror_view( cell_ids );
+    for ( int i = 0; i < n_points; ++i )
+    {
+        DataTransferKit::Point const xi = {
+            {xi_ref[i][0], xi_ref[i][1], xi_ref[i][2]}};
+        double values[Cell::n_nodes];
+        Cell::values( xi, values );
+        for ( int d = 0; d < 3; ++d )
+        {
+            points_host( i, d ) = 0.;
+            for ( int k = 0; k < n_nodes; ++k )
+                points_host( i, d ) += values[k] * nodes[k][d];
+        }
+        // pairs in reverse order of the points
+        query_ids_host( n_points - 1 - i ) = i;
+        cell_ids_host( i ) = 0;
+    }
+    Kokkos::deep_copy( points, points_host );
+    Kokkos::deep_copy( query_ids, query_ids_host );
+    Kokkos::deep_copy( cell_ids, cell_ids_host );
+
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> reference_points(
+        "reference_points", n_points, 3 );
+    Kokkos::View<bool *, DeviceType> inside( "inside", n_points );
+    dtk::PointInCell<DeviceType>::search(
+        topology, cell_list.coordinates, cell_list.cells, points, query_ids,
+        cell_ids, reference_points, inside );
+
+    auto reference_points_host = Kokkos::create_mirror_view( reference_points );
+    Kokkos::deep_copy( reference_points_host, reference_points );
+    auto inside_host = Kokkos::create_mirror_view( inside );
+    Kokkos::deep_copy( inside_host, inside );
+    for ( int j = 0; j < n_points; ++j )
+    {
+        int const i = n_points - 1 - j;
+        TEST_EQUALITY( inside_host( j ), inside_ref[i] );
+        for ( int d = 0; d < 3; ++d )
+            TEST_FLOATING_EQUALITY( reference_points_host( j, d ) + 10.,
+                                    xi_ref[i][d] + 10., 1e-12 );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsPointInCell, tetrahedron,
+                                   DeviceType )
+{
+    checkPointInCell<dtk::CellTopology::TET4, DeviceType>(
+        {{0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}},
+        {{0.25, 0.25, 0.25},
+         {0.1, 0.2, 0.6},
+         {0., 0., 1.},
+         {0.6, 0.6, 0.6},
+         {-0.1, 0.5, 0.2}},
+        {true, true, true, false, false}, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsPointInCell, hexahedron,
+                                   DeviceType )
+{
+    checkPointInCell<dtk::CellTopology::HEX8, DeviceType>(
+        {{-1., -1., -1.},
+         {1., -1., -1.},
+         {1., 1., -1.},
+         {-1., 1., -1.},
+         {-1., -1., 1.},
+         {1., -1., 1.},
+         {1., 1., 1.},
+         {-1., 1., 1.}},
+        {{0., 0., 0.},
+         {0.7, -0.3, 0.9},
+         {1., -1., 1.},
+         {1.2, 0., 0.},
+         {0.5, 0.5, -1.3}},
+        {true, true, true, false, false}, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsPointInCell, wedge, DeviceType )
+{
+    checkPointInCell<dtk::CellTopology::WEDGE6, DeviceType>(
+        {{0., 0., -1.},
+         {1., 0., -1.},
+         {0., 1., -1.},
+         {0., 0., 1.},
+         {1., 0., 1.},
+         {0., 1., 1.}},
+        {{0.3, 0.3, 0.},
+         {0.5, 0.1, -0.8},
+         {0., 1., 1.},
+         {0.7, 0.7, 0.},
+         {0.2, 0.2, 1.5}},
+        {true, true, true, false, false}, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsPointInCell, pyramid, DeviceType )
+{
+    checkPointInCell<dtk::CellTopology::PYRAMID5, DeviceType>(
+        {{-1., -1., 0.},
+         {1., -1., 0.},
+         {1., 1., 0.},
+         {-1., 1., 0.},
+         {0., 0., 1.}},
+        {{0., 0., 0.25},
+         {0.4, -0.3, 0.5},
+         {-1., 1., 0.},
+         {0.8, 0., 0.5},
+         {0., 0.2, -0.1}},
+        {true, true, true, false, false}, out, success );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsPointInCell, tetrahedron,     \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsPointInCell, hexahedron,      \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsPointInCell, wedge,           \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsPointInCell, pyramid,         \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -0,0 +1,135 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#include "DTK_ConfigDefs.hpp"
+#include "DTK_TestMeshHelpers.hpp"
+#include <DTK_DetailsPointInPolyhedron.hpp>
+#include <DTK_PolyhedronList.hpp>
+
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <vector>
+
+namespace dtk = DataTransferKit::Details;
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsPointInPolyhedron, cube_and_l_prism,
+                                   DeviceType )
+{
+    // The first cell is the unit cube, with the faces at z = 0 and x = 0
+    // listed with an inward normal. The second one is the extrusion along the
+    // z-axis of the L-shaped polygon (2, 0), (4, 0), (4, 1), (3, 1), (3, 3),
+    // (2, 3), which is not convex.
+    std::vector<std::vector<double>> nodes = {
+        {0., 0., 0.}, {1., 0., 0.}, {1., 1., 0.}, {0., 1., 0.},
+        {0., 0., 1.}, {1., 0., 1.}, {1., 1., 1.}, {0., 1., 1.}};
+    std::vector<std::vector<double>> const l_shape = {
+        {2., 0.}, {4., 0.}, {4., 1.}, {3., 1.}, {3., 3.}, {2., 3.}};
+    for ( double z : {0., 1.} )
+        for ( auto const &xy : l_shape )
+            nodes.push_back( {xy[0], xy[1], z} );
+
+    std::vector<DataTransferKit::LocalOrdinal> faces = {
+        0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 7, 4, 0, 3};
+    std::vector<unsigned> nodes_per_face( 6, 4 );
+    std::vector<DataTransferKit::LocalOrdinal> cells = {0, 1, 2, 3, 4, 5};
+    std::vector<int> face_orientation = {-1, 1, 1, 1, 1, -1};
+    std::vector<unsigned> faces_per_cell = {6};
+    for ( int level : {0, 1} )
+    {
+        cells.push_back( nodes_per_face.size() );
+        face_orientation.push_back( level == 0 ? -1 : 1 );
+        for ( int k = 0; k < 6; ++k )
+            faces.push_back( 8 + 6 * level + k );
+        nodes_per_face.push_back( 6 );
+    }
+    for ( int k = 0; k < 6; ++k )
+    {
+        cells.push_back( nodes_per_face.size() );
+        face_orientation.push_back( 1 );
+        for ( int n : {8 + k, 8 + ( k + 1 ) % 6, 14 + ( k + 1 ) % 6, 14 + k} )
+            faces.push_back( n );
+        nodes_per_face.push_back( 4 );
+    }
+    faces_per_cell.push_back( 8 );
+
+    DataTransferKit::PolyhedronList<Kokkos::LayoutLeft, DeviceType> polyhedra;
+    polyhedra.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", nodes.size(), 3 );
+    auto coordinates_host = Kokkos::create_mirror_view( polyhedra.coordinates );
+    for ( unsigned int i = 0; i < nodes.size(); ++i )
+        for ( int d = 0; d < 3; ++d )
+            coordinates_host( i, d ) = nodes[i][d];
+    Kokkos::deep_copy( polyhedra.coordinates, coordinates_host );
+    polyhedra.faces = toView<DataTransferKit::LocalOrdinal, DeviceType>(
+        faces, "faces" );
+    polyhedra.nodes_per_face =
+        toView<unsigned, DeviceType>( nodes_per_face, "nodes_per_face" );
+    polyhedra.cells = toView<DataTransferKit::LocalOrdinal, DeviceType>(
+        cells, "cells" );
+    polyhedra.faces_per_cell =
+        toView<unsigned, DeviceType>( faces_per_cell, "faces_per_cell" );
+    polyhedra.face_orientation =
+        toView<int, DeviceType>( face_orientation, "face_orientation" );
+
+    // pairs of a point and a cell with the expected answer
+    std::vector<std::vector<double>> const points_ref = {
+        {0.5, 0.5, 0.5}, {1.5, 0.5, 0.5}, {0.5, 0.3, 1.}, {1., 1., 1.},
+        {3.5, 2., 0.5},  {2.5, 2.5, 0.5}, {3.5, 0.5, 0.2}, {3., 1., 0.5},
+        {0.5, 0.5, 0.5}, {2.5, 0.5, 1.1}};
+    std::vector<int> const cell_ids_ref = {0, 0, 0, 0, 1, 1, 1, 1, 1, 1};
+    std::vector<bool> const inside_ref = {true, false, true,  true,  false,
+                                          true, true,  true,  false, false};
+    int const n_pairs = points_ref.size();
+    Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType> points(
+        "points", n_pairs, 3 );
+    auto points_host = Kokkos::create_mirror_view( points );
+    std::vector<int> query_ids_ref( n_pairs );
+    for ( int j = 0; j < n_pairs; ++j )
+    {
+        for ( int d = 0; d < 3; ++d )
+            points_host( j, d ) = points_ref[j][d];
+        query_ids_ref[j] = j;
+    }
+    Kokkos::deep_copy( points, points_host );
+    Kokkos::View<int *, DeviceType> query_ids( "query_ids", n_pairs );
+    Kokkos::View<int *, DeviceType> cell_ids( "cell_ids", n_pairs );
+    auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+    auto cell_ids_host = Kokkos::create_mirror_view( cell_ids );
+    for ( int j = 0; j < n_pairs; ++j )
+    {
+        query_ids_host( j ) = query_ids_ref[j];
+        cell_ids_host( j ) = cell_ids_ref[j];
+    }
+    Kokkos::deep_copy( query_ids, query_ids_host );
+    Kokkos::deep_copy( cell_ids, cell_ids_host );
+
+    Kokkos::View<bool *, DeviceType> inside( "inside", n_pairs );
+    dtk::PointInPolyhedron<DeviceType>::search( polyhedra, points, query_ids,
+                                                cell_ids, inside );
+
+    auto inside_host = Kokkos::create_mirror_view( inside );
+    Kokkos::deep_copy( inside_host, inside );
+    for ( int j = 0; j < n_pairs; ++j )
+        TEST_EQUALITY( inside_host( j ), inside_ref[j] );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsPointInPolyhedron,            \
+                                          cube_and_l_prism, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
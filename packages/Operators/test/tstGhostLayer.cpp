@@ -0,0 +1,150 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_GhostLayer.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( GhostLayer, strip, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Each process owns a strip of n unit quadrilaterals [x, x+1]x[0, 1]
+    // with x = comm_rank * n + i. The first cell of the list is a ghost copy
+    // of the cell that follows the strip and must be ignored.
+    int const n = 4;
+    int const n_nodes = 2 * n + 4;
+    DataTransferKit::CellList<Kokkos::LayoutLeft, DeviceType> cell_list;
+    cell_list.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n_nodes, 2 );
+    cell_list.cells =
+        Kokkos::DynRankView<DataTransferKit::LocalOrdinal, Kokkos::LayoutLeft,
+                            DeviceType>( "cells", n + 1, 4 );
+    cell_list.is_ghost_cell =
+        Kokkos::View<bool *, Kokkos::LayoutLeft, DeviceType>( "is_ghost_cell",
+                                                              n + 1 );
+    auto coordinates_host = Kokkos::create_mirror_view( cell_list.coordinates );
+    auto cells_host = Kokkos::create_mirror_view( cell_list.cells );
+    auto is_ghost_cell_host =
+        Kokkos::create_mirror_view( cell_list.is_ghost_cell );
+    for ( int k = 0; k < n + 2; ++k )
+    {
+        int const bottom = ( k <= n ) ? k : 2 * n + 2;
+        int const top = ( k <= n ) ? n + 1 + k : 2 * n + 3;
+        coordinates_host( bottom, 0 ) = comm_rank * n + k;
+        coordinates_host( bottom, 1 ) = 0.;
+        coordinates_host( top, 0 ) = comm_rank * n + k;
+        coordinates_host( top, 1 ) = 1.;
+    }
+    cells_host( 0, 0 ) = n;
+    cells_host( 0, 1 ) = 2 * n + 2;
+    cells_host( 0, 2 ) = 2 * n + 3;
+    cells_host( 0, 3 ) = 2 * n + 1;
+    is_ghost_cell_host( 0 ) = true;
+    for ( int i = 0; i < n; ++i )
+    {
+        cells_host( i + 1, 0 ) = i;
+        cells_host( i + 1, 1 ) = i + 1;
+        cells_host( i + 1, 2 ) = n + 2 + i;
+        cells_host( i + 1, 3 ) = n + 1 + i;
+        is_ghost_cell_host( i + 1 ) = false;
+    }
+    Kokkos::deep_copy( cell_list.coordinates, coordinates_host );
+    Kokkos::deep_copy( cell_list.cells, cells_host );
+    Kokkos::deep_copy( cell_list.is_ghost_cell, is_ghost_cell_host );
+
+    // the layer is made of the two closest cells of each neighbor
+    DataTransferKit::GhostLayer<DeviceType> ghost_layer( comm, cell_list,
+                                                         1.5 );
+    std::vector<int> ref_ranks;
+    std::vector<int> ref_indices;
+    if ( comm_rank > 0 )
+    {
+        ref_ranks.insert( ref_ranks.end(), {comm_rank - 1, comm_rank - 1} );
+        ref_indices.insert( ref_indices.end(), {n - 1, n} );
+    }
+    if ( comm_rank < comm_size - 1 )
+    {
+        ref_ranks.insert( ref_ranks.end(), {comm_rank + 1, comm_rank + 1} );
+        ref_indices.insert( ref_indices.end(), {1, 2} );
+    }
+    int const n_ghosts = ref_ranks.size();
+    TEST_EQUALITY( ghost_layer.getNumGhostCells(), n_ghosts );
+
+    auto owner_ranks = ghost_layer.getOwnerRanks();
+    auto owner_ranks_host = Kokkos::create_mirror_view( owner_ranks );
+    Kokkos::deep_copy( owner_ranks_host, owner_ranks );
+    auto owner_indices = ghost_layer.getOwnerIndices();
+    auto owner_indices_host = Kokkos::create_mirror_view( owner_indices );
+    Kokkos::deep_copy( owner_indices_host, owner_indices );
+    TEST_COMPARE_ARRAYS( std::vector<int>( owner_ranks_host.data(),
+                                           owner_ranks_host.data() +
+                                               n_ghosts ),
+                         ref_ranks );
+    TEST_COMPARE_ARRAYS( std::vector<int>( owner_indices_host.data(),
+                                           owner_indices_host.data() +
+                                               n_ghosts ),
+                         ref_indices );
+
+    auto ghosted_list = ghost_layer.appendGhostCells( cell_list );
+    TEST_EQUALITY( ghosted_list.coordinates.extent( 0 ),
+                   n_nodes + 4 * n_ghosts );
+    TEST_EQUALITY( ghosted_list.cells.extent( 0 ), n + 1 + n_ghosts );
+    auto ghosted_coordinates_host =
+        Kokkos::create_mirror_view( ghosted_list.coordinates );
+    Kokkos::deep_copy( ghosted_coordinates_host, ghosted_list.coordinates );
+    auto ghosted_cells_host = Kokkos::create_mirror_view( ghosted_list.cells );
+    Kokkos::deep_copy( ghosted_cells_host, ghosted_list.cells );
+    auto ghosted_is_ghost_cell_host =
+        Kokkos::create_mirror_view( ghosted_list.is_ghost_cell );
+    Kokkos::deep_copy( ghosted_is_ghost_cell_host,
+                       ghosted_list.is_ghost_cell );
+    for ( int c = 0; c < n + 1; ++c )
+    {
+        TEST_EQUALITY( ghosted_is_ghost_cell_host( c ),
+                       is_ghost_cell_host( c ) );
+        for ( int k = 0; k < 4; ++k )
+            TEST_EQUALITY( ghosted_cells_host( c, k ), cells_host( c, k ) );
+    }
+    for ( int g = 0; g < n_ghosts; ++g )
+    {
+        int const c = n + 1 + g;
+        TEST_ASSERT( ghosted_is_ghost_cell_host( c ) );
+        // the owned cell with index i starts at x = rank * n + i - 1
+        double const x = ref_ranks[g] * n + ref_indices[g] - 1;
+        double const ref_x[4] = {x, x + 1., x + 1., x};
+        double const ref_y[4] = {0., 0., 1., 1.};
+        for ( int k = 0; k < 4; ++k )
+        {
+            int const node = ghosted_cells_host( c, k );
+            TEST_EQUALITY( node, n_nodes + 4 * g + k );
+            TEST_EQUALITY( ghosted_coordinates_host( node, 0 ), ref_x[k] );
+            TEST_EQUALITY( ghosted_coordinates_host( node, 1 ), ref_y[k] );
+        }
+    }
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( GhostLayer, strip, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
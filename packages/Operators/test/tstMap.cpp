@@ -0,0 +1,151 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_Map.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+namespace details = DataTransferKit::Details;
+
+// Each target point takes the average of the values of the source points
+// within a given radius.
+template <typename DeviceType>
+class AverageMap : public DataTransferKit::Map<DeviceType>
+{
+  public:
+    AverageMap( Teuchos::RCP<Teuchos::Comm<int> const> comm )
+        : DataTransferKit::Map<DeviceType>( comm )
+    {
+    }
+
+    void setup( Kokkos::View<DataTransferKit::Point *, DeviceType> source,
+                Kokkos::View<DataTransferKit::Point *, DeviceType> target,
+                double radius )
+    {
+        int const n_source = source.extent( 0 );
+        int const n_target = target.extent( 0 );
+        auto source_host = Kokkos::create_mirror_view( source );
+        Kokkos::deep_copy( source_host, source );
+        auto target_host = Kokkos::create_mirror_view( target );
+        Kokkos::deep_copy( target_host, target );
+
+        Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes",
+                                                                n_source );
+        auto boxes_host = Kokkos::create_mirror_view( boxes );
+        for ( int i = 0; i < n_source; ++i )
+            for ( int d = 0; d < 3; ++d )
+                boxes_host( i )[2 * d] = boxes_host( i )[2 * d + 1] =
+                    source_host( i )[d];
+        Kokkos::deep_copy( boxes, boxes_host );
+        DataTransferKit::DistributedSearchTree<DeviceType> tree( this->_comm,
+                                                                 boxes );
+
+        Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+            queries( "queries", n_target );
+        auto queries_host = Kokkos::create_mirror_view( queries );
+        for ( int i = 0; i < n_target; ++i )
+            queries_host( i ) = details::within( target_host( i ), radius );
+        Kokkos::deep_copy( queries, queries_host );
+
+        Kokkos::View<int *, DeviceType> indices( "indices" );
+        Kokkos::View<int *, DeviceType> offset( "offset" );
+        Kokkos::View<int *, DeviceType> ranks( "ranks" );
+        tree.query( queries, indices, offset, ranks );
+
+        auto offset_host = Kokkos::create_mirror_view( offset );
+        Kokkos::deep_copy( offset_host, offset );
+        Kokkos::View<double *, DeviceType> weights( "weights",
+                                                    indices.extent( 0 ) );
+        auto weights_host = Kokkos::create_mirror_view( weights );
+        for ( int i = 0; i < n_target; ++i )
+            for ( int j = offset_host( i ); j < offset_host( i + 1 ); ++j )
+                weights_host( j ) =
+                    1. / ( offset_host( i + 1 ) - offset_host( i ) );
+        Kokkos::deep_copy( weights, weights_host );
+
+        this->setOperator( offset, indices, ranks, weights );
+    }
+};
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Map, average, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // The source points are the integers x = comm_rank * n + i on the x-axis
+    // and the target points lie half way between two of them, the first one
+    // on the process that owns the next source points.
+    int const n = 5;
+    int const n_target = ( comm_rank < comm_size - 1 ) ? n : n - 1;
+    Kokkos::View<DataTransferKit::Point *, DeviceType> source( "source", n );
+    Kokkos::View<DataTransferKit::Point *, DeviceType> target( "target",
+                                                               n_target );
+    auto source_host = Kokkos::create_mirror_view( source );
+    auto target_host = Kokkos::create_mirror_view( target );
+    for ( int i = 0; i < n; ++i )
+        source_host( i ) = {{comm_rank * n + i + 0., 0., 0.}};
+    for ( int i = 0; i < n_target; ++i )
+        target_host( i ) = {{comm_rank * n + i + 0.5, 0., 0.}};
+    Kokkos::deep_copy( source, source_host );
+    Kokkos::deep_copy( target, target_host );
+
+    AverageMap<DeviceType> map( comm );
+    TEST_ASSERT( !map.isSetUp() );
+    map.setup( source, target, 0.6 );
+    TEST_ASSERT( map.isSetUp() );
+    TEST_EQUALITY( map.getNumRows(), n_target );
+    TEST_EQUALITY( map.getNumEntries(), 2 * n_target );
+
+    // the same operator is applied to several fields
+    for ( int k = 1; k < 3; ++k )
+    {
+        DataTransferKit::Field<double, DeviceType> source_field;
+        DataTransferKit::Field<double, DeviceType> target_field;
+        source_field.dofs =
+            Kokkos::View<double **, DeviceType>( "source_dofs", n, 2 );
+        target_field.dofs =
+            Kokkos::View<double **, DeviceType>( "target_dofs", n_target, 2 );
+        auto source_dofs_host = Kokkos::create_mirror_view( source_field.dofs );
+        for ( int i = 0; i < n; ++i )
+        {
+            source_dofs_host( i, 0 ) = k * source_host( i )[0];
+            source_dofs_host( i, 1 ) = -1.;
+        }
+        Kokkos::deep_copy( source_field.dofs, source_dofs_host );
+
+        map.apply( source_field, target_field );
+
+        auto target_dofs_host = Kokkos::create_mirror_view( target_field.dofs );
+        Kokkos::deep_copy( target_dofs_host, target_field.dofs );
+        for ( int i = 0; i < n_target; ++i )
+        {
+            TEST_FLOATING_EQUALITY( target_dofs_host( i, 0 ),
+                                    k * target_host( i )[0], 1e-14 );
+            TEST_FLOATING_EQUALITY( target_dofs_host( i, 1 ), -1., 1e-14 );
+        }
+    }
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Map, average, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
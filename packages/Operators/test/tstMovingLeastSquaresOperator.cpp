@@ -0,0 +1,155 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_MovingLeastSquaresOperator.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <functional>
+#include <vector>
+
+// Transfer f from the nodes of a structured grid with unit spacing, split
+// into slabs of n^3 nodes stacked along the z-axis (or n^2 nodes of the
+// plane z = 0 stacked along the y-axis if planar), to points between the
+// nodes. The targets of each process are close to the slab of the next
+// process.
+template <typename DeviceType>
+void checkReproduction( Teuchos::RCP<const Teuchos::Comm<int>> comm,
+                        int polynomial_degree, int n_neighbors, bool planar,
+                        std::function<double( double, double, double )> f,
+                        Teuchos::FancyOStream &out, bool &success )
+{
+    int const comm_rank = comm->getRank();
+    int const n = 4;
+    int const n_nodes = planar ? n * n : n * n * n;
+    int const space_dim = planar ? 2 : 3;
+    double const z_offset = planar ? 0. : comm_rank * n;
+    double const y_offset = planar ? comm_rank * n : 0.;
+
+    DataTransferKit::NodeList<Kokkos::LayoutLeft, DeviceType> source;
+    source.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n_nodes, space_dim );
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        source_field;
+    source_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "source_dofs", n_nodes, 1 );
+    auto coordinates_host = Kokkos::create_mirror_view( source.coordinates );
+    auto source_dofs_host = Kokkos::create_mirror_view( source_field.dofs );
+    for ( int i = 0; i < n_nodes; ++i )
+    {
+        double const x = i % n;
+        double const y = ( i / n ) % n + y_offset;
+        double const z = planar ? 0. : i / ( n * n ) + z_offset;
+        coordinates_host( i, 0 ) = x;
+        coordinates_host( i, 1 ) = y;
+        if ( !planar )
+            coordinates_host( i, 2 ) = z;
+        source_dofs_host( i, 0 ) = f( x, y, z );
+    }
+    Kokkos::deep_copy( source.coordinates, coordinates_host );
+    Kokkos::deep_copy( source_field.dofs, source_dofs_host );
+
+    int const n_targets = 5;
+    DataTransferKit::EvaluationSet<Kokkos::LayoutLeft, DeviceType> target;
+    target.evaluation_points =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "evaluation_points", n_targets, space_dim );
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        target_field;
+    target_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "target_dofs", n_targets, 1 );
+    auto evaluation_points_host =
+        Kokkos::create_mirror_view( target.evaluation_points );
+    std::vector<double> expected( n_targets );
+    for ( int i = 0; i < n_targets; ++i )
+    {
+        double const x = 0.6 + 0.45 * i;
+        double const y = planar ? ( comm_rank + 1 ) * n - 0.7 : 1.3 + 0.2 * i;
+        double const z = planar ? 0. : ( comm_rank + 1 ) * n - 1.4 - 0.1 * i;
+        evaluation_points_host( i, 0 ) = x;
+        evaluation_points_host( i, 1 ) = y;
+        if ( !planar )
+            evaluation_points_host( i, 2 ) = z;
+        expected[i] = f( x, y, z );
+    }
+    Kokkos::deep_copy( target.evaluation_points, evaluation_points_host );
+
+    DataTransferKit::MovingLeastSquaresOperator<DeviceType> mls(
+        comm, polynomial_degree, n_neighbors );
+    mls.setup( source, target );
+    TEST_EQUALITY( mls.getNumRows(), n_targets );
+    TEST_EQUALITY( mls.getNumEntries(), n_targets * n_neighbors );
+
+    mls.apply( source_field, target_field );
+
+    auto target_dofs_host = Kokkos::create_mirror_view( target_field.dofs );
+    Kokkos::deep_copy( target_dofs_host, target_field.dofs );
+    for ( int i = 0; i < n_targets; ++i )
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 0 ), expected[i],
+                                1e-10 );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MovingLeastSquaresOperator,
+                                   polynomial_reproduction, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+
+    auto constant = []( double, double, double ) { return 3.; };
+    auto linear = []( double x, double y, double z ) {
+        return 1. + 2. * x - y + 0.5 * z;
+    };
+    auto quadratic = []( double x, double y, double z ) {
+        return 1. + x * x - 2. * x * y + y * z + 0.5 * z * z + 3. * x;
+    };
+    checkReproduction<DeviceType>( comm, 0, 4, false, constant, out,
+                                   success );
+    checkReproduction<DeviceType>( comm, 1, 10, false, linear, out, success );
+    checkReproduction<DeviceType>( comm, 2, 27, false, quadratic, out,
+                                   success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MovingLeastSquaresOperator, planar,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+
+    // the terms of the basis that depend on z vanish at all the nodes and
+    // must be dropped from the systems
+    auto linear = []( double x, double y, double ) {
+        return 1. + 2. * x - y;
+    };
+    auto quadratic = []( double x, double y, double ) {
+        return 1. + x * x - 2. * x * y + 0.5 * y * y;
+    };
+    checkReproduction<DeviceType>( comm, 1, 6, true, linear, out, success );
+    checkReproduction<DeviceType>( comm, 2, 12, true, quadratic, out,
+                                   success );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MovingLeastSquaresOperator,          \
+                                          polynomial_reproduction,             \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MovingLeastSquaresOperator, planar,  \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
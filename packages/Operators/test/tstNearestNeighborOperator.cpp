@@ -0,0 +1,109 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_NearestNeighborOperator.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( NearestNeighborOperator, permutation,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Every process owns n source nodes along a line in the plane z = 0. The
+    // target points are slightly perturbed copies of the nodes of the next
+    // process, in reverse order, so that the operator is a permutation
+    // across the processes.
+    int const n = 7;
+    int const next_rank = ( comm_rank + 1 ) % comm_size;
+    DataTransferKit::NodeList<Kokkos::LayoutLeft, DeviceType> source;
+    source.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n, 2 );
+    DataTransferKit::EvaluationSet<Kokkos::LayoutLeft, DeviceType> target;
+    target.evaluation_points =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "evaluation_points", n, 2 );
+    auto coordinates_host = Kokkos::create_mirror_view( source.coordinates );
+    auto evaluation_points_host =
+        Kokkos::create_mirror_view( target.evaluation_points );
+    for ( int i = 0; i < n; ++i )
+    {
+        coordinates_host( i, 0 ) = comm_rank * n + i;
+        coordinates_host( i, 1 ) = i % 2;
+        evaluation_points_host( n - 1 - i, 0 ) = next_rank * n + i + 0.2;
+        evaluation_points_host( n - 1 - i, 1 ) = i % 2 - 0.1;
+    }
+    Kokkos::deep_copy( source.coordinates, coordinates_host );
+    Kokkos::deep_copy( target.evaluation_points, evaluation_points_host );
+
+    DataTransferKit::NearestNeighborOperator<DeviceType> nearest_neighbor(
+        comm );
+    TEST_ASSERT( !nearest_neighbor.isSetUp() );
+    nearest_neighbor.setup( source, target );
+    TEST_ASSERT( nearest_neighbor.isSetUp() );
+    TEST_EQUALITY( nearest_neighbor.getNumTargets(), n );
+
+    auto ranks = nearest_neighbor.getSourceRanks();
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    auto indices = nearest_neighbor.getSourceIndices();
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    for ( int i = 0; i < n; ++i )
+    {
+        TEST_EQUALITY( ranks_host( i ), next_rank );
+        TEST_EQUALITY( indices_host( i ), n - 1 - i );
+    }
+
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        source_field;
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        target_field;
+    source_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "source_dofs", n, 2 );
+    target_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "target_dofs", n, 2 );
+    auto source_dofs_host = Kokkos::create_mirror_view( source_field.dofs );
+    for ( int i = 0; i < n; ++i )
+    {
+        source_dofs_host( i, 0 ) = comm_rank * n + i;
+        source_dofs_host( i, 1 ) = comm_rank;
+    }
+    Kokkos::deep_copy( source_field.dofs, source_dofs_host );
+
+    nearest_neighbor.apply( source_field, target_field );
+
+    auto target_dofs_host = Kokkos::create_mirror_view( target_field.dofs );
+    Kokkos::deep_copy( target_dofs_host, target_field.dofs );
+    for ( int i = 0; i < n; ++i )
+    {
+        TEST_EQUALITY( target_dofs_host( i, 0 ), next_rank * n + n - 1 - i );
+        TEST_EQUALITY( target_dofs_host( i, 1 ), next_rank );
+    }
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( NearestNeighborOperator,             \
+                                          permutation, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -0,0 +1,205 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_PointRepartitioner.hpp>
+
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointRepartitioner, weights, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // All the points live on the first process. The first half of them are
+    // three times as expensive as the others.
+    int const n_total = 40 * comm_size;
+    int const n = ( comm_rank == 0 ) ? n_total : 0;
+    Kokkos::View<DataTransferKit::Point *, DeviceType> points( "points", n );
+    Kokkos::View<double *, DeviceType> weights( "weights", n );
+    auto points_host = Kokkos::create_mirror_view( points );
+    auto weights_host = Kokkos::create_mirror_view( weights );
+    for ( int i = 0; i < n; ++i )
+    {
+        points_host( i ) = {{static_cast<double>( i ), 0., 0.}};
+        weights_host( i ) = ( i < n_total / 2 ) ? 3. : 1.;
+    }
+    Kokkos::deep_copy( points, points_host );
+    Kokkos::deep_copy( weights, weights_host );
+
+    DataTransferKit::PointRepartitioner<DeviceType> repartitioner(
+        comm, points, weights );
+
+    int n_repartitioned = 0;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_SUM,
+                        static_cast<int>( repartitioner.size() ),
+                        Teuchos::ptr( &n_repartitioned ) );
+    TEST_EQUALITY( n_repartitioned, n_total );
+
+    // the work is balanced up to the weight of a couple of points
+    Kokkos::View<double *, DeviceType> repartitioned_weights(
+        "repartitioned_weights", repartitioner.size() );
+    repartitioner.doForward( weights, repartitioned_weights );
+    auto repartitioned_weights_host =
+        Kokkos::create_mirror_view( repartitioned_weights );
+    Kokkos::deep_copy( repartitioned_weights_host, repartitioned_weights );
+    double local_work = 0.;
+    for ( int i = 0; i < static_cast<int>( repartitioner.size() ); ++i )
+        local_work += repartitioned_weights_host( i );
+    double max_work = 0.;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_MAX, local_work,
+                        Teuchos::ptr( &max_work ) );
+    double const average_work = 2. * n_total / comm_size;
+    TEST_COMPARE( max_work, <=, average_work + 6. );
+
+    // the points and the inverse map agree
+    auto repartitioned_points = repartitioner.getPoints();
+    auto repartitioned_points_host =
+        Kokkos::create_mirror_view( repartitioned_points );
+    Kokkos::deep_copy( repartitioned_points_host, repartitioned_points );
+    auto original_ranks = repartitioner.getOriginalRanks();
+    auto original_ranks_host = Kokkos::create_mirror_view( original_ranks );
+    Kokkos::deep_copy( original_ranks_host, original_ranks );
+    auto original_indices = repartitioner.getOriginalIndices();
+    auto original_indices_host =
+        Kokkos::create_mirror_view( original_indices );
+    Kokkos::deep_copy( original_indices_host, original_indices );
+    for ( int i = 0; i < static_cast<int>( repartitioner.size() ); ++i )
+    {
+        TEST_EQUALITY( original_ranks_host( i ), 0 );
+        TEST_EQUALITY( repartitioned_points_host( i )[0],
+                       original_indices_host( i ) );
+    }
+
+    // results computed on the balanced layout come back to their points
+    Kokkos::View<double **, DeviceType> results( "results",
+                                                 repartitioner.size(), 2 );
+    auto results_host = Kokkos::create_mirror_view( results );
+    for ( int i = 0; i < static_cast<int>( repartitioner.size() ); ++i )
+    {
+        results_host( i, 0 ) = 2. * repartitioned_points_host( i )[0];
+        results_host( i, 1 ) = comm_rank;
+    }
+    Kokkos::deep_copy( results, results_host );
+    Kokkos::View<double **, DeviceType> values( "values", n, 2 );
+    repartitioner.doReverse( results, values );
+    auto values_host = Kokkos::create_mirror_view( values );
+    Kokkos::deep_copy( values_host, values );
+    for ( int i = 0; i < n; ++i )
+        TEST_EQUALITY( values_host( i, 0 ), 2. * i );
+    if ( comm_size > 1 && comm_rank == 0 )
+        TEST_EQUALITY( values_host( n - 1, 1 ), comm_size - 1 );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointRepartitioner, evaluation_set,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Every process owns the unit boxes [i, i+1] x [0, 1] x [0, 1] with
+    // i = comm_rank * n + j. The evaluation points of the first process
+    // cluster in its first box.
+    int const n = 5;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int j = 0; j < n; ++j )
+    {
+        double const x = comm_rank * n + j;
+        boxes_host( j ) = {{x, x + 1., 0., 1., 0., 1.}};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+    DataTransferKit::DistributedSearchTree<DeviceType> tree( comm, boxes );
+
+    int const n_points = ( comm_rank == 0 ) ? 10 * comm_size : 1;
+    DataTransferKit::EvaluationSet<Kokkos::LayoutLeft, DeviceType>
+        evaluation_set;
+    evaluation_set.evaluation_points =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "evaluation_points", n_points, 2 );
+    auto evaluation_points_host =
+        Kokkos::create_mirror_view( evaluation_set.evaluation_points );
+    for ( int i = 0; i < n_points; ++i )
+    {
+        evaluation_points_host( i, 0 ) =
+            comm_rank * n + 0.5 + 0.01 * i * ( comm_rank == 0 );
+        evaluation_points_host( i, 1 ) = 0.5;
+    }
+    Kokkos::deep_copy( evaluation_set.evaluation_points,
+                       evaluation_points_host );
+
+    DataTransferKit::PointRepartitioner<DeviceType> repartitioner(
+        comm, evaluation_set, tree, 0. );
+
+    int n_repartitioned = 0;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_SUM,
+                        static_cast<int>( repartitioner.size() ),
+                        Teuchos::ptr( &n_repartitioned ) );
+    TEST_EQUALITY( n_repartitioned, 11 * comm_size - 1 );
+
+    // Every point lies inside exactly one box, hence weighs 2 counting its
+    // own evaluation. Most of the work is clustered on the first process,
+    // whose samples each stand for a large share of it, so that the regular
+    // sampling only guarantees that no process gets more than about twice
+    // the average work.
+    double const local_work = 2. * repartitioner.size();
+    double max_work = 0.;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_MAX, local_work,
+                        Teuchos::ptr( &max_work ) );
+    double const average_work = 2. * ( 11 * comm_size - 1 ) / comm_size;
+    TEST_COMPARE( max_work, <=, 2. * average_work + 2. );
+
+    Kokkos::View<double *, DeviceType> x( "x", n_points );
+    auto x_host = Kokkos::create_mirror_view( x );
+    for ( int i = 0; i < n_points; ++i )
+        x_host( i ) = evaluation_points_host( i, 0 );
+    Kokkos::deep_copy( x, x_host );
+    Kokkos::View<double *, DeviceType> repartitioned_x( "repartitioned_x",
+                                                        repartitioner.size() );
+    repartitioner.doForward( x, repartitioned_x );
+    auto repartitioned_x_host = Kokkos::create_mirror_view( repartitioned_x );
+    Kokkos::deep_copy( repartitioned_x_host, repartitioned_x );
+    auto points = repartitioner.getPoints();
+    auto points_host = Kokkos::create_mirror_view( points );
+    Kokkos::deep_copy( points_host, points );
+    for ( int i = 0; i < static_cast<int>( repartitioner.size() ); ++i )
+    {
+        TEST_EQUALITY( points_host( i )[0], repartitioned_x_host( i ) );
+        TEST_EQUALITY( points_host( i )[1], 0.5 );
+        TEST_EQUALITY( points_host( i )[2], 0. );
+    }
+
+    Kokkos::View<double *, DeviceType> x_back( "x_back", n_points );
+    repartitioner.doReverse( repartitioned_x, x_back );
+    auto x_back_host = Kokkos::create_mirror_view( x_back );
+    Kokkos::deep_copy( x_back_host, x_back );
+    TEST_COMPARE_ARRAYS( x_back_host, x_host );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointRepartitioner, weights,         \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointRepartitioner, evaluation_set,  \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
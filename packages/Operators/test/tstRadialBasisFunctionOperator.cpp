@@ -0,0 +1,124 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_RadialBasisFunctionOperator.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <cmath>
+#include <vector>
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( RadialBasisFunctionOperator, interpolation,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // The source nodes form a structured grid with unit spacing, split into
+    // slabs of n^3 nodes stacked along the z-axis. The first targets of each
+    // process are the nodes of the next slab, where the interpolant must
+    // match the source values, and the others lie between the nodes.
+    int const n = 4;
+    int const n_nodes = n * n * n;
+    auto f = []( double x, double y, double z ) {
+        return std::cos( 0.3 * x ) + 0.1 * y * z;
+    };
+
+    DataTransferKit::NodeList<Kokkos::LayoutLeft, DeviceType> source;
+    source.coordinates =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "coordinates", n_nodes, 3 );
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        source_field;
+    source_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "source_dofs", n_nodes, 2 );
+    auto coordinates_host = Kokkos::create_mirror_view( source.coordinates );
+    auto source_dofs_host = Kokkos::create_mirror_view( source_field.dofs );
+    for ( int i = 0; i < n_nodes; ++i )
+    {
+        double const x = i % n;
+        double const y = ( i / n ) % n;
+        double const z = comm_rank * n + i / ( n * n );
+        coordinates_host( i, 0 ) = x;
+        coordinates_host( i, 1 ) = y;
+        coordinates_host( i, 2 ) = z;
+        source_dofs_host( i, 0 ) = f( x, y, z );
+        source_dofs_host( i, 1 ) = 2.;
+    }
+    Kokkos::deep_copy( source.coordinates, coordinates_host );
+    Kokkos::deep_copy( source_field.dofs, source_dofs_host );
+
+    int const next_rank = ( comm_rank + 1 ) % comm_size;
+    int const n_exact = 3;
+    int const n_targets = n_exact + 3;
+    DataTransferKit::EvaluationSet<Kokkos::LayoutLeft, DeviceType> target;
+    target.evaluation_points =
+        Kokkos::View<DataTransferKit::Coordinate **, Kokkos::LayoutLeft,
+                     DeviceType>( "evaluation_points", n_targets, 3 );
+    DataTransferKit::Field<double, Kokkos::LayoutLeft, DeviceType>
+        target_field;
+    target_field.dofs = Kokkos::View<double **, Kokkos::LayoutLeft, DeviceType>(
+        "target_dofs", n_targets, 2 );
+    auto evaluation_points_host =
+        Kokkos::create_mirror_view( target.evaluation_points );
+    std::vector<double> expected( n_targets );
+    for ( int i = 0; i < n_targets; ++i )
+    {
+        double const x = ( i < n_exact ) ? i : 0.5 + 0.7 * ( i - n_exact );
+        double const y = ( i < n_exact ) ? 2 : 1.5;
+        double const z =
+            ( i < n_exact ) ? next_rank * n + i : next_rank * n + 1.5;
+        evaluation_points_host( i, 0 ) = x;
+        evaluation_points_host( i, 1 ) = y;
+        evaluation_points_host( i, 2 ) = z;
+        expected[i] = f( x, y, z );
+    }
+    Kokkos::deep_copy( target.evaluation_points, evaluation_points_host );
+
+    DataTransferKit::RadialBasisFunctionOperator<DeviceType> rbf( comm, 2.5 );
+    rbf.setup( source, target );
+    TEST_ASSERT( rbf.isSetUp() );
+    TEST_EQUALITY( rbf.getNumRows(), n_targets );
+
+    rbf.apply( source_field, target_field );
+    TEST_COMPARE( rbf.getNumIterations(), >, 0 );
+
+    auto target_dofs_host = Kokkos::create_mirror_view( target_field.dofs );
+    Kokkos::deep_copy( target_dofs_host, target_field.dofs );
+    for ( int i = 0; i < n_exact; ++i )
+    {
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 0 ), expected[i], 1e-8 );
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 1 ), 2., 1e-8 );
+    }
+    // compactly supported functions do not reproduce constants exactly
+    // between the nodes but the interpolant remains close
+    for ( int i = n_exact; i < n_targets; ++i )
+    {
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 0 ), expected[i], 0.2 );
+        TEST_FLOATING_EQUALITY( target_dofs_host( i, 1 ), 2., 0.2 );
+    }
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( RadialBasisFunctionOperator,         \
+                                          interpolation, DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -0,0 +1,292 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include "DTK_ConfigDefs.hpp"
+#include "DTK_TestMeshHelpers.hpp"
+#include <DTK_SurfaceProjection.hpp>
+
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Project points inside and around the cube [0, p]^3, meshed with unit
+// hexahedra or with six tetrahedra per unit cube, on its surface. The
+// distance to the closest face is the distance to the cube, the others are
+// checked against all the faces.
+template <typename DeviceType>
+void checkProjection( int nodes_per_cell, Teuchos::FancyOStream &out,
+                      bool &success )
+{
+    using DataTransferKit::Details::CellTopology;
+    int const p = 2;
+    CellTopology const topology =
+        ( nodes_per_cell == 4 ) ? CellTopology::TET4 : CellTopology::HEX8;
+    int const n_cell_faces = ( nodes_per_cell == 4 ) ? 4 : 6;
+
+    auto mesh = buildStructuredMesh<DeviceType>( nodes_per_cell, p );
+    int const n_cells = mesh.cells.extent( 0 );
+    auto coordinates_host = Kokkos::create_mirror_view( mesh.coordinates );
+    Kokkos::deep_copy( coordinates_host, mesh.coordinates );
+    auto cells_host = Kokkos::create_mirror_view( mesh.cells );
+    Kokkos::deep_copy( cells_host, mesh.cells );
+
+    // the boundary faces have all their nodes on a face of the cube, the
+    // bottom ones on the plane z = 0
+    std::vector<int> boundary_cells;
+    std::vector<unsigned> cell_faces_on_boundary;
+    std::vector<int> bottom_faces;
+    for ( int c = 0; c < n_cells; ++c )
+        for ( int f = 0; f < n_cell_faces; ++f )
+            for ( int d = 0; d < 3; ++d )
+                for ( double const x : {0., double( p )} )
+                {
+                    bool on_boundary = true;
+                    for ( int k = 0;
+                          k < DataTransferKit::Details::nodesPerFace(
+                                  topology, f );
+                          ++k )
+                    {
+                        int const vertex = cells_host(
+                            c, DataTransferKit::Details::faceNode( topology,
+                                                                   f, k ) );
+                        on_boundary = on_boundary &&
+                                      coordinates_host( vertex, d ) == x;
+                    }
+                    if ( on_boundary )
+                    {
+                        if ( d == 2 && x == 0. )
+                            bottom_faces.push_back( boundary_cells.size() );
+                        boundary_cells.push_back( c );
+                        cell_faces_on_boundary.push_back( f );
+                    }
+                }
+    int const n_faces = boundary_cells.size();
+    TEST_EQUALITY( n_faces, 6 * p * p * ( ( nodes_per_cell == 4 ) ? 2 : 1 ) );
+    mesh.boundary_cells =
+        Kokkos::View<DataTransferKit::LocalOrdinal *, Kokkos::LayoutLeft,
+                     DeviceType>( "boundary_cells", n_faces );
+    mesh.cell_faces_on_boundary =
+        Kokkos::View<unsigned *, Kokkos::LayoutLeft, DeviceType>(
+            "cell_faces_on_boundary", n_faces );
+    auto boundary_cells_host =
+        Kokkos::create_mirror_view( mesh.boundary_cells );
+    auto cell_faces_on_boundary_host =
+        Kokkos::create_mirror_view( mesh.cell_faces_on_boundary );
+    for ( int i = 0; i < n_faces; ++i )
+    {
+        boundary_cells_host( i ) = boundary_cells[i];
+        cell_faces_on_boundary_host( i ) = cell_faces_on_boundary[i];
+    }
+    Kokkos::deep_copy( mesh.boundary_cells, boundary_cells_host );
+    Kokkos::deep_copy( mesh.cell_faces_on_boundary,
+                       cell_faces_on_boundary_host );
+
+    DataTransferKit::SurfaceProjection<DeviceType> projection( mesh );
+    TEST_EQUALITY( projection.size(), n_faces );
+
+    int const n_points = 50;
+    Kokkos::View<double **, DeviceType> points( "points", n_points, 3 );
+    auto points_host = Kokkos::create_mirror_view( points );
+    std::mt19937 generator( 7 );
+    std::uniform_real_distribution<double> distribution( -1., p + 1. );
+    for ( int i = 0; i < n_points; ++i )
+        for ( int d = 0; d < 3; ++d )
+            points_host( i, d ) = distribution( generator );
+    Kokkos::deep_copy( points, points_host );
+
+    int const k = 3;
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> faces( "faces" );
+    Kokkos::View<double **, DeviceType> parametric_coordinates(
+        "parametric_coordinates", 0, 2 );
+    Kokkos::View<double *, DeviceType> distances( "distances" );
+    projection.query( points, k, offset, faces, parametric_coordinates,
+                      distances );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    auto faces_host = Kokkos::create_mirror_view( faces );
+    auto parametric_coordinates_host =
+        Kokkos::create_mirror_view( parametric_coordinates );
+    auto distances_host = Kokkos::create_mirror_view( distances );
+    Kokkos::deep_copy( offset_host, offset );
+    Kokkos::deep_copy( faces_host, faces );
+    Kokkos::deep_copy( parametric_coordinates_host, parametric_coordinates );
+    Kokkos::deep_copy( distances_host, distances );
+    TEST_EQUALITY( offset_host( n_points ), k * n_points );
+
+    // nodes of the boundary face i
+    auto face_nodes = [&]( int i ) {
+        std::vector<DataTransferKit::Point> nodes;
+        for ( int l = 0; l < DataTransferKit::Details::nodesPerFace(
+                                 topology, cell_faces_on_boundary[i] );
+              ++l )
+        {
+            int const vertex =
+                cells_host( boundary_cells[i],
+                            DataTransferKit::Details::faceNode(
+                                topology, cell_faces_on_boundary[i], l ) );
+            nodes.push_back( {{coordinates_host( vertex, 0 ),
+                               coordinates_host( vertex, 1 ),
+                               coordinates_host( vertex, 2 )}} );
+        }
+        return nodes;
+    };
+
+    // distance from x to the boundary face i
+    auto face_distance = [&]( DataTransferKit::Point const &x, int i ) {
+        auto const nodes = face_nodes( i );
+        double s;
+        double t;
+        DataTransferKit::Point const q =
+            ( nodes.size() == 3 )
+                ? DataTransferKit::Details::closestPointOnTriangle(
+                      x, nodes[0], nodes[1], nodes[2], s, t )
+                : DataTransferKit::Details::closestPointOnQuadrilateral(
+                      x, nodes[0], nodes[1], nodes[2], nodes[3], s, t );
+        return std::sqrt( ( q[0] - x[0] ) * ( q[0] - x[0] ) +
+                          ( q[1] - x[1] ) * ( q[1] - x[1] ) +
+                          ( q[2] - x[2] ) * ( q[2] - x[2] ) );
+    };
+
+    for ( int i = 0; i < n_points; ++i )
+    {
+        DataTransferKit::Point const x = {
+            {points_host( i, 0 ), points_host( i, 1 ), points_host( i, 2 )}};
+
+        // distance to the surface of the cube
+        double outside = 0.;
+        double inside = p;
+        for ( int d = 0; d < 3; ++d )
+        {
+            double const below = std::max( -x[d], 0. );
+            double const above = std::max( x[d] - p, 0. );
+            outside += below * below + above * above;
+            inside = std::min( inside, std::min( x[d], p - x[d] ) );
+        }
+        double const expected =
+            ( outside > 0. ) ? std::sqrt( outside ) : inside;
+        TEST_FLOATING_EQUALITY( distances_host( offset_host( i ) ), expected,
+                                1e-12 );
+
+        // distances to all the faces
+        std::vector<double> all_distances;
+        for ( int f = 0; f < n_faces; ++f )
+            all_distances.push_back( face_distance( x, f ) );
+        std::sort( all_distances.begin(), all_distances.end() );
+
+        for ( int j = offset_host( i ); j < offset_host( i + 1 ); ++j )
+        {
+            TEST_FLOATING_EQUALITY( distances_host( j ),
+                                    all_distances[j - offset_host( i )],
+                                    1e-12 );
+
+            // the parametric coordinates give back the closest point
+            auto const nodes = face_nodes( faces_host( j ) );
+            double const s = parametric_coordinates_host( j, 0 );
+            double const t = parametric_coordinates_host( j, 1 );
+            std::vector<double> weights = {1. - s - t, s, t};
+            if ( nodes.size() == 4 )
+                weights = {( 1. - s ) * ( 1. - t ), s * ( 1. - t ), s * t,
+                           ( 1. - s ) * t};
+            double distance_squared = 0.;
+            for ( int d = 0; d < 3; ++d )
+            {
+                double q = 0.;
+                for ( unsigned int l = 0; l < nodes.size(); ++l )
+                    q += weights[l] * nodes[l][d];
+                distance_squared += ( q - x[d] ) * ( q - x[d] );
+            }
+            TEST_FLOATING_EQUALITY( std::sqrt( distance_squared ),
+                                    distances_host( j ), 1e-10 );
+        }
+    }
+
+    // more faces than there are, on the bottom of the cube only so that the
+    // number of faces does not depend on the size of the mesh
+    int const n_bottom_faces = bottom_faces.size();
+    TEST_EQUALITY( n_bottom_faces, n_faces / 6 );
+    auto bottom_mesh = mesh;
+    bottom_mesh.boundary_cells =
+        Kokkos::View<DataTransferKit::LocalOrdinal *, Kokkos::LayoutLeft,
+                     DeviceType>( "bottom_cells", n_bottom_faces );
+    bottom_mesh.cell_faces_on_boundary =
+        Kokkos::View<unsigned *, Kokkos::LayoutLeft, DeviceType>(
+            "bottom_cell_faces", n_bottom_faces );
+    auto bottom_cells_host =
+        Kokkos::create_mirror_view( bottom_mesh.boundary_cells );
+    auto bottom_cell_faces_host =
+        Kokkos::create_mirror_view( bottom_mesh.cell_faces_on_boundary );
+    for ( int i = 0; i < n_bottom_faces; ++i )
+    {
+        bottom_cells_host( i ) = boundary_cells[bottom_faces[i]];
+        bottom_cell_faces_host( i ) = cell_faces_on_boundary[bottom_faces[i]];
+    }
+    Kokkos::deep_copy( bottom_mesh.boundary_cells, bottom_cells_host );
+    Kokkos::deep_copy( bottom_mesh.cell_faces_on_boundary,
+                       bottom_cell_faces_host );
+
+    DataTransferKit::SurfaceProjection<DeviceType> bottom( bottom_mesh );
+    bottom.query( points, n_bottom_faces + 1, offset, faces,
+                  parametric_coordinates, distances );
+    Kokkos::deep_copy( offset_host, offset );
+    faces_host = Kokkos::create_mirror_view( faces );
+    distances_host = Kokkos::create_mirror_view( distances );
+    Kokkos::deep_copy( faces_host, faces );
+    Kokkos::deep_copy( distances_host, distances );
+    TEST_EQUALITY( offset_host( n_points ), n_bottom_faces * n_points );
+    for ( int i = 0; i < n_points; ++i )
+    {
+        DataTransferKit::Point const x = {
+            {points_host( i, 0 ), points_host( i, 1 ), points_host( i, 2 )}};
+        std::vector<int> found;
+        for ( int j = offset_host( i ); j < offset_host( i + 1 ); ++j )
+        {
+            found.push_back( faces_host( j ) );
+            TEST_FLOATING_EQUALITY(
+                distances_host( j ),
+                face_distance( x, bottom_faces[faces_host( j )] ), 1e-12 );
+            if ( j > offset_host( i ) )
+                TEST_ASSERT( distances_host( j - 1 ) <= distances_host( j ) );
+        }
+        // every face is reported once
+        std::sort( found.begin(), found.end() );
+        for ( int f = 0; f < n_bottom_faces; ++f )
+            TEST_EQUALITY( found[f], f );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SurfaceProjection, quadrilaterals,
+                                   DeviceType )
+{
+    checkProjection<DeviceType>( 8, out, success );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SurfaceProjection, triangles, DeviceType )
+{
+    checkProjection<DeviceType>( 4, out, success );
+}
+
+// Include the test macros.
+#include "DataTransferKitOperators_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SurfaceProjection, quadrilaterals,   \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SurfaceProjection, triangles,        \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -73,6 +73,7 @@ int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
     int nz = 11;
     int n_points = 100;
     std::string mode = "radius";
+    double eps = 0.;
 
     clp.setOption( "nx", &nx, "source mesh points in x-direction." );
     clp.setOption( "ny", &ny, "source mesh points in y-direction." );
@@ -80,6 +81,8 @@ int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
     clp.setOption( "N", &n_points,
                    "number of target mesh points (distributed randomly)." );
     clp.setOption( "mode", &mode, "mode: (knn | radius)" );
+    clp.setOption( "eps", &eps,
+                   "relative error allowed in the knn search (0 is exact)." );
 
     clp.recogniseAllOptions( true );
     switch ( clp.parse( argc, argv ) )
@@ -146,8 +149,8 @@ int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
         }
         Kokkos::deep_copy( k, k_host );
 
-        Kokkos::View<details::Nearest *, DeviceType> nearest_queries(
-            "nearest_queries", n_points );
+        Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+            nearest_queries( "nearest_queries", n_points );
         Kokkos::parallel_for(
             REGION_NAME( "register_nearest_queries" ),
             Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
@@ -155,7 +158,7 @@ int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
                 nearest_queries( i ) = details::nearest( {point_coords( i, 0 ),
                                                           point_coords( i, 1 ),
                                                           point_coords( i, 2 )},
-                                                         k( i ) );
+                                                         k( i ), eps );
             } );
         Kokkos::fence();
 
@@ -183,8 +186,8 @@ int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
         }
         Kokkos::deep_copy( radii, radii_host );
 
-        Kokkos::View<details::Within *, DeviceType> within_queries(
-            "within_queries", n_points );
+        Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+            within_queries( "within_queries", n_points );
         Kokkos::parallel_for(
             REGION_NAME( "register_within_queries" ),
             Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
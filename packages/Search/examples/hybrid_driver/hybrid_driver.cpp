@@ -0,0 +1,281 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+// Compare the distributed search with one tree per process (MPI-only) against
+// the hybrid search with one tree per node. The total amount of work is
+// fixed, so runs with a different number of processes per node, e.g.
+//
+//   OMP_NUM_THREADS=1  mpirun -np 32 --map-by ppr:16:node hybrid --node=openmp
+//   OMP_NUM_THREADS=4  mpirun -np 8  --map-by ppr:4:node  hybrid --node=openmp
+//   OMP_NUM_THREADS=16 mpirun -np 2  --map-by ppr:1:node  hybrid --node=openmp
+//
+// may be compared directly. The times reported are the maximum over all the
+// processes.
+
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_CommandLineProcessor.hpp>
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_GlobalMPISession.hpp>
+#include <Teuchos_StandardCatchMacros.hpp>
+#include <Teuchos_Time.hpp>
+
+#include <Kokkos_DefaultNode.hpp>
+
+#include <DTK_ConfigDefs.hpp>
+
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_HybridSearchTree.hpp>
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+
+namespace details = DataTransferKit::Details;
+
+template <typename Tree, typename Query, typename DeviceType>
+void timeSearch( Teuchos::Comm<int> const &comm, std::string const &name,
+                 Kokkos::View<Query *, DeviceType> queries, int n_repeats,
+                 std::function<Tree *()> const &build )
+{
+    comm.barrier();
+    double start = Teuchos::Time::wallTime();
+    std::unique_ptr<Tree> tree( build() );
+    double const construction = Teuchos::Time::wallTime() - start;
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    comm.barrier();
+    start = Teuchos::Time::wallTime();
+    for ( int i = 0; i < n_repeats; ++i )
+        tree->query( queries, indices, offset, ranks );
+    double const search = ( Teuchos::Time::wallTime() - start ) / n_repeats;
+
+    double const local_times[2] = {construction, search};
+    double max_times[2];
+    Teuchos::reduceAll( comm, Teuchos::REDUCE_MAX, 2, local_times, max_times );
+    int const n_results = indices.extent( 0 );
+    int max_results = 0;
+    Teuchos::reduceAll( comm, Teuchos::REDUCE_MAX, n_results,
+                        Teuchos::ptr( &max_results ) );
+    if ( comm.getRank() == 0 )
+        std::cout << name << ": construction " << max_times[0] << " s, search "
+                  << max_times[1] << " s, max results per process "
+                  << max_results << std::endl;
+}
+
+template <class NO>
+int main_( Teuchos::CommandLineProcessor &clp, int argc, char *argv[] )
+{
+    using DeviceType = typename NO::device_type;
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    int n_total = 1000000;
+    int n_queries_total = 100000;
+    double radius = 1.;
+    int n_repeats = 10;
+    std::string mode = "radius";
+
+    clp.setOption( "n-objects", &n_total,
+                   "total number of source points, split among processes." );
+    clp.setOption( "n-queries", &n_queries_total,
+                   "total number of queries, split among processes." );
+    clp.setOption( "radius", &radius, "radius of the radius search." );
+    clp.setOption( "repeats", &n_repeats,
+                   "number of times the search is run." );
+    clp.setOption( "mode", &mode, "mode: (knn | radius)" );
+
+    clp.recogniseAllOptions( true );
+    switch ( clp.parse( argc, argv ) )
+    {
+    case Teuchos::CommandLineProcessor::PARSE_HELP_PRINTED:
+        return EXIT_SUCCESS;
+    case Teuchos::CommandLineProcessor::PARSE_ERROR:
+    case Teuchos::CommandLineProcessor::PARSE_UNRECOGNIZED_OPTION:
+        return EXIT_FAILURE;
+    case Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL:
+        break;
+    }
+
+    // The source points are random within a cube of unit density split into
+    // slabs along the z-axis, one per process. The queries are random in the
+    // whole cube.
+    double const L = std::cbrt( static_cast<double>( n_total ) );
+    double const h = L / comm_size;
+    int const n = n_total / comm_size;
+    int const n_queries = n_queries_total / comm_size;
+    std::default_random_engine generator( comm_rank );
+    std::uniform_real_distribution<double> distribution( 0., L );
+    std::uniform_real_distribution<double> distribution_z( comm_rank * h,
+                                                           ( comm_rank + 1 ) *
+                                                               h );
+
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n; ++i )
+    {
+        double const x = distribution( generator );
+        double const y = distribution( generator );
+        double const z = distribution_z( generator );
+        boxes_host( i ) = {{x, x, y, y, z, z}};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    Kokkos::View<double * [3], DeviceType> points( "points", n_queries );
+    auto points_host = Kokkos::create_mirror_view( points );
+    for ( int i = 0; i < n_queries; ++i )
+        for ( int d = 0; d < 3; ++d )
+            points_host( i, d ) = distribution( generator );
+    Kokkos::deep_copy( points, points_host );
+
+    // report how the processes are laid out on the nodes
+    DataTransferKit::HybridSearchTree<DeviceType> probe(
+        comm, Kokkos::View<DataTransferKit::Box *, DeviceType>( "empty" ) );
+    int const node_size = probe.getNodeSize();
+    int max_node_size = 0;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_MAX, node_size,
+                        Teuchos::ptr( &max_node_size ) );
+    if ( comm_rank == 0 )
+        std::cout << comm_size << " processes, up to " << max_node_size
+                  << " per node, " << ExecutionSpace::concurrency()
+                  << " threads per process" << std::endl;
+
+    auto build_distributed = [&]() {
+        return new DataTransferKit::DistributedSearchTree<DeviceType>( comm,
+                                                                       boxes );
+    };
+    auto build_hybrid = [&]() {
+        return new DataTransferKit::HybridSearchTree<DeviceType>( comm, boxes );
+    };
+
+    if ( mode == "knn" )
+    {
+        Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+            queries( "queries", n_queries );
+        Kokkos::parallel_for(
+            REGION_NAME( "register_nearest_queries" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+            KOKKOS_LAMBDA( int i ) {
+                queries( i ) = details::nearest(
+                    {{points( i, 0 ), points( i, 1 ), points( i, 2 )}}, 10 );
+            } );
+        Kokkos::fence();
+        timeSearch<DataTransferKit::DistributedSearchTree<DeviceType>>(
+            *comm, "MPI-only", queries, n_repeats, build_distributed );
+        timeSearch<DataTransferKit::HybridSearchTree<DeviceType>>(
+            *comm, "hybrid", queries, n_repeats, build_hybrid );
+    }
+    else if ( mode == "radius" )
+    {
+        Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+            queries( "queries", n_queries );
+        Kokkos::parallel_for(
+            REGION_NAME( "register_within_queries" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+            KOKKOS_LAMBDA( int i ) {
+                queries( i ) = details::within(
+                    {{points( i, 0 ), points( i, 1 ), points( i, 2 )}},
+                    radius );
+            } );
+        Kokkos::fence();
+        timeSearch<DataTransferKit::DistributedSearchTree<DeviceType>>(
+            *comm, "MPI-only", queries, n_repeats, build_distributed );
+        timeSearch<DataTransferKit::HybridSearchTree<DeviceType>>(
+            *comm, "hybrid", queries, n_repeats, build_hybrid );
+    }
+    else
+    {
+        throw std::runtime_error( "Unrecognized search mode" );
+    }
+
+    return 0;
+}
+
+int main( int argc, char *argv[] )
+{
+    Teuchos::GlobalMPISession mpi_session( &argc, &argv );
+    Kokkos::initialize( argc, argv );
+
+    bool success = false;
+    bool verbose = true;
+
+    int rv = 0;
+    try
+    {
+        const bool throwExceptions = false;
+
+        Teuchos::CommandLineProcessor clp( throwExceptions );
+
+        // the hybrid search needs a device that can access host memory
+#ifdef KOKKOS_HAVE_OPENMP
+        std::string node = "openmp";
+#else
+        std::string node = "serial";
+#endif
+        clp.setOption( "node", &node, "node type (serial | openmp)" );
+
+        clp.recogniseAllOptions( false );
+        switch ( clp.parse( argc, argv, NULL ) )
+        {
+        case Teuchos::CommandLineProcessor::PARSE_ERROR:
+            rv = 1;
+        case Teuchos::CommandLineProcessor::PARSE_HELP_PRINTED:
+        case Teuchos::CommandLineProcessor::PARSE_UNRECOGNIZED_OPTION:
+        case Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL:
+            break;
+        }
+
+        if ( rv )
+        {
+            // do nothing, just skip other if clauses
+        }
+        else if ( node == "serial" )
+        {
+#ifdef KOKKOS_HAVE_SERIAL
+            typedef Kokkos::Compat::KokkosSerialWrapperNode Node;
+            rv = main_<Node>( clp, argc, argv );
+#else
+            throw std::runtime_error( "Serial node type is disabled" );
+#endif
+        }
+        else if ( node == "openmp" )
+        {
+#ifdef KOKKOS_HAVE_OPENMP
+            typedef Kokkos::Compat::KokkosOpenMPWrapperNode Node;
+            rv = main_<Node>( clp, argc, argv );
+#else
+            throw std::runtime_error( "OpenMP node type is disabled" );
+#endif
+        }
+        else if ( node == "cuda" )
+        {
+            throw std::runtime_error(
+                "The hybrid search is not available for the CUDA node type" );
+        }
+        else
+        {
+            throw std::runtime_error( "Unrecognized node type" );
+        }
+
+        if ( rv )
+            success = false;
+    }
+    TEUCHOS_STANDARD_CATCH_STATEMENTS( verbose, std::cerr, success );
+
+    Kokkos::finalize();
+
+    return ( success ? EXIT_SUCCESS : EXIT_FAILURE );
+}
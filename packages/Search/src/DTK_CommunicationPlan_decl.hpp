@@ -0,0 +1,179 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_COMMUNICATION_PLAN_DECL_HPP
+#define DTK_COMMUNICATION_PLAN_DECL_HPP
+
+#include <DTK_DBC.hpp>
+
+#include <Kokkos_Core.hpp>
+#include <Kokkos_View.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <vector>
+
+namespace DataTransferKit
+{
+/**
+ * Communication pattern that fetches values attached to objects owned by
+ * other processes. It is built once from the results of a search on a
+ * DistributedSearchTree and may then be reused to exchange fields as often
+ * as needed without discovering the pattern again. Each exchange only
+ * involves nonblocking point-to-point communication with the processes that
+ * actually have data to send or receive.
+ */
+template <typename DeviceType>
+class CommunicationPlan
+{
+  public:
+    // ranks(j) is the rank of the process that owns the object indices(j),
+    // which is its local index on that process. This is the format of the
+    // results of DistributedSearchTree::query(). Collective.
+    CommunicationPlan( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                       Kokkos::View<int const *, DeviceType> ranks,
+                       Kokkos::View<int const *, DeviceType> indices );
+
+    // On exit, target_values(j) is the value source_values(indices(j)) on
+    // process ranks(j). Collective.
+    template <typename T>
+    void doExchange( Kokkos::View<T *, DeviceType> source_values,
+                     Kokkos::View<T *, DeviceType> target_values ) const;
+
+    // Same as above for values with several components (e.g. the degrees of
+    // freedom of a Field), stored along the second dimension.
+    template <typename T>
+    void doExchange( Kokkos::View<T **, DeviceType> source_values,
+                     Kokkos::View<T **, DeviceType> target_values ) const;
+
+    // Number of values received by this process.
+    size_t getNumImports() const { return _permute.extent( 0 ); }
+
+    // Number of values sent by this process.
+    size_t getNumExports() const { return _export_indices.extent( 0 ); }
+
+  private:
+    void exchange( char const *exports, char *imports,
+                   size_t packet_size ) const;
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // the tags of the plans cycle through [tag_base, tag_base + max_tags),
+    // which is within the range guaranteed by the MPI standard and below the
+    // tags Teuchos uses for its own messages
+    static constexpr int tag_base = 10000;
+    static constexpr int max_tags = 10000;
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    int _tag;
+    // processes to send values to, how many and where they start in the
+    // export buffer
+    std::vector<int> _send_ranks;
+    std::vector<int> _send_counts;
+    std::vector<int> _send_displs;
+    // processes to receive values from, how many and where they start in the
+    // import buffer
+    std::vector<int> _recv_ranks;
+    std::vector<int> _recv_counts;
+    std::vector<int> _recv_displs;
+    // local indices of the objects whose values fill the export buffer
+    Kokkos::View<int *, DeviceType> _export_indices;
+    // position in the import buffer of the value for each target
+    Kokkos::View<int *, DeviceType> _permute;
+};
+
+template <typename DeviceType>
+template <typename T>
+void CommunicationPlan<DeviceType>::doExchange(
+    Kokkos::View<T *, DeviceType> source_values,
+    Kokkos::View<T *, DeviceType> target_values ) const
+{
+    DTK_REQUIRE( target_values.extent( 0 ) == getNumImports() );
+
+    auto const export_indices = _export_indices;
+    auto const permute = _permute;
+
+    Kokkos::View<T *, DeviceType> exports( "exports", getNumExports() );
+    Kokkos::parallel_for(
+        REGION_NAME( "pack_exports" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, getNumExports() ),
+        KOKKOS_LAMBDA( int i ) {
+            exports( i ) = source_values( export_indices( i ) );
+        } );
+    Kokkos::fence();
+
+    auto exports_host = Kokkos::create_mirror_view( exports );
+    Kokkos::deep_copy( exports_host, exports );
+    Kokkos::View<T *, DeviceType> imports( "imports", getNumImports() );
+    auto imports_host = Kokkos::create_mirror_view( imports );
+
+    exchange( reinterpret_cast<char const *>( exports_host.data() ),
+              reinterpret_cast<char *>( imports_host.data() ), sizeof( T ) );
+
+    Kokkos::deep_copy( imports, imports_host );
+    Kokkos::parallel_for(
+        REGION_NAME( "unpack_imports" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, getNumImports() ),
+        KOKKOS_LAMBDA( int j ) {
+            target_values( j ) = imports( permute( j ) );
+        } );
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+template <typename T>
+void CommunicationPlan<DeviceType>::doExchange(
+    Kokkos::View<T **, DeviceType> source_values,
+    Kokkos::View<T **, DeviceType> target_values ) const
+{
+    DTK_REQUIRE( target_values.extent( 0 ) == getNumImports() );
+    DTK_REQUIRE( target_values.extent( 1 ) == source_values.extent( 1 ) );
+
+    auto const export_indices = _export_indices;
+    auto const permute = _permute;
+    int const n_components = source_values.extent( 1 );
+
+    // the buffers must be contiguous by rows regardless of the default layout
+    // of the device
+    using BufferType = Kokkos::View<T **, Kokkos::LayoutRight, DeviceType>;
+    BufferType exports( "exports", getNumExports(), n_components );
+    Kokkos::parallel_for(
+        REGION_NAME( "pack_exports" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, getNumExports() ),
+        KOKKOS_LAMBDA( int i ) {
+            for ( int d = 0; d < n_components; ++d )
+                exports( i, d ) = source_values( export_indices( i ), d );
+        } );
+    Kokkos::fence();
+
+    auto exports_host = Kokkos::create_mirror_view( exports );
+    Kokkos::deep_copy( exports_host, exports );
+    BufferType imports( "imports", getNumImports(), n_components );
+    auto imports_host = Kokkos::create_mirror_view( imports );
+
+    exchange( reinterpret_cast<char const *>( exports_host.data() ),
+              reinterpret_cast<char *>( imports_host.data() ),
+              n_components * sizeof( T ) );
+
+    Kokkos::deep_copy( imports, imports_host );
+    Kokkos::parallel_for(
+        REGION_NAME( "unpack_imports" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, getNumImports() ),
+        KOKKOS_LAMBDA( int j ) {
+            for ( int d = 0; d < n_components; ++d )
+                target_values( j, d ) = imports( permute( j ), d );
+        } );
+    Kokkos::fence();
+}
+
+} // end namespace DataTransferKit
+
+#endif
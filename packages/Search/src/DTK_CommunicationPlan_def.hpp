@@ -0,0 +1,184 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_COMMUNICATION_PLAN_DEF_HPP
+#define DTK_COMMUNICATION_PLAN_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+
+#include <Teuchos_ArrayRCP.hpp>
+#include <Teuchos_ArrayView.hpp>
+#include <Teuchos_CommHelpers.hpp>
+#include <Tpetra_Distributor.hpp>
+
+#include <algorithm>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+CommunicationPlan<DeviceType>::CommunicationPlan(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<int const *, DeviceType> ranks,
+    Kokkos::View<int const *, DeviceType> indices )
+    : _comm( comm )
+{
+    DTK_REQUIRE( ranks.extent( 0 ) == indices.extent( 0 ) );
+
+    int const comm_rank = _comm->getRank();
+    int const comm_size = _comm->getSize();
+    int const n_targets = ranks.extent( 0 );
+
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+
+    // Tell the owners which of their objects are needed and by whom. This is
+    // the only time the pattern has to be discovered.
+    Tpetra::Distributor distributor( _comm );
+    int const n_exports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( ranks_host.data(), n_targets ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks",
+                                                  n_targets );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+    Kokkos::View<int *, DeviceType> requesting_ranks( "requesting_ranks",
+                                                      n_exports );
+    Kokkos::View<int *, DeviceType> requested_indices( "requested_indices",
+                                                       n_exports );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_ranks, requesting_ranks );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, indices, requested_indices );
+
+    // Group the exports by destination. The relative order of the requests
+    // from a given process is preserved, which is the order in which that
+    // process will receive the values.
+    auto requesting_ranks_host = Kokkos::create_mirror_view( requesting_ranks );
+    Kokkos::deep_copy( requesting_ranks_host, requesting_ranks );
+    auto requested_indices_host =
+        Kokkos::create_mirror_view( requested_indices );
+    Kokkos::deep_copy( requested_indices_host, requested_indices );
+
+    std::vector<int> send_counts( comm_size, 0 );
+    for ( int i = 0; i < n_exports; ++i )
+        ++send_counts[requesting_ranks_host( i )];
+    std::vector<int> send_displs( comm_size + 1, 0 );
+    for ( int r = 0; r < comm_size; ++r )
+        send_displs[r + 1] = send_displs[r] + send_counts[r];
+
+    Kokkos::realloc( _export_indices, n_exports );
+    auto export_indices_host = Kokkos::create_mirror_view( _export_indices );
+    std::vector<int> count( comm_size, 0 );
+    for ( int i = 0; i < n_exports; ++i )
+    {
+        int const r = requesting_ranks_host( i );
+        export_indices_host( send_displs[r] + count[r]++ ) =
+            requested_indices_host( i );
+    }
+    Kokkos::deep_copy( _export_indices, export_indices_host );
+
+    // Values are received grouped by source in the order of the requests.
+    std::vector<int> recv_counts( comm_size, 0 );
+    for ( int j = 0; j < n_targets; ++j )
+        ++recv_counts[ranks_host( j )];
+    std::vector<int> recv_displs( comm_size + 1, 0 );
+    for ( int r = 0; r < comm_size; ++r )
+        recv_displs[r + 1] = recv_displs[r] + recv_counts[r];
+
+    Kokkos::realloc( _permute, n_targets );
+    auto permute_host = Kokkos::create_mirror_view( _permute );
+    std::fill( count.begin(), count.end(), 0 );
+    for ( int j = 0; j < n_targets; ++j )
+    {
+        int const r = ranks_host( j );
+        permute_host( j ) = recv_displs[r] + count[r]++;
+    }
+    Kokkos::deep_copy( _permute, permute_host );
+
+    // Every plan communicates with its own tag so that the messages of two
+    // plans in flight on the same communicator cannot be mixed up. The
+    // processes agree on the next tag none of them has used yet.
+    static int next_tag = 0;
+    int tag = 0;
+    Teuchos::reduceAll( *_comm, Teuchos::REDUCE_MAX, next_tag,
+                        Teuchos::ptr( &tag ) );
+    next_tag = ( tag + 1 ) % max_tags;
+    _tag = tag_base + tag;
+
+    // Only keep the processes that actually exchange data with this one.
+    for ( int r = 0; r < comm_size; ++r )
+    {
+        if ( send_counts[r] > 0 )
+        {
+            _send_ranks.push_back( r );
+            _send_counts.push_back( send_counts[r] );
+            _send_displs.push_back( send_displs[r] );
+        }
+        if ( recv_counts[r] > 0 )
+        {
+            _recv_ranks.push_back( r );
+            _recv_counts.push_back( recv_counts[r] );
+            _recv_displs.push_back( recv_displs[r] );
+        }
+    }
+}
+
+template <typename DeviceType>
+void CommunicationPlan<DeviceType>::exchange( char const *exports,
+                                              char *imports,
+                                              size_t packet_size ) const
+{
+    int const comm_rank = _comm->getRank();
+
+    // The values this process needs from itself are copied directly. Only
+    // the other processes are sent messages, which a serial communicator
+    // does not support anyway.
+    std::vector<Teuchos::RCP<Teuchos::CommRequest<int>>> requests;
+    requests.reserve( _recv_ranks.size() + _send_ranks.size() );
+
+    // post the receives first so that the messages do not have to be
+    // buffered by MPI
+    for ( size_t i = 0; i < _recv_ranks.size(); ++i )
+        if ( _recv_ranks[i] != comm_rank )
+            requests.push_back( Teuchos::ireceive<char>(
+                Teuchos::arcp( imports + _recv_displs[i] * packet_size, 0,
+                               _recv_counts[i] * packet_size, false ),
+                _recv_ranks[i], _tag, *_comm ) );
+    for ( size_t i = 0; i < _send_ranks.size(); ++i )
+    {
+        char const *first = exports + _send_displs[i] * packet_size;
+        char const *last = first + _send_counts[i] * packet_size;
+        if ( _send_ranks[i] == comm_rank )
+        {
+            auto const self = std::find( _recv_ranks.begin(),
+                                         _recv_ranks.end(), comm_rank );
+            DTK_CHECK( self != _recv_ranks.end() );
+            std::copy( first, last,
+                       imports +
+                           _recv_displs[self - _recv_ranks.begin()] *
+                               packet_size );
+        }
+        else
+            requests.push_back( Teuchos::isend<char>(
+                Teuchos::arcp( first, 0, last - first, false ),
+                _send_ranks[i], _tag, *_comm ) );
+    }
+
+    Teuchos::waitAll( *_comm, Teuchos::arrayViewFromVector( requests ) );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_COMMUNICATIONPLAN_INSTANT( NODE )                                  \
+    template class CommunicationPlan<typename NODE::device_type>;
+
+#endif
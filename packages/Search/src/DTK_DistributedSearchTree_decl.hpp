@@ -0,0 +1,130 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_DISTRIBUTED_SEARCH_TREE_DECL_HPP
+#define DTK_DISTRIBUTED_SEARCH_TREE_DECL_HPP
+
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+#include <DTK_LinearBVH.hpp>
+
+#include <Kokkos_View.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include <type_traits>
+
+#include "DTK_ConfigDefs.hpp"
+
+namespace DataTransferKit
+{
+/**
+ * Search tree distributed across MPI ranks. Each process builds a BVH over
+ * its local objects and a top tree over the bounding boxes of the scene of
+ * every process. The top tree is replicated and used to forward the queries
+ * only to the processes that may own objects that meet them.
+ */
+template <typename DeviceType>
+class DistributedSearchTree
+{
+  public:
+    DistributedSearchTree(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm,
+        Kokkos::View<Box const *, DeviceType> bounding_boxes );
+
+    // Same as BVH::query() except that ranks(j) is the rank of the process
+    // that owns the object indices(j), which is its local index on that
+    // process.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<int *, DeviceType> &ranks ) const;
+
+    // Same as above but also returns the distance from the query geometry to
+    // each object found. Only applies to nearest queries, for which the
+    // objects are sorted by increasing distance.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<int *, DeviceType> &ranks,
+                Kokkos::View<double *, DeviceType> &distances ) const;
+
+    // Same as query() for spatial predicates but the stages of the search
+    // are pipelined. The queries are shipped with nonblocking communication
+    // and the chunks already received are searched while the other messages
+    // are still in flight, so that a process does not sit idle waiting on
+    // the slowest one. The time spent by this process in each stage is added
+    // to timings.
+    template <typename Query>
+    void pipelinedQuery( Kokkos::View<Query *, DeviceType> queries,
+                         Kokkos::View<int *, DeviceType> &indices,
+                         Kokkos::View<int *, DeviceType> &offset,
+                         Kokkos::View<int *, DeviceType> &ranks,
+                         QueryPipelineTimings &timings ) const;
+
+  private:
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    BVH<DeviceType> _bottom_tree;
+    BVH<DeviceType> _top_tree;
+};
+
+template <typename DeviceType>
+template <typename Query>
+void DistributedSearchTree<DeviceType>::query(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks ) const
+{
+    using Tag = typename Query::Tag;
+    Details::DistributedSearchTreeImpl<DeviceType>::queryDispatch(
+        _comm, _top_tree, _bottom_tree, queries, indices, offset, ranks,
+        Tag{} );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void DistributedSearchTree<DeviceType>::query(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<double *, DeviceType> &distances ) const
+{
+    using Tag = typename Query::Tag;
+    static_assert(
+        std::is_same<Tag, Details::NearestPredicateTag>::value,
+        "distances are only reported for nearest queries" );
+    Details::DistributedSearchTreeImpl<DeviceType>::queryDispatch(
+        _comm, _top_tree, _bottom_tree, queries, indices, offset, ranks,
+        distances, Tag{} );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void DistributedSearchTree<DeviceType>::pipelinedQuery(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    QueryPipelineTimings &timings ) const
+{
+    static_assert( std::is_same<typename Query::Tag,
+                                Details::SpatialPredicateTag>::value,
+                   "only spatial queries can be pipelined" );
+    Details::DistributedSearchTreeImpl<DeviceType>::pipelinedQueryDispatch(
+        _comm, _top_tree, _bottom_tree, queries, indices, offset, ranks,
+        timings );
+}
+
+} // end namespace DataTransferKit
+
+#endif
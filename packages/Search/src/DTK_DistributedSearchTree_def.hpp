@@ -0,0 +1,38 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_DISTRIBUTED_SEARCH_TREE_DEF_HPP
+#define DTK_DISTRIBUTED_SEARCH_TREE_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+DistributedSearchTree<DeviceType>::DistributedSearchTree(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Box const *, DeviceType> bounding_boxes )
+    : _comm( comm )
+    , _bottom_tree( bounding_boxes )
+    , _top_tree(
+          Details::DistributedSearchTreeImpl<DeviceType>::gatherBoundingBoxes(
+              *comm, _bottom_tree.bounds() ) )
+{
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_DISTRIBUTEDSEARCHTREE_INSTANT( NODE )                              \
+    template class DistributedSearchTree<typename NODE::device_type>;
+
+#endif
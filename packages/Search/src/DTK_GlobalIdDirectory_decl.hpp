@@ -0,0 +1,66 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_GLOBAL_ID_DIRECTORY_DECL_HPP
+#define DTK_GLOBAL_ID_DIRECTORY_DECL_HPP
+
+#include <Kokkos_View.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+
+namespace DataTransferKit
+{
+/**
+ * Distributed directory that maps global ids (e.g. the global_dof_ids of a
+ * DOFMap) to the rank of the process that owns them and their local index on
+ * that process. The entries are spread over the processes by hashing the
+ * global ids so that no process needs to hold the complete list. Both the
+ * construction and the lookups only involve exchanging data with the
+ * processes that hold the relevant entries.
+ */
+template <typename DeviceType>
+class GlobalIdDirectory
+{
+  public:
+    // global_ids(i) is owned by the calling process with local index i. If
+    // several processes list the same global id, as with the ghosted degrees
+    // of freedom of a DOFMap, the process with the lowest rank owns it.
+    // Collective.
+    GlobalIdDirectory(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm,
+        Kokkos::View<GlobalOrdinal const *, DeviceType> global_ids );
+
+    // On exit, ranks(i) is the rank of the process that owns global_ids(i)
+    // and indices(i) its local index on that process. Both are -1 if the
+    // global id was not registered. The results may be passed directly to a
+    // CommunicationPlan. Collective.
+    void query( Kokkos::View<GlobalOrdinal const *, DeviceType> global_ids,
+                Kokkos::View<int *, DeviceType> &ranks,
+                Kokkos::View<int *, DeviceType> &indices ) const;
+
+    // Number of entries held by this process.
+    size_t size() const { return _global_ids.extent( 0 ); }
+
+  private:
+    // Rank of the process that holds the entry of each global id.
+    Kokkos::View<int *, DeviceType> directoryRanks(
+        Kokkos::View<GlobalOrdinal const *, DeviceType> global_ids ) const;
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    // entries held by this process, sorted by global id
+    Kokkos::View<GlobalOrdinal *, DeviceType> _global_ids;
+    Kokkos::View<int *, DeviceType> _owner_ranks;
+    Kokkos::View<int *, DeviceType> _owner_indices;
+};
+
+} // end namespace DataTransferKit
+
+#endif
@@ -0,0 +1,238 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_GLOBAL_ID_DIRECTORY_DEF_HPP
+#define DTK_GLOBAL_ID_DIRECTORY_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+#include <DTK_KokkosHelpers.hpp>
+
+#include <Teuchos_ArrayView.hpp>
+#include <Tpetra_Distributor.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+GlobalIdDirectory<DeviceType>::GlobalIdDirectory(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<GlobalOrdinal const *, DeviceType> global_ids )
+    : _comm( comm )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const comm_rank = _comm->getRank();
+    int const n = global_ids.extent( 0 );
+
+    // send every global id to the process that holds its entry along with
+    // the rank and the local index of the process that registers it
+    auto destinations = directoryRanks( global_ids );
+    auto destinations_host = Kokkos::create_mirror_view( destinations );
+    Kokkos::deep_copy( destinations_host, destinations );
+    Tpetra::Distributor distributor( _comm );
+    int const n_imports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( destinations_host.data(), n ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+    Kokkos::View<int *, DeviceType> export_indices( "export_indices", n );
+    Iota<DeviceType> iota_functor( export_indices );
+    Kokkos::parallel_for( REGION_NAME( "set_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          iota_functor );
+    Kokkos::fence();
+
+    Kokkos::View<GlobalOrdinal *, DeviceType> import_ids( "global_ids",
+                                                          n_imports );
+    Kokkos::View<int *, DeviceType> import_ranks( "owner_ranks", n_imports );
+    Kokkos::View<int *, DeviceType> import_indices( "owner_indices",
+                                                    n_imports );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, global_ids, import_ids );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_ranks, import_ranks );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_indices, import_indices );
+
+    // sort the entries by global id and only keep the one from the process
+    // with the lowest rank when a global id is registered several times
+    auto import_ids_host = Kokkos::create_mirror_view( import_ids );
+    Kokkos::deep_copy( import_ids_host, import_ids );
+    auto import_ranks_host = Kokkos::create_mirror_view( import_ranks );
+    Kokkos::deep_copy( import_ranks_host, import_ranks );
+    auto import_indices_host = Kokkos::create_mirror_view( import_indices );
+    Kokkos::deep_copy( import_indices_host, import_indices );
+
+    std::vector<int> permute( n_imports );
+    std::iota( permute.begin(), permute.end(), 0 );
+    std::sort( permute.begin(), permute.end(), [&]( int i, int j ) {
+        return import_ids_host( i ) < import_ids_host( j ) ||
+               ( import_ids_host( i ) == import_ids_host( j ) &&
+                 import_ranks_host( i ) < import_ranks_host( j ) );
+    } );
+    permute.erase( std::unique( permute.begin(), permute.end(),
+                                [&]( int i, int j ) {
+                                    return import_ids_host( i ) ==
+                                           import_ids_host( j );
+                                } ),
+                   permute.end() );
+
+    int const n_entries = permute.size();
+    Kokkos::realloc( _global_ids, n_entries );
+    Kokkos::realloc( _owner_ranks, n_entries );
+    Kokkos::realloc( _owner_indices, n_entries );
+    auto global_ids_host = Kokkos::create_mirror_view( _global_ids );
+    auto owner_ranks_host = Kokkos::create_mirror_view( _owner_ranks );
+    auto owner_indices_host = Kokkos::create_mirror_view( _owner_indices );
+    for ( int i = 0; i < n_entries; ++i )
+    {
+        global_ids_host( i ) = import_ids_host( permute[i] );
+        owner_ranks_host( i ) = import_ranks_host( permute[i] );
+        owner_indices_host( i ) = import_indices_host( permute[i] );
+    }
+    Kokkos::deep_copy( _global_ids, global_ids_host );
+    Kokkos::deep_copy( _owner_ranks, owner_ranks_host );
+    Kokkos::deep_copy( _owner_indices, owner_indices_host );
+}
+
+template <typename DeviceType>
+void GlobalIdDirectory<DeviceType>::query(
+    Kokkos::View<GlobalOrdinal const *, DeviceType> global_ids,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<int *, DeviceType> &indices ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const comm_rank = _comm->getRank();
+    int const n = global_ids.extent( 0 );
+
+    // forward the requests to the processes that hold the entries
+    auto destinations = directoryRanks( global_ids );
+    auto destinations_host = Kokkos::create_mirror_view( destinations );
+    Kokkos::deep_copy( destinations_host, destinations );
+    Tpetra::Distributor distributor( _comm );
+    int const n_requests = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( destinations_host.data(), n ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+    Kokkos::View<int *, DeviceType> export_ids( "export_ids", n );
+    Iota<DeviceType> iota_functor( export_ids );
+    Kokkos::parallel_for( REGION_NAME( "set_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          iota_functor );
+    Kokkos::fence();
+
+    Kokkos::View<GlobalOrdinal *, DeviceType> requested_ids( "global_ids",
+                                                             n_requests );
+    Kokkos::View<int *, DeviceType> requesting_ranks( "requesting_ranks",
+                                                      n_requests );
+    Kokkos::View<int *, DeviceType> request_ids( "request_ids", n_requests );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, global_ids, requested_ids );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_ranks, requesting_ranks );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_ids, request_ids );
+
+    // look up the entries with a binary search
+    auto const entry_ids = _global_ids;
+    auto const entry_ranks = _owner_ranks;
+    auto const entry_indices = _owner_indices;
+    int const n_entries = entry_ids.extent( 0 );
+    Kokkos::View<int *, DeviceType> found_ranks( "found_ranks", n_requests );
+    Kokkos::View<int *, DeviceType> found_indices( "found_indices",
+                                                   n_requests );
+    Kokkos::parallel_for(
+        REGION_NAME( "look_up_entries" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_requests ),
+        KOKKOS_LAMBDA( int i ) {
+            GlobalOrdinal const id = requested_ids( i );
+            int first = 0;
+            int last = n_entries;
+            while ( first < last )
+            {
+                int const middle = first + ( last - first ) / 2;
+                if ( entry_ids( middle ) < id )
+                    first = middle + 1;
+                else
+                    last = middle;
+            }
+            bool const found = first < n_entries && entry_ids( first ) == id;
+            found_ranks( i ) = found ? entry_ranks( first ) : -1;
+            found_indices( i ) = found ? entry_indices( first ) : -1;
+        } );
+    Kokkos::fence();
+
+    // send the answers back to the processes that asked
+    auto requesting_ranks_host = Kokkos::create_mirror_view( requesting_ranks );
+    Kokkos::deep_copy( requesting_ranks_host, requesting_ranks );
+    Tpetra::Distributor reply_distributor( _comm );
+    reply_distributor.createFromSends( Teuchos::ArrayView<int const>(
+        requesting_ranks_host.data(), n_requests ) );
+
+    Kokkos::View<int *, DeviceType> reply_ranks( "reply_ranks", n );
+    Kokkos::View<int *, DeviceType> reply_indices( "reply_indices", n );
+    Kokkos::View<int *, DeviceType> reply_ids( "reply_ids", n );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        reply_distributor, found_ranks, reply_ranks );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        reply_distributor, found_indices, reply_indices );
+    Details::DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        reply_distributor, request_ids, reply_ids );
+
+    // the answers arrive grouped by directory process, put them back in the
+    // order of the global ids
+    Kokkos::realloc( ranks, n );
+    Kokkos::realloc( indices, n );
+    Kokkos::parallel_for( REGION_NAME( "scatter_answers" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          KOKKOS_LAMBDA( int i ) {
+                              ranks( reply_ids( i ) ) = reply_ranks( i );
+                              indices( reply_ids( i ) ) = reply_indices( i );
+                          } );
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+Kokkos::View<int *, DeviceType> GlobalIdDirectory<DeviceType>::directoryRanks(
+    Kokkos::View<GlobalOrdinal const *, DeviceType> global_ids ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    int const comm_size = _comm->getSize();
+    int const n = global_ids.extent( 0 );
+    Kokkos::View<int *, DeviceType> directory_ranks( "directory_ranks", n );
+    // Fibonacci hashing scatters contiguous ranges of global ids, which are
+    // the common case, over all the processes
+    Kokkos::parallel_for(
+        REGION_NAME( "hash_global_ids" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n ), KOKKOS_LAMBDA( int i ) {
+            GlobalOrdinal const hash =
+                global_ids( i ) * static_cast<GlobalOrdinal>(
+                                      11400714819323198485ull );
+            directory_ranks( i ) = ( hash >> 32 ) % comm_size;
+        } );
+    Kokkos::fence();
+    return directory_ranks;
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_GLOBALIDDIRECTORY_INSTANT( NODE )                                  \
+    template class GlobalIdDirectory<typename NODE::device_type>;
+
+#endif
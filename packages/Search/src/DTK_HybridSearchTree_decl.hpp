@@ -0,0 +1,152 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_HYBRID_SEARCH_TREE_DECL_HPP
+#define DTK_HYBRID_SEARCH_TREE_DECL_HPP
+
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+#include <DTK_LinearBVH.hpp>
+#include <DTK_SharedMemoryBVH.hpp>
+
+#include <Kokkos_View.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_config.h>
+
+#include "DTK_ConfigDefs.hpp"
+
+#ifdef HAVE_MPI
+
+namespace DataTransferKit
+{
+namespace Details
+{
+/**
+ * Top tree of a HybridSearchTree. It holds the bounds of the tree of every
+ * node and translates the nodes found into the rank of the process of that
+ * node which this process forwards its queries to.
+ */
+template <typename DeviceType>
+class NodeTopTree
+{
+  public:
+    NodeTopTree( Kokkos::View<Box const *, DeviceType> node_bounds,
+                 Kokkos::View<int *, DeviceType> destination_ranks )
+        : _bvh( node_bounds )
+        , _destination_ranks( destination_ranks )
+    {
+    }
+
+    // Same as BVH::query() except that indices(j) is the rank of a process.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset ) const
+    {
+        using ExecutionSpace = typename DeviceType::execution_space;
+
+        _bvh.query( queries, indices, offset );
+
+        auto const destination_ranks = _destination_ranks;
+        auto const node_indices = indices;
+        Kokkos::parallel_for(
+            REGION_NAME( "translate_nodes_into_ranks" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, indices.extent( 0 ) ),
+            KOKKOS_LAMBDA( int i ) {
+                node_indices( i ) = destination_ranks( node_indices( i ) );
+            } );
+        Kokkos::fence();
+    }
+
+  private:
+    BVH<DeviceType> _bvh;
+    Kokkos::View<int *, DeviceType> _destination_ranks;
+};
+} // end namespace Details
+
+/**
+ * Distributed search tree with a single bottom tree per shared-memory node
+ * instead of one per process. The objects of all the processes of a node are
+ * gathered on the first process of the node, which builds a SharedMemoryBVH
+ * that every process of the node searches in place. Each process searches
+ * the queries it is forwarded, and the processes of a node forward their
+ * queries to different processes of the other nodes so that the searches
+ * are spread over all of them. Running fewer processes per node with more
+ * threads each (e.g. with an OpenMP device) then yields fewer, larger trees
+ * and less communication between the top-level trees. Only available for
+ * devices that can access host memory.
+ */
+template <typename DeviceType>
+class HybridSearchTree
+{
+  public:
+    // Collective.
+    HybridSearchTree( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                      Kokkos::View<Box const *, DeviceType> bounding_boxes );
+
+    // Same as DistributedSearchTree::query(). ranks(j) is the rank in comm of
+    // the process that owns the object indices(j), which is its local index
+    // in the bounding boxes passed to the constructor on that process.
+    // Collective.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<int *, DeviceType> &ranks ) const;
+
+    // Number of processes sharing the tree of this process.
+    int getNodeSize() const { return _node_comm->getSize(); }
+
+    // Number of objects in the tree of the node.
+    size_t size() const { return _bottom_tree->size(); }
+
+  private:
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    // processes of the same node
+    Teuchos::RCP<Teuchos::Comm<int> const> _node_comm;
+    // owner of each object in the tree of the node
+    Kokkos::View<int *, DeviceType> _original_ranks;
+    Kokkos::View<int *, DeviceType> _original_indices;
+    Teuchos::RCP<SharedMemoryBVH<DeviceType>> _bottom_tree;
+    Teuchos::RCP<Details::NodeTopTree<DeviceType>> _top_tree;
+};
+
+template <typename DeviceType>
+template <typename Query>
+void HybridSearchTree<DeviceType>::query(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks ) const
+{
+    using Tag = typename Query::Tag;
+    Details::DistributedSearchTreeImpl<DeviceType>::queryDispatch(
+        _comm, *_top_tree, *_bottom_tree, queries, indices, offset, ranks,
+        Tag{} );
+
+    // The objects found are identified by their position in the tree of the
+    // node of the process that searched it, which knows their owners.
+    CommunicationPlan<DeviceType> plan( _comm, ranks, indices );
+    int const n_results = indices.extent( 0 );
+    Kokkos::View<int *, DeviceType> owner_ranks( ranks.label(), n_results );
+    Kokkos::View<int *, DeviceType> owner_indices( indices.label(),
+                                                   n_results );
+    plan.doExchange( _original_ranks, owner_ranks );
+    plan.doExchange( _original_indices, owner_indices );
+    ranks = owner_ranks;
+    indices = owner_indices;
+}
+
+} // end namespace DataTransferKit
+
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_HYBRID_SEARCH_TREE_DEF_HPP
+#define DTK_HYBRID_SEARCH_TREE_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DBC.hpp>
+#include <DTK_KokkosHelpers.hpp>
+
+#ifdef HAVE_MPI
+#include <Teuchos_ArrayView.hpp>
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_DefaultMpiComm.hpp>
+#include <Tpetra_Distributor.hpp>
+
+#include <mpi.h>
+
+#include <vector>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+HybridSearchTree<DeviceType>::HybridSearchTree(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Box const *, DeviceType> bounding_boxes )
+    : _comm( comm )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    using Impl = Details::DistributedSearchTreeImpl<DeviceType>;
+
+    int const comm_rank = _comm->getRank();
+    int const comm_size = _comm->getSize();
+    int const n = bounding_boxes.extent( 0 );
+
+    // the processes that share memory are identified by their lowest rank
+    auto mpi_comm =
+        Teuchos::rcp_dynamic_cast<Teuchos::MpiComm<int> const>( _comm );
+    DTK_INSIST( mpi_comm.get() != nullptr );
+    MPI_Comm raw_comm = *mpi_comm->getRawMpiComm();
+    MPI_Comm shared_comm;
+    MPI_Comm_split_type( raw_comm, MPI_COMM_TYPE_SHARED, comm_rank,
+                         MPI_INFO_NULL, &shared_comm );
+    int leader_rank;
+    MPI_Allreduce( &comm_rank, &leader_rank, 1, MPI_INT, MPI_MIN,
+                   shared_comm );
+    MPI_Comm_free( &shared_comm );
+    _node_comm = _comm->split( leader_rank, comm_rank );
+    int const node_rank = _node_comm->getRank();
+
+    // gather the objects of the node on its first process, which builds the
+    // tree shared by all the processes of the node
+    Tpetra::Distributor distributor( _node_comm );
+    std::vector<int> const leader( n, 0 );
+    int const n_imports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( leader.data(), n ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+    Kokkos::View<int *, DeviceType> export_indices( "export_indices", n );
+    Iota<DeviceType> iota_functor( export_indices );
+    Kokkos::parallel_for( REGION_NAME( "set_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          iota_functor );
+    Kokkos::fence();
+
+    Kokkos::View<Box *, DeviceType> node_boxes( "node_boxes", n_imports );
+    Kokkos::View<int *, DeviceType> node_ranks( "original_ranks", n_imports );
+    Kokkos::View<int *, DeviceType> node_indices( "original_indices",
+                                                  n_imports );
+    Impl::sendAcrossNetwork( distributor, bounding_boxes, node_boxes );
+    Impl::sendAcrossNetwork( distributor, export_ranks, node_ranks );
+    Impl::sendAcrossNetwork( distributor, export_indices, node_indices );
+
+    _bottom_tree =
+        Teuchos::rcp( new SharedMemoryBVH<DeviceType>( _comm, node_boxes ) );
+
+    // every process of the node needs the owners of the objects to report
+    // the results of the searches it performs, the views are in host memory
+    // like the shared tree
+    int const n_node_objects = _bottom_tree->size();
+    _original_ranks =
+        Kokkos::View<int *, DeviceType>( "original_ranks", n_node_objects );
+    _original_indices =
+        Kokkos::View<int *, DeviceType>( "original_indices", n_node_objects );
+    if ( node_rank == 0 )
+    {
+        Kokkos::deep_copy( _original_ranks, node_ranks );
+        Kokkos::deep_copy( _original_indices, node_indices );
+    }
+    Teuchos::broadcast( *_node_comm, 0, n_node_objects,
+                        _original_ranks.data() );
+    Teuchos::broadcast( *_node_comm, 0, n_node_objects,
+                        _original_indices.data() );
+
+    // The top tree holds the bounds of the tree of every node. This process
+    // forwards its queries to the process that has the same rank within its
+    // node modulo the size of the node, so that the processes of a node
+    // search the queries of distinct processes.
+    std::vector<int> leader_ranks( comm_size );
+    Teuchos::gatherAll( *_comm, 1, &leader_rank, comm_size,
+                        leader_ranks.data() );
+    auto const bounds =
+        Impl::gatherBoundingBoxes( *_comm, _bottom_tree->bounds() );
+    auto bounds_host = Kokkos::create_mirror_view( bounds );
+    Kokkos::deep_copy( bounds_host, bounds );
+
+    // processes of each node sorted by rank, the first one is the leader
+    std::vector<std::vector<int>> node_processes;
+    std::vector<int> node_ids( comm_size );
+    for ( int rank = 0; rank < comm_size; ++rank )
+    {
+        if ( leader_ranks[rank] == rank )
+        {
+            node_ids[rank] = node_processes.size();
+            node_processes.emplace_back();
+        }
+        node_processes[node_ids[leader_ranks[rank]]].push_back( rank );
+    }
+
+    int const n_nodes = node_processes.size();
+    Kokkos::View<Box *, DeviceType> node_bounds( "node_bounds", n_nodes );
+    Kokkos::View<int *, DeviceType> destination_ranks( "destination_ranks",
+                                                       n_nodes );
+    auto node_bounds_host = Kokkos::create_mirror_view( node_bounds );
+    auto destination_ranks_host =
+        Kokkos::create_mirror_view( destination_ranks );
+    for ( int i = 0; i < n_nodes; ++i )
+    {
+        auto const &processes = node_processes[i];
+        node_bounds_host( i ) = bounds_host( processes[0] );
+        destination_ranks_host( i ) = processes[node_rank % processes.size()];
+    }
+    Kokkos::deep_copy( node_bounds, node_bounds_host );
+    Kokkos::deep_copy( destination_ranks, destination_ranks_host );
+    _top_tree = Teuchos::rcp( new Details::NodeTopTree<DeviceType>(
+        node_bounds, destination_ranks ) );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_HYBRIDSEARCHTREE_INSTANT( NODE )                                   \
+    template class HybridSearchTree<typename NODE::device_type>;
+
+#else
+
+#define DTK_HYBRIDSEARCHTREE_INSTANT( NODE )
+
+#endif
+
+#endif
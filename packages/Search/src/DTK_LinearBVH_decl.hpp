@@ -15,20 +15,49 @@
 #include <Kokkos_View.hpp>
 
 #include <DTK_DetailsAlgorithms.hpp>
+#include <DTK_DetailsBatchedQueries.hpp>
 #include <DTK_DetailsBox.hpp>
 #include <DTK_DetailsNode.hpp>
 #include <DTK_DetailsPredicate.hpp>
 
 #include "DTK_ConfigDefs.hpp"
 
+#include <type_traits>
+
 namespace DataTransferKit
 {
 namespace Details
 {
 template <typename DeviceType>
 struct TreeTraversal;
+
+// Callback that stores the objects found at their position in the compressed
+// row storage. The distances are only stored if the view is allocated.
+template <typename DeviceType>
+struct StoreResults
+{
+    KOKKOS_INLINE_FUNCTION void operator()( int index ) const
+    {
+        _indices( _offset + _count++ ) = index;
+    }
+
+    KOKKOS_INLINE_FUNCTION void operator()( int index, double distance ) const
+    {
+        if ( _distances.extent( 0 ) > 0 )
+            _distances( _offset + _count ) = distance;
+        _indices( _offset + _count++ ) = index;
+    }
+
+    Kokkos::View<int *, DeviceType> _indices;
+    Kokkos::View<double *, DeviceType> _distances;
+    int const _offset;
+    int &_count;
+};
 }
 
+template <typename DeviceType>
+class SharedMemoryBVH;
+
 /**
  * Bounding Volume Hierarchy.
  */
@@ -39,14 +68,55 @@ struct BVH
     BVH( Kokkos::View<Box const *, DeviceType> bounding_boxes );
 
     // Views are passed by reference here because Kokkos::resize() effectively
-    // calls the assignment operator.
+    // calls the assignment operator. The queries may be of type
+    // Details::PredicateVariant to mix several kinds of predicates in a single
+    // batch. The results are always stored in the order of the queries.
     template <typename Query>
     void query( Kokkos::View<Query *, DeviceType> queries,
                 Kokkos::View<int *, DeviceType> &indices,
                 Kokkos::View<int *, DeviceType> &offset ) const;
 
+    // Same as above but also returns the distance from the query geometry to
+    // each object found. Only applies to nearest queries.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<double *, DeviceType> &distances ) const;
+
+    // Any-hit query. Only tells whether at least one object meets the
+    // predicate, which lets the traversal terminate on the first accepted
+    // leaf and avoids building the compressed row storage.
+    template <typename Query>
+    void queryAny( Kokkos::View<Query *, DeviceType> queries,
+                   Kokkos::View<bool *, DeviceType> &found ) const;
+
+    // Number of objects stored in the hierarchy.
+    KOKKOS_INLINE_FUNCTION
+    size_t size() const { return _leaf_nodes.extent( 0 ); }
+
+    KOKKOS_INLINE_FUNCTION
+    bool empty() const { return size() == 0; }
+
+    // Bounding box of the scene. It is "empty" (i.e. it does not overlap with
+    // anything) if the hierarchy does not store any object.
+    KOKKOS_INLINE_FUNCTION
+    Box const &bounds() const { return _bounds; }
+
   private:
     friend struct Details::TreeTraversal<DeviceType>;
+    friend class SharedMemoryBVH<DeviceType>;
+
+    // Only used to wrap a hierarchy that lives in memory allocated elsewhere.
+    BVH() = default;
+
+    template <typename Query>
+    void queryImpl( Kokkos::View<Query *, DeviceType> queries,
+                    Kokkos::View<int *, DeviceType> &indices,
+                    Kokkos::View<int *, DeviceType> &offset,
+                    Kokkos::View<double *, DeviceType> *distances ) const;
+
+    Box _bounds;
 
     Kokkos::View<Node *, DeviceType> _leaf_nodes;
     Kokkos::View<Node *, DeviceType> _internal_nodes;
@@ -63,6 +133,31 @@ template <typename Query>
 void BVH<DeviceType>::query( Kokkos::View<Query *, DeviceType> queries,
                              Kokkos::View<int *, DeviceType> &indices,
                              Kokkos::View<int *, DeviceType> &offset ) const
+{
+    queryImpl( queries, indices, offset, nullptr );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void BVH<DeviceType>::query(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<double *, DeviceType> &distances ) const
+{
+    static_assert( std::is_same<typename Query::Tag,
+                                Details::NearestPredicateTag>::value,
+                   "distances are only reported for nearest queries" );
+    queryImpl( queries, indices, offset, &distances );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void BVH<DeviceType>::queryImpl(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<double *, DeviceType> *distances ) const
 {
     using ExecutionSpace = typename DeviceType::execution_space;
 
@@ -85,6 +180,11 @@ void BVH<DeviceType>::query( Kokkos::View<Query *, DeviceType> queries,
     // it will throw illegal address error in the parallel_for loops below.
     BVH<DeviceType> bvh = *this;
 
+    // Group the queries by kind. Thread i processes query permute(i) and the
+    // results are written at the position of that query.
+    auto const permute =
+        details::BatchedQueries<DeviceType>::sortQueriesByKind( queries );
+
     // Say we found exactly two object for each query:
     // [ 2 2 2 .... 2 0 ]
     //   ^            ^
@@ -93,8 +193,9 @@ void BVH<DeviceType>::query( Kokkos::View<Query *, DeviceType> queries,
         REGION_NAME( "first_pass_at_the_search_count_the_number_of_indices" ),
         Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
         KOKKOS_LAMBDA( int i ) {
-            offset( i ) = details::TreeTraversal<DeviceType>::query(
-                bvh, queries( i ), []( int index ) {} );
+            int const q = permute( i );
+            offset( q ) = details::TreeTraversal<DeviceType>::query(
+                bvh, queries( q ), []( int index ) {} );
         } );
     Kokkos::fence();
 
@@ -125,20 +226,52 @@ void BVH<DeviceType>::query( Kokkos::View<Query *, DeviceType> queries,
     //   ^     ^     ^         ^     ^
     //   0     2     4         2N-2  2N
     Kokkos::deep_copy( total_count_host, total_count );
-    Kokkos::resize( indices, total_count( 0 ) );
+    Kokkos::resize( indices, total_count_host( 0 ) );
+    Kokkos::View<double *, DeviceType> distances_found( "distances" );
+    if ( distances != nullptr )
+    {
+        Kokkos::resize( *distances, total_count_host( 0 ) );
+        distances_found = *distances;
+    }
     Kokkos::parallel_for( REGION_NAME( "second_pass" ),
                           Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
                           KOKKOS_LAMBDA( int i ) {
+                              int const q = permute( i );
                               int count = 0;
                               details::TreeTraversal<DeviceType>::query(
-                                  bvh, queries( i ),
-                                  [indices, offset, i, &count]( int index ) {
-                                      indices( offset( i ) + count++ ) = index;
-                                  } );
+                                  bvh, queries( q ),
+                                  details::StoreResults<DeviceType>{
+                                      indices, distances_found, offset( q ),
+                                      count} );
                           } );
     Kokkos::fence();
 }
 
+template <typename DeviceType>
+template <typename Query>
+void BVH<DeviceType>::queryAny( Kokkos::View<Query *, DeviceType> queries,
+                                Kokkos::View<bool *, DeviceType> &found ) const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    namespace details = DataTransferKit::Details;
+
+    int const n_queries = queries.extent( 0 );
+
+    Kokkos::realloc( found, n_queries );
+
+    BVH<DeviceType> bvh = *this;
+
+    Kokkos::parallel_for(
+        REGION_NAME( "any_hit" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int i ) {
+            found( i ) = details::TreeTraversal<DeviceType>::queryAny(
+                bvh, queries( i ) );
+        } );
+    Kokkos::fence();
+}
+
 } // end namespace DataTransferKit
 
 #endif
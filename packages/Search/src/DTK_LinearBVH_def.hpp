@@ -50,21 +50,28 @@ class SetBoundingBoxesFunctor
 
 template <typename DeviceType>
 BVH<DeviceType>::BVH( Kokkos::View<Box const *, DeviceType> bounding_boxes )
-    : _leaf_nodes( "leaf_nodes", bounding_boxes.extent( 0 ) )
-    , _internal_nodes( "internal_nodes", bounding_boxes.extent( 0 ) - 1 )
-    , _indices( "sorted_indices", bounding_boxes.extent( 0 ) )
+    : _indices( "sorted_indices", bounding_boxes.extent( 0 ) )
 {
     using ExecutionSpace = typename DeviceType::execution_space;
 
+    int const n = bounding_boxes.extent( 0 );
+    if ( n == 0 )
+        return;
+
+    // internal nodes and leaves are stored contiguously
+    Kokkos::View<Node *, DeviceType> nodes( "nodes", 2 * n - 1 );
+    _internal_nodes = Kokkos::subview( nodes, Kokkos::make_pair( 0, n - 1 ) );
+    _leaf_nodes =
+        Kokkos::subview( nodes, Kokkos::make_pair( n - 1, 2 * n - 1 ) );
+
     // determine the bounding box of the scene
     Details::TreeConstruction<DeviceType>::calculateBoundingBoxOfTheScene(
-        bounding_boxes, _internal_nodes[0].bounding_box );
+        bounding_boxes, _bounds );
 
     // calculate morton code of all objects
-    int const n = bounding_boxes.extent( 0 );
     Kokkos::View<unsigned int *, DeviceType> morton_indices( "morton", n );
     Details::TreeConstruction<DeviceType>::assignMortonCodes(
-        bounding_boxes, morton_indices, _internal_nodes[0].bounding_box );
+        bounding_boxes, morton_indices, _bounds );
 
     // sort them along the Z-order space-filling curve
     Iota<DeviceType> iota_functor( _indices );
@@ -82,6 +89,11 @@ BVH<DeviceType>::BVH( Kokkos::View<Box const *, DeviceType> bounding_boxes )
                           Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
                           set_bounding_boxes_functor );
     Kokkos::fence();
+
+    // a single leaf is the root of the hierarchy
+    if ( n == 1 )
+        return;
+
     Details::TreeConstruction<DeviceType>::generateHierarchy(
         morton_indices, _leaf_nodes, _internal_nodes );
 
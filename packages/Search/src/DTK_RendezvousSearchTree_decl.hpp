@@ -0,0 +1,99 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_RENDEZVOUS_SEARCH_TREE_DECL_HPP
+#define DTK_RENDEZVOUS_SEARCH_TREE_DECL_HPP
+
+#include <DTK_CommunicationPlan.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DistributedSearchTree.hpp>
+
+#include <Kokkos_View.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include "DTK_ConfigDefs.hpp"
+
+namespace DataTransferKit
+{
+/**
+ * Search tree built on a rendezvous decomposition of the objects. The
+ * objects are redistributed so that every process owns a contiguous range of
+ * the Z-order curve holding approximately the same number of objects,
+ * regardless of how they were initially distributed. The search is performed
+ * on that balanced decomposition and the results are mapped back to the
+ * original owners of the objects.
+ */
+template <typename DeviceType>
+class RendezvousSearchTree
+{
+  public:
+    RendezvousSearchTree(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm,
+        Kokkos::View<Box const *, DeviceType> bounding_boxes );
+
+    // Same as DistributedSearchTree::query(). ranks(j) is the rank of the
+    // process that originally owned the object indices(j), which is its local
+    // index in the bounding boxes passed to the constructor on that process.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<int *, DeviceType> &ranks ) const;
+
+    // Same as above but also returns the distances for nearest queries.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<int *, DeviceType> &ranks,
+                Kokkos::View<double *, DeviceType> &distances ) const;
+
+    // Number of objects assigned to this process in the rendezvous
+    // decomposition.
+    size_t size() const { return _original_ranks.extent( 0 ); }
+
+  private:
+    void mapToOriginalOwners( Kokkos::View<int *, DeviceType> &indices,
+                              Kokkos::View<int *, DeviceType> &ranks ) const;
+
+    Teuchos::RCP<Teuchos::Comm<int> const> _comm;
+    Kokkos::View<int *, DeviceType> _original_ranks;
+    Kokkos::View<int *, DeviceType> _original_indices;
+    DistributedSearchTree<DeviceType> _tree;
+};
+
+template <typename DeviceType>
+template <typename Query>
+void RendezvousSearchTree<DeviceType>::query(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks ) const
+{
+    _tree.query( queries, indices, offset, ranks );
+    mapToOriginalOwners( indices, ranks );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void RendezvousSearchTree<DeviceType>::query(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<double *, DeviceType> &distances ) const
+{
+    _tree.query( queries, indices, offset, ranks, distances );
+    mapToOriginalOwners( indices, ranks );
+}
+
+} // end namespace DataTransferKit
+
+#endif
@@ -0,0 +1,60 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_RENDEZVOUS_SEARCH_TREE_DEF_HPP
+#define DTK_RENDEZVOUS_SEARCH_TREE_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DetailsRendezvousImpl.hpp>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+RendezvousSearchTree<DeviceType>::RendezvousSearchTree(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Box const *, DeviceType> bounding_boxes )
+    : _comm( comm )
+    , _original_ranks( "original_ranks" )
+    , _original_indices( "original_indices" )
+    , _tree( comm, Details::RendezvousImpl<DeviceType>::repartition(
+                       comm, bounding_boxes, _original_ranks,
+                       _original_indices ) )
+{
+}
+
+template <typename DeviceType>
+void RendezvousSearchTree<DeviceType>::mapToOriginalOwners(
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &ranks ) const
+{
+    // the objects found are identified by their position in the rendezvous
+    // decomposition, fetch the original owner from the process that was
+    // assigned the object
+    CommunicationPlan<DeviceType> plan( _comm, ranks, indices );
+
+    Kokkos::View<int *, DeviceType> original_ranks( ranks.label(),
+                                                    plan.getNumImports() );
+    Kokkos::View<int *, DeviceType> original_indices( indices.label(),
+                                                      plan.getNumImports() );
+    plan.doExchange( _original_ranks, original_ranks );
+    plan.doExchange( _original_indices, original_indices );
+
+    ranks = original_ranks;
+    indices = original_indices;
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_RENDEZVOUSSEARCHTREE_INSTANT( NODE )                               \
+    template class RendezvousSearchTree<typename NODE::device_type>;
+
+#endif
@@ -0,0 +1,104 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_SHARED_MEMORY_BVH_DECL_HPP
+#define DTK_SHARED_MEMORY_BVH_DECL_HPP
+
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsTreeTraversal.hpp>
+#include <DTK_LinearBVH.hpp>
+
+#include <Kokkos_View.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_config.h>
+
+#include "DTK_ConfigDefs.hpp"
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+
+#include <type_traits>
+
+namespace DataTransferKit
+{
+/**
+ * Bounding volume hierarchy shared by all the processes running on the same
+ * node. A single process per node builds the hierarchy into an MPI-3 shared
+ * memory window and the other processes query it in place instead of
+ * holding a copy of their own. This is only possible when the device can
+ * access host memory.
+ */
+template <typename DeviceType>
+class SharedMemoryBVH
+{
+    static_assert( std::is_same<typename DeviceType::memory_space,
+                                Kokkos::HostSpace>::value,
+                   "the shared memory window lives in host memory" );
+
+  public:
+    // Only the bounding boxes of the first process on each node are used to
+    // build the hierarchy, the ones passed by the other processes are ignored
+    // and may be empty. Collective.
+    SharedMemoryBVH( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                     Kokkos::View<Box const *, DeviceType> bounding_boxes );
+
+    // Frees the shared memory window. Collective over the processes of the
+    // node.
+    ~SharedMemoryBVH();
+
+    SharedMemoryBVH( SharedMemoryBVH const & ) = delete;
+    SharedMemoryBVH &operator=( SharedMemoryBVH const & ) = delete;
+
+    // Same as BVH::query().
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset ) const
+    {
+        _bvh.query( queries, indices, offset );
+    }
+
+    // Same as BVH::query() with distances.
+    template <typename Query>
+    void query( Kokkos::View<Query *, DeviceType> queries,
+                Kokkos::View<int *, DeviceType> &indices,
+                Kokkos::View<int *, DeviceType> &offset,
+                Kokkos::View<double *, DeviceType> &distances ) const
+    {
+        _bvh.query( queries, indices, offset, distances );
+    }
+
+    // Same as BVH::queryAny().
+    template <typename Query>
+    void queryAny( Kokkos::View<Query *, DeviceType> queries,
+                   Kokkos::View<bool *, DeviceType> &found ) const
+    {
+        _bvh.queryAny( queries, found );
+    }
+
+    size_t size() const { return _bvh.size(); }
+
+    bool empty() const { return _bvh.empty(); }
+
+    Box const &bounds() const { return _bvh.bounds(); }
+
+  private:
+    // processes that can access the same shared memory
+    MPI_Comm _node_comm;
+    MPI_Win _window;
+    // hierarchy wrapping the memory of the window
+    BVH<DeviceType> _bvh;
+};
+
+} // end namespace DataTransferKit
+
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#ifndef DTK_SHARED_MEMORY_BVH_DEF_HPP
+#define DTK_SHARED_MEMORY_BVH_DEF_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DBC.hpp>
+
+#ifdef HAVE_MPI
+#include <Teuchos_DefaultMpiComm.hpp>
+
+#include <cstring>
+
+namespace DataTransferKit
+{
+
+template <typename DeviceType>
+SharedMemoryBVH<DeviceType>::SharedMemoryBVH(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Box const *, DeviceType> bounding_boxes )
+{
+    auto mpi_comm =
+        Teuchos::rcp_dynamic_cast<Teuchos::MpiComm<int> const>( comm );
+    DTK_INSIST( mpi_comm.get() != nullptr );
+    MPI_Comm raw_comm = *mpi_comm->getRawMpiComm();
+    MPI_Comm_split_type( raw_comm, MPI_COMM_TYPE_SHARED, comm->getRank(),
+                         MPI_INFO_NULL, &_node_comm );
+    int node_rank;
+    MPI_Comm_rank( _node_comm, &node_rank );
+
+    // The window holds the bounds of the scene, followed by all the nodes
+    // (internal nodes first, then leaves) and the permutation indices. The
+    // nodes do not store pointers so the hierarchy is valid regardless of
+    // the address at which each process maps the window.
+    BVH<DeviceType> local_bvh;
+    if ( node_rank == 0 )
+        local_bvh = BVH<DeviceType>( bounding_boxes );
+    int n = local_bvh.size();
+    MPI_Bcast( &n, 1, MPI_INT, 0, _node_comm );
+    int const n_nodes = n > 0 ? 2 * n - 1 : 0;
+    size_t const nodes_offset = sizeof( Box );
+    size_t const indices_offset = nodes_offset + n_nodes * sizeof( Node );
+    size_t const window_size = indices_offset + n * sizeof( int );
+
+    char *base = nullptr;
+    MPI_Win_allocate_shared( node_rank == 0 ? window_size : 0, 1,
+                             MPI_INFO_NULL, _node_comm, &base, &_window );
+    if ( node_rank != 0 )
+    {
+        MPI_Aint size;
+        int disp_unit;
+        MPI_Win_shared_query( _window, 0, &size, &disp_unit, &base );
+    }
+
+    if ( node_rank == 0 )
+    {
+        std::memcpy( base, &local_bvh._bounds, sizeof( Box ) );
+        if ( n > 0 )
+        {
+            // the leaves are stored right after the internal nodes
+            std::memcpy( base + nodes_offset, local_bvh._internal_nodes.data(),
+                         n_nodes * sizeof( Node ) );
+            std::memcpy( base + indices_offset, local_bvh._indices.data(),
+                         n * sizeof( int ) );
+        }
+    }
+    // make the hierarchy visible to all the processes of the node
+    MPI_Win_fence( 0, _window );
+
+    _bvh._bounds = *reinterpret_cast<Box *>( base );
+    Node *nodes = reinterpret_cast<Node *>( base + nodes_offset );
+    _bvh._internal_nodes =
+        Kokkos::View<Node *, DeviceType>( nodes, n > 0 ? n - 1 : 0 );
+    _bvh._leaf_nodes = Kokkos::View<Node *, DeviceType>(
+        n > 0 ? nodes + n - 1 : nodes, n );
+    _bvh._indices = Kokkos::View<int *, DeviceType>(
+        reinterpret_cast<int *>( base + indices_offset ), n );
+}
+
+template <typename DeviceType>
+SharedMemoryBVH<DeviceType>::~SharedMemoryBVH()
+{
+    MPI_Win_free( &_window );
+    MPI_Comm_free( &_node_comm );
+}
+
+} // end namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_SHAREDMEMORYBVH_INSTANT( NODE )                                    \
+    template class SharedMemoryBVH<typename NODE::device_type>;
+
+#else
+
+#define DTK_SHAREDMEMORYBVH_INSTANT( NODE )
+
+#endif
+
+#endif
@@ -49,6 +49,25 @@ double distance( Point const &point, Box const &box )
     return distance( point, projected_point );
 }
 
+// distance box-box
+KOKKOS_INLINE_FUNCTION
+double distance( Box const &box, Box const &other )
+{
+    double distance_squared = 0.0;
+    for ( int d = 0; d < 3; ++d )
+    {
+        // gap between the two boxes along that direction, zero if their
+        // projections intersect
+        double tmp = 0.0;
+        if ( box[2 * d + 0] > other[2 * d + 1] )
+            tmp = box[2 * d + 0] - other[2 * d + 1];
+        else if ( other[2 * d + 0] > box[2 * d + 1] )
+            tmp = other[2 * d + 0] - box[2 * d + 1];
+        distance_squared += tmp * tmp;
+    }
+    return std::sqrt( distance_squared );
+}
+
 // expand an axis-aligned bounding box to include a point
 void expand( Box &box, Point const &point );
 
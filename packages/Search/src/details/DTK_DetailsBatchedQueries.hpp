@@ -0,0 +1,104 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_BATCHED_QUERIES_HPP
+#define DTK_DETAILS_BATCHED_QUERIES_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DetailsPredicate.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <type_traits>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+/**
+ * Utilities to reorder a batch of queries before traversing the tree. All the
+ * functions are static.
+ */
+template <typename DeviceType>
+struct BatchedQueries
+{
+  public:
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // Permutation of the batches that hold a single kind of predicates, no
+    // need to allocate and fill a view for these.
+    struct Identity
+    {
+        KOKKOS_INLINE_FUNCTION
+        int operator()( int i ) const { return i; }
+    };
+
+    // Return the order in which the queries should be processed, i.e. the
+    // i-th thread handles query permute(i). Batches that mix several kinds
+    // of predicates are grouped by kind so that threads that run
+    // concurrently follow the same traversal algorithm.
+    template <typename Query>
+    static typename std::conditional<
+        std::is_same<typename Query::Tag, VariantPredicateTag>::value,
+        Kokkos::View<int *, DeviceType>, Identity>::type
+    sortQueriesByKind( Kokkos::View<Query *, DeviceType> queries )
+    {
+        using Tag = typename Query::Tag;
+        return sortQueriesByKindDispatch( queries, Tag{} );
+    }
+
+  private:
+    template <typename Query, typename Tag>
+    static Identity
+    sortQueriesByKindDispatch( Kokkos::View<Query *, DeviceType>, Tag )
+    {
+        return Identity{};
+    }
+
+    template <typename Query>
+    static Kokkos::View<int *, DeviceType>
+    sortQueriesByKindDispatch( Kokkos::View<Query *, DeviceType> queries,
+                               VariantPredicateTag )
+    {
+        int const n_queries = queries.extent( 0 );
+
+        int n_first = 0;
+        Kokkos::parallel_reduce(
+            REGION_NAME( "count_first_alternative" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+            KOKKOS_LAMBDA( int i, int &update ) {
+                if ( queries( i ).index() == 0 )
+                    ++update;
+            },
+            n_first );
+        Kokkos::fence();
+
+        // Stable partition: queries holding the first alternative go first.
+        // At position i, update is the number of such queries before i so
+        // that i - update queries holding the second alternative precede it.
+        Kokkos::View<int *, DeviceType> permute( "permute", n_queries );
+        Kokkos::parallel_scan(
+            REGION_NAME( "partition_by_kind" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+            KOKKOS_LAMBDA( int i, int &update, bool final_pass ) {
+                bool const is_first = ( queries( i ).index() == 0 );
+                if ( final_pass )
+                    permute( is_first ? update : n_first + i - update ) = i;
+                if ( is_first )
+                    ++update;
+            } );
+        Kokkos::fence();
+        return permute;
+    }
+};
+
+} // end namespace Details
+} // end namespace DataTransferKit
+
+#endif
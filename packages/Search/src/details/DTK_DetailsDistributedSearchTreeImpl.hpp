@@ -0,0 +1,1012 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_DISTRIBUTED_SEARCH_TREE_IMPL_HPP
+#define DTK_DETAILS_DISTRIBUTED_SEARCH_TREE_IMPL_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsPredicate.hpp>
+#include <DTK_DetailsTreeTraversal.hpp>
+#include <DTK_LinearBVH.hpp>
+
+#include <DTK_KokkosHelpers.hpp>
+
+#include <Kokkos_ArithTraits.hpp>
+#include <Kokkos_Atomic.hpp>
+#include <Kokkos_Core.hpp>
+#include <Teuchos_ArrayView.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_Time.hpp>
+#include <Teuchos_config.h>
+#include <Tpetra_Distributor.hpp>
+
+#ifdef HAVE_MPI
+#include <Teuchos_DefaultMpiComm.hpp>
+#endif
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace DataTransferKit
+{
+/**
+ * Wall-clock time in seconds spent by a process in each stage of a
+ * pipelined distributed query. The times are accumulated over successive
+ * queries.
+ */
+struct QueryPipelineTimings
+{
+    // search of the top tree for the processes to send the queries to
+    double find_destinations = 0.;
+    // packing of the queries and posting of the messages
+    double post_communication = 0.;
+    // search of the local tree
+    double local_search = 0.;
+    // time blocked waiting for messages to complete
+    double wait = 0.;
+    // assembly of the compressed row storage of the results
+    double sort_results = 0.;
+};
+
+namespace Details
+{
+/**
+ * This structure contains all the functions used to perform queries on a
+ * DistributedSearchTree. All the functions are static.
+ */
+template <typename DeviceType>
+struct DistributedSearchTreeImpl
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // Gather the bounding box of the scene of every process. The i-th box is
+    // the one of the process of rank i.
+    static Kokkos::View<Box *, DeviceType>
+    gatherBoundingBoxes( Teuchos::Comm<int> const &comm, Box const &box );
+
+    // The trees only need to provide the query() member functions of BVH.
+    // The indices found in the top tree are the ranks of the processes to
+    // forward the queries to.
+    template <typename TopTree, typename BottomTree, typename Query>
+    static void queryDispatch( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                               TopTree const &top_tree,
+                               BottomTree const &bottom_tree,
+                               Kokkos::View<Query *, DeviceType> queries,
+                               Kokkos::View<int *, DeviceType> &indices,
+                               Kokkos::View<int *, DeviceType> &offset,
+                               Kokkos::View<int *, DeviceType> &ranks,
+                               SpatialPredicateTag );
+
+    // Same as the spatial queryDispatch() but the queries are shipped and
+    // searched in chunks, one per pair of processes, with nonblocking
+    // point-to-point communication. The chunk a process sends to itself is
+    // searched right away and every other chunk as soon as it arrives, while
+    // the remaining messages are still in flight. The results of a chunk are
+    // sent back as soon as they are available.
+    template <typename Query>
+    static void
+    pipelinedQueryDispatch( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                            BVH<DeviceType> const &top_tree,
+                            BVH<DeviceType> const &bottom_tree,
+                            Kokkos::View<Query *, DeviceType> queries,
+                            Kokkos::View<int *, DeviceType> &indices,
+                            Kokkos::View<int *, DeviceType> &offset,
+                            Kokkos::View<int *, DeviceType> &ranks,
+                            QueryPipelineTimings &timings );
+
+    // The nearest search proceeds in two phases. First, the queries are sent
+    // to the processes whose scene boxes are the closest, which own at
+    // least k objects unless there are fewer than k objects overall. The
+    // distance to the k-th object found bounds the distance to the true
+    // k-th nearest neighbor. Then the queries are sent to the remaining
+    // processes whose scene box lies within that radius, and the results of
+    // both phases are merged to keep the k closest objects.
+    template <typename TopTree, typename BottomTree, typename Geometry>
+    static void
+    queryDispatch( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                   TopTree const &top_tree, BottomTree const &bottom_tree,
+                   Kokkos::View<Nearest<Geometry> *, DeviceType> queries,
+                   Kokkos::View<int *, DeviceType> &indices,
+                   Kokkos::View<int *, DeviceType> &offset,
+                   Kokkos::View<int *, DeviceType> &ranks,
+                   Kokkos::View<double *, DeviceType> &distances,
+                   NearestPredicateTag );
+
+    template <typename TopTree, typename BottomTree, typename Geometry>
+    static void
+    queryDispatch( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                   TopTree const &top_tree, BottomTree const &bottom_tree,
+                   Kokkos::View<Nearest<Geometry> *, DeviceType> queries,
+                   Kokkos::View<int *, DeviceType> &indices,
+                   Kokkos::View<int *, DeviceType> &offset,
+                   Kokkos::View<int *, DeviceType> &ranks,
+                   NearestPredicateTag tag )
+    {
+        Kokkos::View<double *, DeviceType> distances( "distances" );
+        queryDispatch( comm, top_tree, bottom_tree, queries, indices, offset,
+                       ranks, distances, tag );
+    }
+
+    // Send query(q) to all the processes listed in indices[offset(q),
+    // offset(q+1)). On return, fwd_queries holds the queries received from
+    // other processes, fwd_ids their position in the batch of the process
+    // that sent them, and fwd_ranks the rank of that process.
+    template <typename Query>
+    static void
+    forwardQueries( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                    Kokkos::View<Query *, DeviceType> queries,
+                    Kokkos::View<int *, DeviceType> indices,
+                    Kokkos::View<int *, DeviceType> offset,
+                    Kokkos::View<Query *, DeviceType> &fwd_queries,
+                    Kokkos::View<int *, DeviceType> &fwd_ids,
+                    Kokkos::View<int *, DeviceType> &fwd_ranks );
+
+    // Return the results of the forwarded queries to the processes that
+    // sent them. On entry, indices and offset are the local results of the
+    // queries identified by ids and ranks. On exit, the views are flat arrays
+    // of the results received for the local queries: the object local index,
+    // the rank of its owner and the query position in the local batch.
+    // offset is left unchanged. The distances are sent along if provided.
+    static void communicateResultsBack(
+        Teuchos::RCP<Teuchos::Comm<int> const> comm,
+        Kokkos::View<int *, DeviceType> &indices,
+        Kokkos::View<int *, DeviceType> offset,
+        Kokkos::View<int *, DeviceType> &ranks,
+        Kokkos::View<int *, DeviceType> &ids,
+        Kokkos::View<double *, DeviceType> *distances );
+
+    // Group the results by query to build the compressed row storage.
+    static void sortResults( int n_queries, Kokkos::View<int *, DeviceType> ids,
+                             Kokkos::View<int *, DeviceType> &indices,
+                             Kokkos::View<int *, DeviceType> &offset,
+                             Kokkos::View<int *, DeviceType> &ranks,
+                             Kokkos::View<double *, DeviceType> *distances );
+
+    // Remove from the lists of processes to send the queries to those that
+    // have already been sent the same query.
+    static void
+    excludeRanks( Kokkos::View<int *, DeviceType> excluded_ranks,
+                  Kokkos::View<int *, DeviceType> excluded_offset,
+                  Kokkos::View<int *, DeviceType> &ranks,
+                  Kokkos::View<int *, DeviceType> &offset );
+
+    // Only keep the k closest objects for each query, sorted by distance.
+    template <typename Query>
+    static void filterResults( Kokkos::View<Query *, DeviceType> queries,
+                               Kokkos::View<double *, DeviceType> &distances,
+                               Kokkos::View<int *, DeviceType> &indices,
+                               Kokkos::View<int *, DeviceType> &offset,
+                               Kokkos::View<int *, DeviceType> &ranks );
+
+    // Predicates to test against the scene boxes of the processes in the
+    // top tree, see relax().
+    template <typename Query>
+    static Kokkos::View<decltype( relax( std::declval<Query>() ) ) *,
+                        DeviceType>
+    relaxQueries( Kokkos::View<Query *, DeviceType> queries );
+
+    // Exchange data according to the communication plan of the distributor.
+    // The value type does not need to be serializable by Teuchos since the
+    // data is shipped as raw bytes.
+    template <typename View>
+    static void sendAcrossNetwork( Tpetra::Distributor &distributor,
+                                   View exports,
+                                   typename View::non_const_type imports );
+};
+
+template <typename DeviceType>
+Kokkos::View<Box *, DeviceType>
+DistributedSearchTreeImpl<DeviceType>::gatherBoundingBoxes(
+    Teuchos::Comm<int> const &comm, Box const &box )
+{
+    static_assert( sizeof( Box ) == 6 * sizeof( double ),
+                   "Box must be a thin wrapper around an array of doubles" );
+    int const comm_size = comm.getSize();
+    Kokkos::View<Box *, DeviceType> boxes( "rank_bounding_boxes", comm_size );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    Teuchos::gatherAll( comm, 6, box._minmax, 6 * comm_size,
+                        reinterpret_cast<double *>( boxes_host.data() ) );
+    Kokkos::deep_copy( boxes, boxes_host );
+    return boxes;
+}
+
+template <typename DeviceType>
+template <typename View>
+void DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+    Tpetra::Distributor &distributor, View exports,
+    typename View::non_const_type imports )
+{
+    DTK_REQUIRE( imports.extent( 0 ) == distributor.getTotalReceiveLength() );
+
+    using ValueType = typename View::non_const_value_type;
+    size_t const num_packets = sizeof( ValueType );
+
+    auto exports_host = Kokkos::create_mirror_view( exports );
+    Kokkos::deep_copy( exports_host, exports );
+    auto imports_host = Kokkos::create_mirror_view( imports );
+
+    Teuchos::ArrayView<char const> exports_bytes(
+        reinterpret_cast<char const *>( exports_host.data() ),
+        exports_host.extent( 0 ) * num_packets );
+    Teuchos::ArrayView<char> imports_bytes(
+        reinterpret_cast<char *>( imports_host.data() ),
+        imports_host.extent( 0 ) * num_packets );
+    distributor.doPostsAndWaits( exports_bytes, num_packets, imports_bytes );
+
+    Kokkos::deep_copy( imports, imports_host );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void DistributedSearchTreeImpl<DeviceType>::forwardQueries(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> indices,
+    Kokkos::View<int *, DeviceType> offset,
+    Kokkos::View<Query *, DeviceType> &fwd_queries,
+    Kokkos::View<int *, DeviceType> &fwd_ids,
+    Kokkos::View<int *, DeviceType> &fwd_ranks )
+{
+    int const comm_rank = comm->getRank();
+    int const n_queries = queries.extent( 0 );
+    int const n_exports = indices.extent( 0 );
+
+    Kokkos::View<Query *, DeviceType> exports( queries.label(), n_exports );
+    Kokkos::View<int *, DeviceType> export_ids( "export_ids", n_exports );
+    Kokkos::parallel_for(
+        REGION_NAME( "forward_queries_fill_buffers" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            for ( int i = offset( q ); i < offset( q + 1 ); ++i )
+            {
+                exports( i ) = queries( q );
+                export_ids( i ) = q;
+            }
+        } );
+    Kokkos::fence();
+
+    // the top tree stores the boxes in rank order so that the indices found
+    // are the ranks of the processes to send the queries to
+    auto export_ranks_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( export_ranks_host, indices );
+
+    Tpetra::Distributor distributor( comm );
+    int const n_imports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( export_ranks_host.data(), n_exports ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n_exports );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+
+    Kokkos::realloc( fwd_queries, n_imports );
+    Kokkos::realloc( fwd_ids, n_imports );
+    Kokkos::realloc( fwd_ranks, n_imports );
+    sendAcrossNetwork( distributor, exports, fwd_queries );
+    sendAcrossNetwork( distributor, export_ids, fwd_ids );
+    sendAcrossNetwork( distributor, export_ranks, fwd_ranks );
+}
+
+template <typename DeviceType>
+void DistributedSearchTreeImpl<DeviceType>::communicateResultsBack(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<int *, DeviceType> &ids,
+    Kokkos::View<double *, DeviceType> *distances )
+{
+    int const comm_rank = comm->getRank();
+    int const n_fwd_queries = offset.extent( 0 ) - 1;
+    int const n_exports = indices.extent( 0 );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n_exports );
+    Kokkos::View<int *, DeviceType> export_ids( "export_ids", n_exports );
+    Kokkos::parallel_for(
+        REGION_NAME( "communicate_results_back_fill_buffers" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_fwd_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            for ( int i = offset( q ); i < offset( q + 1 ); ++i )
+            {
+                export_ranks( i ) = ranks( q );
+                export_ids( i ) = ids( q );
+            }
+        } );
+    Kokkos::fence();
+
+    auto export_ranks_host = Kokkos::create_mirror_view( export_ranks );
+    Kokkos::deep_copy( export_ranks_host, export_ranks );
+
+    Tpetra::Distributor distributor( comm );
+    int const n_imports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( export_ranks_host.data(), n_exports ) );
+
+    // the objects found are owned by this process
+    Kokkos::deep_copy( export_ranks, comm_rank );
+
+    Kokkos::View<int *, DeviceType> import_indices( indices.label(),
+                                                    n_imports );
+    Kokkos::View<int *, DeviceType> import_ranks( ranks.label(), n_imports );
+    Kokkos::View<int *, DeviceType> import_ids( ids.label(), n_imports );
+    sendAcrossNetwork( distributor, indices, import_indices );
+    sendAcrossNetwork( distributor, export_ranks, import_ranks );
+    sendAcrossNetwork( distributor, export_ids, import_ids );
+    if ( distances != nullptr )
+    {
+        Kokkos::View<double *, DeviceType> import_distances(
+            distances->label(), n_imports );
+        sendAcrossNetwork( distributor, *distances, import_distances );
+        *distances = import_distances;
+    }
+
+    indices = import_indices;
+    ranks = import_ranks;
+    ids = import_ids;
+}
+
+template <typename DeviceType>
+void DistributedSearchTreeImpl<DeviceType>::sortResults(
+    int n_queries, Kokkos::View<int *, DeviceType> ids,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<double *, DeviceType> *distances )
+{
+    int const n_results = ids.extent( 0 );
+
+    Kokkos::realloc( offset, n_queries + 1 );
+    Kokkos::deep_copy( offset, 0 );
+    Kokkos::parallel_for(
+        REGION_NAME( "count_results_per_query" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_results ),
+        KOKKOS_LAMBDA( int i ) {
+            Kokkos::atomic_increment( &offset( ids( i ) ) );
+        } );
+    Kokkos::fence();
+
+    Kokkos::parallel_scan(
+        REGION_NAME( "compute_offset" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries + 1 ),
+        KOKKOS_LAMBDA( int i, int &update, bool final_pass ) {
+            int const offset_i = offset( i );
+            if ( final_pass )
+                offset( i ) = update;
+            update += offset_i;
+        } );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> sorted_indices( indices.label(),
+                                                    n_results );
+    Kokkos::View<int *, DeviceType> sorted_ranks( ranks.label(), n_results );
+    Kokkos::View<double *, DeviceType> unsorted_distances( "distances" );
+    Kokkos::View<double *, DeviceType> sorted_distances( "distances" );
+    if ( distances != nullptr )
+    {
+        unsorted_distances = *distances;
+        Kokkos::realloc( sorted_distances, n_results );
+    }
+    Kokkos::View<int *, DeviceType> count( "count", n_queries );
+    Kokkos::parallel_for(
+        REGION_NAME( "sort_results_by_query" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_results ),
+        KOKKOS_LAMBDA( int i ) {
+            int const q = ids( i );
+            int const pos =
+                offset( q ) + Kokkos::atomic_fetch_add( &count( q ), 1 );
+            sorted_indices( pos ) = indices( i );
+            sorted_ranks( pos ) = ranks( i );
+            if ( sorted_distances.extent( 0 ) > 0 )
+                sorted_distances( pos ) = unsorted_distances( i );
+        } );
+    Kokkos::fence();
+
+    indices = sorted_indices;
+    ranks = sorted_ranks;
+    if ( distances != nullptr )
+        *distances = sorted_distances;
+}
+
+template <typename DeviceType>
+void DistributedSearchTreeImpl<DeviceType>::excludeRanks(
+    Kokkos::View<int *, DeviceType> excluded_ranks,
+    Kokkos::View<int *, DeviceType> excluded_offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<int *, DeviceType> &offset )
+{
+    int const n_queries = offset.extent( 0 ) - 1;
+
+    auto is_excluded = KOKKOS_LAMBDA( int q, int rank )
+    {
+        for ( int i = excluded_offset( q ); i < excluded_offset( q + 1 ); ++i )
+            if ( excluded_ranks( i ) == rank )
+                return true;
+        return false;
+    };
+
+    Kokkos::View<int *, DeviceType> new_offset( offset.label(),
+                                                n_queries + 1 );
+    Kokkos::parallel_for(
+        REGION_NAME( "count_ranks_not_excluded" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            int count = 0;
+            for ( int i = offset( q ); i < offset( q + 1 ); ++i )
+                if ( !is_excluded( q, ranks( i ) ) )
+                    ++count;
+            new_offset( q ) = count;
+        } );
+    Kokkos::fence();
+    Kokkos::parallel_scan(
+        REGION_NAME( "compute_offset" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries + 1 ),
+        KOKKOS_LAMBDA( int i, int &update, bool final_pass ) {
+            int const offset_i = new_offset( i );
+            if ( final_pass )
+                new_offset( i ) = update;
+            update += offset_i;
+        } );
+    Kokkos::fence();
+
+    auto n_ranks = Kokkos::subview( new_offset, n_queries );
+    auto n_ranks_host = Kokkos::create_mirror_view( n_ranks );
+    Kokkos::deep_copy( n_ranks_host, n_ranks );
+    Kokkos::View<int *, DeviceType> new_ranks( ranks.label(),
+                                               n_ranks_host( 0 ) );
+    Kokkos::parallel_for(
+        REGION_NAME( "remove_excluded_ranks" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            int count = 0;
+            for ( int i = offset( q ); i < offset( q + 1 ); ++i )
+                if ( !is_excluded( q, ranks( i ) ) )
+                    new_ranks( new_offset( q ) + count++ ) = ranks( i );
+        } );
+    Kokkos::fence();
+
+    ranks = new_ranks;
+    offset = new_offset;
+}
+
+// Swap the results at positions i and j.
+template <typename DeviceType>
+KOKKOS_INLINE_FUNCTION void
+swapResults( Kokkos::View<double *, DeviceType> distances,
+             Kokkos::View<int *, DeviceType> indices,
+             Kokkos::View<int *, DeviceType> ranks, int i, int j )
+{
+    double const distance = distances( i );
+    distances( i ) = distances( j );
+    distances( j ) = distance;
+    int const index = indices( i );
+    indices( i ) = indices( j );
+    indices( j ) = index;
+    int const rank = ranks( i );
+    ranks( i ) = ranks( j );
+    ranks( j ) = rank;
+}
+
+// Move the result at position pos of the max-heap on the distances stored in
+// [first, first + size) down until it is not closer than its children.
+template <typename DeviceType>
+KOKKOS_INLINE_FUNCTION void
+siftDownResult( Kokkos::View<double *, DeviceType> distances,
+                Kokkos::View<int *, DeviceType> indices,
+                Kokkos::View<int *, DeviceType> ranks, int first, int size,
+                int pos )
+{
+    while ( true )
+    {
+        int farthest = pos;
+        for ( int child = 2 * pos + 1; child <= 2 * pos + 2; ++child )
+            if ( child < size &&
+                 distances( first + child ) > distances( first + farthest ) )
+                farthest = child;
+        if ( farthest == pos )
+            return;
+        swapResults( distances, indices, ranks, first + pos,
+                     first + farthest );
+        pos = farthest;
+    }
+}
+
+template <typename DeviceType>
+template <typename Query>
+void DistributedSearchTreeImpl<DeviceType>::filterResults(
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<double *, DeviceType> &distances,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks )
+{
+    int const n_queries = queries.extent( 0 );
+
+    // Move the k closest objects found for each query to the front of its
+    // results, sorted by increasing distance. They are selected with a
+    // max-heap of size k built in place, so that every other object only
+    // costs a comparison with the farthest of those kept so far, and the
+    // heap is then sorted.
+    Kokkos::parallel_for(
+        REGION_NAME( "select_closest_results" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            int const first = offset( q );
+            int const n = offset( q + 1 ) - first;
+            int const k = KokkosHelpers::min( n, queries( q )._k );
+            for ( int i = k / 2 - 1; i >= 0; --i )
+                siftDownResult( distances, indices, ranks, first, k, i );
+            for ( int i = k; i < n; ++i )
+                if ( distances( first + i ) < distances( first ) )
+                {
+                    swapResults( distances, indices, ranks, first, first + i );
+                    siftDownResult( distances, indices, ranks, first, k, 0 );
+                }
+            for ( int size = k - 1; size > 0; --size )
+            {
+                swapResults( distances, indices, ranks, first, first + size );
+                siftDownResult( distances, indices, ranks, first, size, 0 );
+            }
+        } );
+    Kokkos::fence();
+
+    Kokkos::View<int *, DeviceType> new_offset( offset.label(),
+                                                n_queries + 1 );
+    Kokkos::parallel_for(
+        REGION_NAME( "count_closest_results" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            new_offset( q ) = KokkosHelpers::min(
+                offset( q + 1 ) - offset( q ), queries( q )._k );
+        } );
+    Kokkos::fence();
+    Kokkos::parallel_scan(
+        REGION_NAME( "compute_offset" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries + 1 ),
+        KOKKOS_LAMBDA( int i, int &update, bool final_pass ) {
+            int const offset_i = new_offset( i );
+            if ( final_pass )
+                new_offset( i ) = update;
+            update += offset_i;
+        } );
+    Kokkos::fence();
+
+    auto n_results = Kokkos::subview( new_offset, n_queries );
+    auto n_results_host = Kokkos::create_mirror_view( n_results );
+    Kokkos::deep_copy( n_results_host, n_results );
+    Kokkos::View<int *, DeviceType> new_indices( indices.label(),
+                                                 n_results_host( 0 ) );
+    Kokkos::View<int *, DeviceType> new_ranks( ranks.label(),
+                                               n_results_host( 0 ) );
+    Kokkos::View<double *, DeviceType> new_distances( distances.label(),
+                                                      n_results_host( 0 ) );
+    Kokkos::parallel_for(
+        REGION_NAME( "keep_closest_results" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            for ( int i = 0; i < new_offset( q + 1 ) - new_offset( q ); ++i )
+            {
+                new_indices( new_offset( q ) + i ) = indices( offset( q ) + i );
+                new_ranks( new_offset( q ) + i ) = ranks( offset( q ) + i );
+                new_distances( new_offset( q ) + i ) =
+                    distances( offset( q ) + i );
+            }
+        } );
+    Kokkos::fence();
+
+    indices = new_indices;
+    ranks = new_ranks;
+    distances = new_distances;
+    offset = new_offset;
+}
+
+template <typename DeviceType>
+template <typename Query>
+Kokkos::View<decltype( relax( std::declval<Query>() ) ) *, DeviceType>
+DistributedSearchTreeImpl<DeviceType>::relaxQueries(
+    Kokkos::View<Query *, DeviceType> queries )
+{
+    using RelaxedQuery = decltype( relax( std::declval<Query>() ) );
+    int const n_queries = queries.extent( 0 );
+    Kokkos::View<RelaxedQuery *, DeviceType> relaxed_queries(
+        queries.label(), n_queries );
+    Kokkos::parallel_for( REGION_NAME( "relax_queries" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+                          KOKKOS_LAMBDA( int q ) {
+                              relaxed_queries( q ) = relax( queries( q ) );
+                          } );
+    Kokkos::fence();
+    return relaxed_queries;
+}
+
+template <typename DeviceType>
+template <typename TopTree, typename BottomTree, typename Query>
+void DistributedSearchTreeImpl<DeviceType>::queryDispatch(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm, TopTree const &top_tree,
+    BottomTree const &bottom_tree, Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks, SpatialPredicateTag )
+{
+    int const n_queries = queries.extent( 0 );
+
+    // find the processes that may own objects that meet the predicates
+    top_tree.query( relaxQueries( queries ), indices, offset );
+
+    Kokkos::View<Query *, DeviceType> fwd_queries( queries.label() );
+    Kokkos::View<int *, DeviceType> ids( "query_ids" );
+    forwardQueries( comm, queries, indices, offset, fwd_queries, ids, ranks );
+
+    bottom_tree.query( fwd_queries, indices, offset );
+
+    communicateResultsBack( comm, indices, offset, ranks, ids, nullptr );
+
+    sortResults( n_queries, ids, indices, offset, ranks, nullptr );
+}
+
+template <typename DeviceType>
+template <typename Query>
+void DistributedSearchTreeImpl<DeviceType>::pipelinedQueryDispatch(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    BVH<DeviceType> const &top_tree, BVH<DeviceType> const &bottom_tree,
+    Kokkos::View<Query *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks, QueryPipelineTimings &timings )
+{
+    using QueryView = Kokkos::View<Query *, DeviceType>;
+    using RequestType = Teuchos::RCP<Teuchos::CommRequest<int>>;
+
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+    int const n_queries = queries.extent( 0 );
+
+    double start = Teuchos::Time::wallTime();
+    auto elapsed = [&start]() {
+        double const now = Teuchos::Time::wallTime();
+        double const duration = now - start;
+        start = now;
+        return duration;
+    };
+
+    // find the processes that may own objects that meet the predicates
+    Kokkos::View<int *, DeviceType> dest_ranks( "dest_ranks" );
+    Kokkos::View<int *, DeviceType> dest_offset( "dest_offset" );
+    top_tree.query( relaxQueries( queries ), dest_ranks, dest_offset );
+    timings.find_destinations += elapsed();
+
+    auto dest_ranks_host = Kokkos::create_mirror_view( dest_ranks );
+    Kokkos::deep_copy( dest_ranks_host, dest_ranks );
+    auto dest_offset_host = Kokkos::create_mirror_view( dest_offset );
+    Kokkos::deep_copy( dest_offset_host, dest_offset );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    Kokkos::deep_copy( queries_host, queries );
+    int const n_exports = dest_ranks_host.extent( 0 );
+
+    // group the queries by destination, export_ids keeps track of their
+    // position in the local batch to match the results sent back
+    std::vector<int> send_counts( comm_size, 0 );
+    for ( int i = 0; i < n_exports; ++i )
+        ++send_counts[dest_ranks_host( i )];
+    std::vector<int> send_displs( comm_size + 1, 0 );
+    for ( int r = 0; r < comm_size; ++r )
+        send_displs[r + 1] = send_displs[r] + send_counts[r];
+    std::vector<Query> export_queries( n_exports );
+    std::vector<int> export_ids( n_exports );
+    std::vector<int> count( comm_size, 0 );
+    for ( int q = 0; q < n_queries; ++q )
+        for ( int i = dest_offset_host( q ); i < dest_offset_host( q + 1 );
+              ++i )
+        {
+            int const r = dest_ranks_host( i );
+            int const pos = send_displs[r] + count[r]++;
+            export_queries[pos] = queries_host( q );
+            export_ids[pos] = q;
+        }
+
+    // the distributor only serves to find out who sends queries to this
+    // process and how many
+    Tpetra::Distributor distributor( comm );
+    distributor.createFromSends(
+        Teuchos::ArrayView<int const>( dest_ranks_host.data(), n_exports ) );
+    auto const procs_from = distributor.getProcsFrom();
+    auto const lengths_from = distributor.getLengthsFrom();
+    int const n_sources = procs_from.size();
+
+    // The receives are posted before the sends. The queries are exchanged
+    // with MPI directly since Teuchos cannot wait for any one of several
+    // requests, the results are exchanged afterwards with Teuchos so that
+    // they match the receives in the order they are posted.
+    std::vector<QueryView> fwd_queries( n_sources );
+    std::vector<typename QueryView::HostMirror> fwd_queries_host( n_sources );
+    int self_source = -1;
+#ifdef HAVE_MPI
+    // above the tags of the communication plans and below those Teuchos
+    // uses for the results
+    int const query_tag = 20000;
+    MPI_Comm raw_comm = MPI_COMM_NULL;
+    if ( comm_size > 1 )
+    {
+        auto mpi_comm =
+            Teuchos::rcp_dynamic_cast<Teuchos::MpiComm<int> const>( comm );
+        DTK_INSIST( mpi_comm.get() != nullptr );
+        raw_comm = *mpi_comm->getRawMpiComm();
+    }
+    std::vector<MPI_Request> query_requests( n_sources, MPI_REQUEST_NULL );
+#endif
+    for ( int s = 0; s < n_sources; ++s )
+    {
+        fwd_queries[s] = QueryView( queries.label(), lengths_from[s] );
+        fwd_queries_host[s] = Kokkos::create_mirror_view( fwd_queries[s] );
+        if ( procs_from[s] == comm_rank )
+        {
+            std::copy( export_queries.begin() + send_displs[comm_rank],
+                       export_queries.begin() + send_displs[comm_rank + 1],
+                       fwd_queries_host[s].data() );
+            self_source = s;
+        }
+#ifdef HAVE_MPI
+        else
+            MPI_Irecv( fwd_queries_host[s].data(),
+                       lengths_from[s] * sizeof( Query ), MPI_BYTE,
+                       procs_from[s], query_tag, raw_comm,
+                       &query_requests[s] );
+#endif
+    }
+    // number of objects found for each query sent and their indices
+    std::vector<std::vector<int>> result_counts( comm_size );
+    std::vector<std::vector<int>> result_indices( comm_size );
+    std::vector<RequestType> count_requests( comm_size );
+    for ( int r = 0; r < comm_size; ++r )
+        if ( send_counts[r] > 0 && r != comm_rank )
+        {
+            result_counts[r].resize( send_counts[r] );
+            count_requests[r] = Teuchos::ireceive<int, int>(
+                *comm, Teuchos::arcp( result_counts[r].data(), 0,
+                                      send_counts[r], false ),
+                r );
+        }
+#ifdef HAVE_MPI
+    std::vector<MPI_Request> query_send_requests;
+    for ( int r = 0; r < comm_size; ++r )
+        if ( send_counts[r] > 0 && r != comm_rank )
+        {
+            query_send_requests.push_back( MPI_REQUEST_NULL );
+            MPI_Isend( export_queries.data() + send_displs[r],
+                       send_counts[r] * sizeof( Query ), MPI_BYTE, r,
+                       query_tag, raw_comm,
+                       &query_send_requests.back() );
+        }
+#endif
+    std::vector<RequestType> requests;
+    timings.post_communication += elapsed();
+
+    std::vector<std::vector<int>> fwd_counts( n_sources );
+    std::vector<std::vector<int>> fwd_indices( n_sources );
+    auto search_chunk = [&]( int s ) {
+        int const r = procs_from[s];
+        Kokkos::deep_copy( fwd_queries[s], fwd_queries_host[s] );
+        Kokkos::View<int *, DeviceType> chunk_indices( "indices" );
+        Kokkos::View<int *, DeviceType> chunk_offset( "offset" );
+        bottom_tree.query( fwd_queries[s], chunk_indices, chunk_offset );
+
+        auto chunk_indices_host = Kokkos::create_mirror_view( chunk_indices );
+        Kokkos::deep_copy( chunk_indices_host, chunk_indices );
+        auto chunk_offset_host = Kokkos::create_mirror_view( chunk_offset );
+        Kokkos::deep_copy( chunk_offset_host, chunk_offset );
+        int const n_fwd_queries = lengths_from[s];
+        fwd_counts[s].resize( n_fwd_queries );
+        for ( int j = 0; j < n_fwd_queries; ++j )
+            fwd_counts[s][j] =
+                chunk_offset_host( j + 1 ) - chunk_offset_host( j );
+        fwd_indices[s].assign( chunk_indices_host.data(),
+                               chunk_indices_host.data() +
+                                   chunk_indices_host.extent( 0 ) );
+        timings.local_search += elapsed();
+
+        if ( r == comm_rank )
+        {
+            result_counts[r] = fwd_counts[s];
+            result_indices[r] = fwd_indices[s];
+            return;
+        }
+        requests.push_back( Teuchos::isend<int, int>(
+            *comm,
+            Teuchos::arcp<int const>( fwd_counts[s].data(), 0, n_fwd_queries,
+                                      false ),
+            r ) );
+        if ( !fwd_indices[s].empty() )
+            requests.push_back( Teuchos::isend<int, int>(
+                *comm, Teuchos::arcp<int const>( fwd_indices[s].data(), 0,
+                                                 fwd_indices[s].size(), false ),
+                r ) );
+        timings.post_communication += elapsed();
+    };
+
+    // search the chunk this process sent to itself first, then the other
+    // ones in the order they arrive
+    if ( self_source >= 0 )
+        search_chunk( self_source );
+#ifdef HAVE_MPI
+    int const n_remote_sources = n_sources - ( self_source >= 0 ? 1 : 0 );
+    for ( int i = 0; i < n_remote_sources; ++i )
+    {
+        int s;
+        MPI_Waitany( n_sources, query_requests.data(), &s,
+                     MPI_STATUS_IGNORE );
+        timings.wait += elapsed();
+        search_chunk( s );
+    }
+#endif
+
+    // the size of the results is only known once the counts have arrived
+    for ( int r = 0; r < comm_size; ++r )
+        if ( send_counts[r] > 0 && r != comm_rank )
+        {
+            Teuchos::wait( *comm, Teuchos::ptr( &count_requests[r] ) );
+            int n_results = 0;
+            for ( int const c : result_counts[r] )
+                n_results += c;
+            if ( n_results > 0 )
+            {
+                result_indices[r].resize( n_results );
+                requests.push_back( Teuchos::ireceive<int, int>(
+                    *comm, Teuchos::arcp( result_indices[r].data(), 0,
+                                          n_results, false ),
+                    r ) );
+            }
+        }
+    Teuchos::waitAll( *comm, Teuchos::arrayViewFromVector( requests ) );
+#ifdef HAVE_MPI
+    MPI_Waitall( query_send_requests.size(), query_send_requests.data(),
+                 MPI_STATUSES_IGNORE );
+#endif
+    timings.wait += elapsed();
+
+    // flatten the results before building the compressed row storage
+    int n_results = 0;
+    for ( int r = 0; r < comm_size; ++r )
+        n_results += result_indices[r].size();
+    Kokkos::View<int *, DeviceType> ids( "query_ids", n_results );
+    Kokkos::realloc( indices, n_results );
+    Kokkos::realloc( ranks, n_results );
+    auto ids_host = Kokkos::create_mirror_view( ids );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    int pos = 0;
+    for ( int r = 0; r < comm_size; ++r )
+    {
+        int i = 0;
+        for ( int j = 0; j < send_counts[r]; ++j )
+            for ( int c = 0; c < result_counts[r][j]; ++c, ++pos )
+            {
+                ids_host( pos ) = export_ids[send_displs[r] + j];
+                indices_host( pos ) = result_indices[r][i++];
+                ranks_host( pos ) = r;
+            }
+    }
+    Kokkos::deep_copy( ids, ids_host );
+    Kokkos::deep_copy( indices, indices_host );
+    Kokkos::deep_copy( ranks, ranks_host );
+
+    sortResults( n_queries, ids, indices, offset, ranks, nullptr );
+    timings.sort_results += elapsed();
+}
+
+template <typename DeviceType>
+template <typename TopTree, typename BottomTree, typename Geometry>
+void DistributedSearchTreeImpl<DeviceType>::queryDispatch(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm, TopTree const &top_tree,
+    BottomTree const &bottom_tree,
+    Kokkos::View<Nearest<Geometry> *, DeviceType> queries,
+    Kokkos::View<int *, DeviceType> &indices,
+    Kokkos::View<int *, DeviceType> &offset,
+    Kokkos::View<int *, DeviceType> &ranks,
+    Kokkos::View<double *, DeviceType> &distances, NearestPredicateTag )
+{
+    int const n_queries = queries.extent( 0 );
+
+    Kokkos::View<Nearest<Geometry> *, DeviceType> fwd_queries(
+        queries.label() );
+    Kokkos::View<int *, DeviceType> ids( "query_ids" );
+    Kokkos::View<int *, DeviceType> fwd_ranks( "fwd_ranks" );
+
+    // Phase 1: each non-empty process owns at least one object so the k
+    // processes that are the closest own at least k objects.
+    Kokkos::View<int *, DeviceType> first_ranks( "first_ranks" );
+    Kokkos::View<int *, DeviceType> first_offset( "first_offset" );
+    top_tree.query( queries, first_ranks, first_offset );
+
+    forwardQueries( comm, queries, first_ranks, first_offset, fwd_queries, ids,
+                    fwd_ranks );
+    bottom_tree.query( fwd_queries, indices, offset, distances );
+    communicateResultsBack( comm, indices, offset, fwd_ranks, ids,
+                            &distances );
+    sortResults( n_queries, ids, indices, offset, fwd_ranks, &distances );
+    filterResults( queries, distances, indices, offset, fwd_ranks );
+
+    // The radius is the distance to the k-th object found. It is infinite if
+    // fewer than k objects were found, in which case all the processes
+    // were contacted already.
+    Kokkos::View<Within<Geometry> *, DeviceType> radius_queries(
+        "radius_queries", n_queries );
+    Kokkos::parallel_for(
+        REGION_NAME( "build_radius_queries" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            int const k = queries( q )._k;
+            double const radius =
+                ( offset( q + 1 ) - offset( q ) < k )
+                    ? Kokkos::ArithTraits<double>::max()
+                    : distances( offset( q + 1 ) - 1 );
+            radius_queries( q ) = within( queries( q )._geometry, radius );
+        } );
+    Kokkos::fence();
+
+    // Phase 2: do not contact again the processes from the first phase.
+    Kokkos::View<int *, DeviceType> second_ranks( "second_ranks" );
+    Kokkos::View<int *, DeviceType> second_offset( "second_offset" );
+    top_tree.query( radius_queries, second_ranks, second_offset );
+    excludeRanks( first_ranks, first_offset, second_ranks, second_offset );
+
+    Kokkos::View<int *, DeviceType> second_ids( "query_ids" );
+    Kokkos::View<int *, DeviceType> second_fwd_ranks( "fwd_ranks" );
+    Kokkos::View<int *, DeviceType> second_indices( "indices" );
+    Kokkos::View<double *, DeviceType> second_distances( "distances" );
+    forwardQueries( comm, queries, second_ranks, second_offset, fwd_queries,
+                    second_ids, second_fwd_ranks );
+    bottom_tree.query( fwd_queries, second_indices, second_offset,
+                       second_distances );
+    communicateResultsBack( comm, second_indices, second_offset,
+                            second_fwd_ranks, second_ids, &second_distances );
+
+    // merge the results of both phases
+    int const n_first = indices.extent( 0 );
+    int const n_second = second_indices.extent( 0 );
+    Kokkos::View<int *, DeviceType> all_ids( ids.label(), n_first + n_second );
+    Kokkos::View<int *, DeviceType> all_indices( indices.label(),
+                                                 n_first + n_second );
+    Kokkos::View<int *, DeviceType> all_ranks( "ranks", n_first + n_second );
+    Kokkos::View<double *, DeviceType> all_distances( distances.label(),
+                                                      n_first + n_second );
+    Kokkos::parallel_for(
+        REGION_NAME( "merge_first_phase_results" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_queries ),
+        KOKKOS_LAMBDA( int q ) {
+            for ( int i = offset( q ); i < offset( q + 1 ); ++i )
+            {
+                all_ids( i ) = q;
+                all_indices( i ) = indices( i );
+                all_ranks( i ) = fwd_ranks( i );
+                all_distances( i ) = distances( i );
+            }
+        } );
+    Kokkos::parallel_for(
+        REGION_NAME( "merge_second_phase_results" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_second ),
+        KOKKOS_LAMBDA( int i ) {
+            all_ids( n_first + i ) = second_ids( i );
+            all_indices( n_first + i ) = second_indices( i );
+            all_ranks( n_first + i ) = second_fwd_ranks( i );
+            all_distances( n_first + i ) = second_distances( i );
+        } );
+    Kokkos::fence();
+
+    indices = all_indices;
+    ranks = all_ranks;
+    distances = all_distances;
+    sortResults( n_queries, all_ids, indices, offset, ranks, &distances );
+    filterResults( queries, distances, indices, offset, ranks );
+}
+
+} // end namespace Details
+} // end namespace DataTransferKit
+
+#endif
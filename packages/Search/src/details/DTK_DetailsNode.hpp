@@ -15,17 +15,24 @@
 
 namespace DataTransferKit
 {
+/**
+ * The nodes of a hierarchy are stored contiguously, internal nodes first
+ * followed by the leaves. They refer to each other by their position in that
+ * array rather than by address so that the hierarchy remains valid wherever
+ * its memory gets mapped (e.g. when it is shared between processes). A
+ * negative position means there is no such node.
+ */
 struct Node
 {
     KOKKOS_INLINE_FUNCTION
     Node()
-        : parent( nullptr )
-        , children( {nullptr, nullptr} )
+        : parent( -1 )
+        , children( {-1, -1} )
     {
     }
 
-    Node *parent = nullptr;
-    Kokkos::pair<Node *, Node *> children;
+    int parent = -1;
+    Kokkos::pair<int, int> children;
     Box bounding_box;
 };
 }
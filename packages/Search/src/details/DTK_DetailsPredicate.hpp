@@ -12,6 +12,9 @@
 #include <DTK_DetailsAlgorithms.hpp>
 #include <DTK_DetailsNode.hpp>
 
+#include <new>
+#include <type_traits>
+
 namespace DataTransferKit
 {
 namespace Details
@@ -23,40 +26,56 @@ struct NearestPredicateTag
 struct SpatialPredicateTag
 {
 };
+struct VariantPredicateTag
+{
+};
 
 // COMMENT: Default constructor and assignment operator are required to be able
 // to declare a Kokkos::View of a predicate type and fill it with a
 // Kokkos::for_parallel.
 
+// The query geometry of the Nearest and Within predicates may be either a
+// Point, the default, or a Box.
+// With a positive eps, the nearest search is approximate: the distance to the
+// i-th object reported is at most (1 + eps) times the distance to the true
+// i-th nearest neighbor, which allows to prune more of the tree. The search
+// stays exact when k exceeds the capacity of the PriorityQueue that holds
+// the candidates.
+template <typename Geometry = Point>
 struct Nearest
 {
     using Tag = NearestPredicateTag;
 
     KOKKOS_INLINE_FUNCTION
     Nearest()
-        : _query_point( {0., 0., 0.} )
+        : _geometry()
         , _k( 0 )
+        , _eps( 0. )
     {
     }
 
     KOKKOS_INLINE_FUNCTION Nearest &operator=( Nearest const &other )
     {
-        _query_point = other._query_point;
+        _geometry = other._geometry;
         _k = other._k;
+        _eps = other._eps;
         return *this;
     }
 
     KOKKOS_INLINE_FUNCTION
-    Nearest( Point const &query_point, int k )
-        : _query_point( query_point )
+    Nearest( Geometry const &geometry, int k, double eps = 0. )
+        : _geometry( geometry )
         , _k( k )
+        , _eps( eps )
     {
     }
 
-    Point _query_point;
+    Geometry _geometry;
     int _k;
+    double _eps;
 };
 
+template <typename Geometry = Point>
 class Within
 {
   public:
@@ -64,21 +83,21 @@ class Within
 
     KOKKOS_INLINE_FUNCTION
     Within()
-        : _query_point( {0., 0., 0.} )
+        : _geometry()
         , _radius( 0. )
     {
     }
 
     KOKKOS_INLINE_FUNCTION Within &operator=( Within const &other )
     {
-        _query_point = other._query_point;
+        _geometry = other._geometry;
         _radius = other._radius;
         return *this;
     }
 
     KOKKOS_INLINE_FUNCTION
-    Within( Point const &query_point, double const radius )
-        : _query_point( query_point )
+    Within( Geometry const &geometry, double const radius )
+        : _geometry( geometry )
         , _radius( radius )
     {
     }
@@ -86,12 +105,12 @@ class Within
     KOKKOS_INLINE_FUNCTION
     bool operator()( Node const *node ) const
     {
-        double node_distance = distance( _query_point, node->bounding_box );
+        double node_distance = distance( _geometry, node->bounding_box );
         return ( node_distance <= _radius ) ? true : false;
     }
 
   private:
-    Point _query_point;
+    Geometry _geometry;
     double _radius;
 };
 
@@ -128,11 +147,336 @@ class Overlap
     DataTransferKit::Box _query_box;
 };
 
+template <typename T, typename = void>
+struct IsSpatialPredicate : std::false_type
+{
+};
+
+template <typename T>
+struct IsSpatialPredicate<
+    T, typename std::enable_if<std::is_same<typename T::Tag,
+                                            SpatialPredicateTag>::value>::type>
+    : std::true_type
+{
+};
+
+// Combinators let several spatial predicates be tested within a single
+// traversal of the tree. They are templates so the combined test gets inlined
+// rather than dispatched at runtime.
+
+template <typename Predicate1, typename Predicate2>
+class And
+{
+    static_assert( IsSpatialPredicate<Predicate1>::value &&
+                       IsSpatialPredicate<Predicate2>::value,
+                   "And only combines spatial predicates" );
+
+  public:
+    using Tag = SpatialPredicateTag;
+
+    KOKKOS_INLINE_FUNCTION
+    And()
+        : _lhs()
+        , _rhs()
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION And &operator=( And const &other )
+    {
+        _lhs = other._lhs;
+        _rhs = other._rhs;
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    And( Predicate1 const &lhs, Predicate2 const &rhs )
+        : _lhs( lhs )
+        , _rhs( rhs )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Node const *node ) const
+    {
+        return _lhs( node ) && _rhs( node );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    Predicate1 const &lhs() const { return _lhs; }
+
+    KOKKOS_INLINE_FUNCTION
+    Predicate2 const &rhs() const { return _rhs; }
+
+  private:
+    Predicate1 _lhs;
+    Predicate2 _rhs;
+};
+
+template <typename Predicate1, typename Predicate2>
+class Or
+{
+    static_assert( IsSpatialPredicate<Predicate1>::value &&
+                       IsSpatialPredicate<Predicate2>::value,
+                   "Or only combines spatial predicates" );
+
+  public:
+    using Tag = SpatialPredicateTag;
+
+    KOKKOS_INLINE_FUNCTION
+    Or()
+        : _lhs()
+        , _rhs()
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION Or &operator=( Or const &other )
+    {
+        _lhs = other._lhs;
+        _rhs = other._rhs;
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    Or( Predicate1 const &lhs, Predicate2 const &rhs )
+        : _lhs( lhs )
+        , _rhs( rhs )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Node const *node ) const
+    {
+        return _lhs( node ) || _rhs( node );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    Predicate1 const &lhs() const { return _lhs; }
+
+    KOKKOS_INLINE_FUNCTION
+    Predicate2 const &rhs() const { return _rhs; }
+
+  private:
+    Predicate1 _lhs;
+    Predicate2 _rhs;
+};
+
+template <typename Predicate>
+class Not
+{
+    static_assert( IsSpatialPredicate<Predicate>::value,
+                   "Not only applies to spatial predicates" );
+
+  public:
+    using Tag = SpatialPredicateTag;
+
+    KOKKOS_INLINE_FUNCTION
+    Not()
+        : _pred()
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION Not &operator=( Not const &other )
+    {
+        _pred = other._pred;
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    Not( Predicate const &pred )
+        : _pred( pred )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Node const *node ) const
+    {
+        // An internal node that meets the predicate may still have leaves
+        // below it that do not, so the negation can only prune leaves.
+        bool const is_leaf =
+            ( node->children.first < 0 ) && ( node->children.second < 0 );
+        return is_leaf ? !_pred( node ) : true;
+    }
+
+  private:
+    Predicate _pred;
+};
+
+// Met by every node, e.g. to stand for a negation that cannot prune
+// anything.
+class Everything
+{
+  public:
+    using Tag = SpatialPredicateTag;
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Node const * ) const { return true; }
+};
+
+// The leaves of the top tree of a distributed search bound all the objects
+// of a process. Such a leaf may only be pruned if none of the objects inside
+// it can meet the predicate, which the negation of a predicate that the box
+// meets does not tell. relax() returns the predicate to test against these
+// coarse leaves, in which the negations are always met.
+template <typename Predicate>
+KOKKOS_INLINE_FUNCTION Predicate relax( Predicate const &pred )
+{
+    return pred;
+}
+
+template <typename Predicate>
+KOKKOS_INLINE_FUNCTION Everything relax( Not<Predicate> const & )
+{
+    return Everything();
+}
+
+template <typename Predicate1, typename Predicate2>
+KOKKOS_INLINE_FUNCTION auto relax( And<Predicate1, Predicate2> const &pred )
+    -> And<decltype( relax( pred.lhs() ) ), decltype( relax( pred.rhs() ) )>
+{
+    return And<decltype( relax( pred.lhs() ) ),
+               decltype( relax( pred.rhs() ) )>( relax( pred.lhs() ),
+                                                 relax( pred.rhs() ) );
+}
+
+template <typename Predicate1, typename Predicate2>
+KOKKOS_INLINE_FUNCTION auto relax( Or<Predicate1, Predicate2> const &pred )
+    -> Or<decltype( relax( pred.lhs() ) ), decltype( relax( pred.rhs() ) )>
+{
+    return Or<decltype( relax( pred.lhs() ) ),
+              decltype( relax( pred.rhs() ) )>( relax( pred.lhs() ),
+                                                relax( pred.rhs() ) );
+}
+
+// Same syntax as boost::geometry::index, e.g.
+//   within( p, r ) && !overlap( b )
+template <typename Predicate1, typename Predicate2>
+KOKKOS_INLINE_FUNCTION typename std::enable_if<
+    IsSpatialPredicate<Predicate1>::value &&
+        IsSpatialPredicate<Predicate2>::value,
+    And<Predicate1, Predicate2>>::type
+operator&&( Predicate1 const &lhs, Predicate2 const &rhs )
+{
+    return And<Predicate1, Predicate2>( lhs, rhs );
+}
+
+template <typename Predicate1, typename Predicate2>
+KOKKOS_INLINE_FUNCTION typename std::enable_if<
+    IsSpatialPredicate<Predicate1>::value &&
+        IsSpatialPredicate<Predicate2>::value,
+    Or<Predicate1, Predicate2>>::type
+operator||( Predicate1 const &lhs, Predicate2 const &rhs )
+{
+    return Or<Predicate1, Predicate2>( lhs, rhs );
+}
+
+template <typename Predicate>
+KOKKOS_INLINE_FUNCTION typename std::enable_if<
+    IsSpatialPredicate<Predicate>::value, Not<Predicate>>::type
+operator!( Predicate const &pred )
+{
+    return Not<Predicate>( pred );
+}
+
+// Holds either one of two kinds of predicates so that a single batch of
+// queries can mix them, e.g. nearest neighbors and radius searches.
+// BVH::query() groups the queries by kind internally to limit divergence.
+// Only the alternative held is stored, the predicates must be trivially
+// destructible.
+template <typename Predicate1, typename Predicate2>
+class PredicateVariant
+{
+    static_assert( !std::is_same<Predicate1, Predicate2>::value,
+                   "alternatives must be distinct predicate types" );
+    static_assert( std::is_trivially_destructible<Predicate1>::value &&
+                       std::is_trivially_destructible<Predicate2>::value,
+                   "alternatives must be trivially destructible" );
+
+  public:
+    using Tag = VariantPredicateTag;
+    using FirstType = Predicate1;
+    using SecondType = Predicate2;
+
+    KOKKOS_INLINE_FUNCTION
+    PredicateVariant()
+        : _index( 0 )
+        , _first()
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    PredicateVariant( PredicateVariant const &other ) { *this = other; }
+
+    KOKKOS_INLINE_FUNCTION PredicateVariant &
+    operator=( PredicateVariant const &other )
+    {
+        _index = other._index;
+        if ( _index == 0 )
+            new ( &_first ) Predicate1( other._first );
+        else
+            new ( &_second ) Predicate2( other._second );
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    PredicateVariant( Predicate1 const &pred )
+        : _index( 0 )
+        , _first( pred )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    PredicateVariant( Predicate2 const &pred )
+        : _index( 1 )
+        , _second( pred )
+    {
+    }
+
+    // Return 0 if the variant holds the first alternative and 1 otherwise.
+    KOKKOS_INLINE_FUNCTION
+    int index() const { return _index; }
+
+    // Only valid if index() is 0.
+    KOKKOS_INLINE_FUNCTION
+    Predicate1 const &first() const { return _first; }
+
+    // Only valid if index() is 1.
+    KOKKOS_INLINE_FUNCTION
+    Predicate2 const &second() const { return _second; }
+
+  private:
+    int _index;
+    union {
+        Predicate1 _first;
+        Predicate2 _second;
+    };
+};
+
+// The non-template overloads let the point be given as a braced initializer
+// list, e.g. nearest( {x, y, z}, k ).
 KOKKOS_INLINE_FUNCTION
-Nearest nearest( Point const &p, int k = 1 ) { return Nearest( p, k ); }
+Nearest<Point> nearest( Point const &p, int k = 1, double eps = 0. )
+{
+    return Nearest<Point>( p, k, eps );
+}
+
+template <typename Geometry>
+KOKKOS_INLINE_FUNCTION Nearest<Geometry>
+nearest( Geometry const &g, int k = 1, double eps = 0. )
+{
+    return Nearest<Geometry>( g, k, eps );
+}
 
 KOKKOS_INLINE_FUNCTION
-Within within( Point const &p, double r ) { return Within( p, r ); }
+Within<Point> within( Point const &p, double r )
+{
+    return Within<Point>( p, r );
+}
+
+template <typename Geometry>
+KOKKOS_INLINE_FUNCTION Within<Geometry> within( Geometry const &g, double r )
+{
+    return Within<Geometry>( g, r );
+}
 
 KOKKOS_INLINE_FUNCTION
 Overlap overlap( Box const &b ) { return Overlap( b ); }
@@ -40,6 +40,14 @@ class PriorityQueue
 
     KOKKOS_INLINE_FUNCTION bool empty() const { return _size == 0; }
 
+    KOKKOS_INLINE_FUNCTION SizeType size() const { return _size; }
+
+    // maximum number of elements the queue can hold
+    KOKKOS_INLINE_FUNCTION static constexpr SizeType maxSize()
+    {
+        return _max_size;
+    }
+
     template <typename... Args>
     KOKKOS_FUNCTION void push( Args &&... args )
     {
@@ -0,0 +1,249 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+#ifndef DTK_DETAILS_RENDEZVOUS_IMPL_HPP
+#define DTK_DETAILS_RENDEZVOUS_IMPL_HPP
+
+#include "DTK_ConfigDefs.hpp"
+
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsBox.hpp>
+#include <DTK_DetailsDistributedSearchTreeImpl.hpp>
+#include <DTK_DetailsTreeConstruction.hpp>
+#include <DTK_KokkosHelpers.hpp>
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_RCP.hpp>
+#include <Tpetra_Distributor.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+/**
+ * This structure contains the functions used to build the rendezvous
+ * decomposition of a RendezvousSearchTree. All the functions are static.
+ */
+template <typename DeviceType>
+struct RendezvousImpl
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // Bounding box of the objects of all the processes.
+    static Box
+    globalBoundingBox( Teuchos::Comm<int> const &comm,
+                       Kokkos::View<Box const *, DeviceType> bounding_boxes );
+
+    // Partition the Z-order curve into comm_size ranges holding approximately
+    // the same number of objects. The ranges are delimited by the
+    // comm_size - 1 codes returned.
+    static std::vector<unsigned int>
+    computeSplitters( Teuchos::Comm<int> const &comm,
+                      Kokkos::View<unsigned int *, DeviceType> morton_codes );
+
+    // Same as above but the ranges hold approximately the same total weight
+    // instead of the same number of objects. They are chosen from samples
+    // taken at regular intervals of the cumulative weight of the sorted
+    // local codes of every process, weighted by the share of the weight of
+    // its process that each sample represents.
+    static std::vector<unsigned int>
+    computeSplitters( Teuchos::Comm<int> const &comm,
+                      Kokkos::View<unsigned int *, DeviceType> morton_codes,
+                      Kokkos::View<double const *, DeviceType> weights );
+
+    // Send each object to the process that owns the range of the Z-order
+    // curve its centroid falls in. Return the bounding boxes of the objects
+    // received along with the rank of their original owner and their index
+    // on that process.
+    static Kokkos::View<Box *, DeviceType>
+    repartition( Teuchos::RCP<Teuchos::Comm<int> const> comm,
+                 Kokkos::View<Box const *, DeviceType> bounding_boxes,
+                 Kokkos::View<int *, DeviceType> &original_ranks,
+                 Kokkos::View<int *, DeviceType> &original_indices );
+};
+
+template <typename DeviceType>
+Box RendezvousImpl<DeviceType>::globalBoundingBox(
+    Teuchos::Comm<int> const &comm,
+    Kokkos::View<Box const *, DeviceType> bounding_boxes )
+{
+    Box local_box;
+    TreeConstruction<DeviceType>::calculateBoundingBoxOfTheScene(
+        bounding_boxes, local_box );
+
+    double local_min[3];
+    double local_max[3];
+    for ( int d = 0; d < 3; ++d )
+    {
+        local_min[d] = local_box[2 * d + 0];
+        local_max[d] = local_box[2 * d + 1];
+    }
+    double global_min[3];
+    double global_max[3];
+    Teuchos::reduceAll( comm, Teuchos::REDUCE_MIN, 3, local_min, global_min );
+    Teuchos::reduceAll( comm, Teuchos::REDUCE_MAX, 3, local_max, global_max );
+
+    Box global_box;
+    for ( int d = 0; d < 3; ++d )
+    {
+        global_box[2 * d + 0] = global_min[d];
+        global_box[2 * d + 1] = global_max[d];
+    }
+    return global_box;
+}
+
+template <typename DeviceType>
+std::vector<unsigned int> RendezvousImpl<DeviceType>::computeSplitters(
+    Teuchos::Comm<int> const &comm,
+    Kokkos::View<unsigned int *, DeviceType> morton_codes )
+{
+    Kokkos::View<double *, DeviceType> weights( "weights",
+                                                morton_codes.extent( 0 ) );
+    Kokkos::deep_copy( weights, 1. );
+    return computeSplitters( comm, morton_codes, weights );
+}
+
+template <typename DeviceType>
+std::vector<unsigned int> RendezvousImpl<DeviceType>::computeSplitters(
+    Teuchos::Comm<int> const &comm,
+    Kokkos::View<unsigned int *, DeviceType> morton_codes,
+    Kokkos::View<double const *, DeviceType> weights )
+{
+    DTK_REQUIRE( weights.extent( 0 ) == morton_codes.extent( 0 ) );
+
+    int const comm_size = comm.getSize();
+    int const n = morton_codes.extent( 0 );
+
+    auto morton_codes_host = Kokkos::create_mirror_view( morton_codes );
+    Kokkos::deep_copy( morton_codes_host, morton_codes );
+    auto weights_host = Kokkos::create_mirror_view( weights );
+    Kokkos::deep_copy( weights_host, weights );
+    std::vector<std::pair<unsigned int, double>> sorted_codes( n );
+    for ( int i = 0; i < n; ++i )
+        sorted_codes[i] = std::make_pair( morton_codes_host( i ),
+                                          weights_host( i ) );
+    std::sort( sorted_codes.begin(), sorted_codes.end() );
+
+    // sample i is the first code past the fraction i / comm_size of the
+    // local weight
+    double local_weight = 0.;
+    for ( auto const &code : sorted_codes )
+        local_weight += code.second;
+    std::vector<unsigned int> samples( comm_size, 0 );
+    double cumulative_weight = 0.;
+    for ( int i = 0, j = 0; j < n; ++j )
+    {
+        while ( i < comm_size &&
+                cumulative_weight + sorted_codes[j].second >
+                    i * local_weight / comm_size )
+            samples[i++] = sorted_codes[j].first;
+        cumulative_weight += sorted_codes[j].second;
+    }
+    std::vector<unsigned int> all_samples( comm_size * comm_size );
+    Teuchos::gatherAll( comm, comm_size, samples.data(),
+                        comm_size * comm_size, all_samples.data() );
+    std::vector<double> all_weights( comm_size );
+    Teuchos::gatherAll( comm, 1, &local_weight, comm_size,
+                        all_weights.data() );
+
+    // each sample stands for a fraction of the weight of its process
+    std::vector<std::pair<unsigned int, double>> weighted_samples;
+    weighted_samples.reserve( comm_size * comm_size );
+    double total_weight = 0.;
+    for ( int r = 0; r < comm_size; ++r )
+    {
+        total_weight += all_weights[r];
+        if ( all_weights[r] > 0. )
+            for ( int i = 0; i < comm_size; ++i )
+                weighted_samples.emplace_back( all_samples[r * comm_size + i],
+                                               all_weights[r] / comm_size );
+    }
+    std::sort( weighted_samples.begin(), weighted_samples.end() );
+
+    std::vector<unsigned int> splitters( comm_size - 1,
+                                         weighted_samples.empty()
+                                             ? 0
+                                             : weighted_samples.back().first );
+    cumulative_weight = 0.;
+    int r = 0;
+    for ( auto const &sample : weighted_samples )
+    {
+        while ( r < comm_size - 1 &&
+                cumulative_weight >= ( r + 1 ) * total_weight / comm_size )
+            splitters[r++] = sample.first;
+        cumulative_weight += sample.second;
+    }
+
+    return splitters;
+}
+
+template <typename DeviceType>
+Kokkos::View<Box *, DeviceType> RendezvousImpl<DeviceType>::repartition(
+    Teuchos::RCP<Teuchos::Comm<int> const> comm,
+    Kokkos::View<Box const *, DeviceType> bounding_boxes,
+    Kokkos::View<int *, DeviceType> &original_ranks,
+    Kokkos::View<int *, DeviceType> &original_indices )
+{
+    int const comm_rank = comm->getRank();
+    int const n = bounding_boxes.extent( 0 );
+
+    Box const global_box = globalBoundingBox( *comm, bounding_boxes );
+    Kokkos::View<unsigned int *, DeviceType> morton_codes( "morton", n );
+    TreeConstruction<DeviceType>::assignMortonCodes( bounding_boxes,
+                                                     morton_codes, global_box );
+
+    std::vector<unsigned int> const splitters =
+        computeSplitters( *comm, morton_codes );
+
+    // the objects with a code less than splitters[0] go to the first
+    // process, the ones with a code in [splitters[0], splitters[1]) go to the
+    // second, and so on
+    auto morton_codes_host = Kokkos::create_mirror_view( morton_codes );
+    Kokkos::deep_copy( morton_codes_host, morton_codes );
+    std::vector<int> destinations( n );
+    for ( int i = 0; i < n; ++i )
+        destinations[i] = std::upper_bound( splitters.begin(), splitters.end(),
+                                            morton_codes_host( i ) ) -
+                          splitters.begin();
+
+    Tpetra::Distributor distributor( comm );
+    int const n_imports = distributor.createFromSends(
+        Teuchos::ArrayView<int const>( destinations.data(), n ) );
+
+    Kokkos::View<int *, DeviceType> export_ranks( "export_ranks", n );
+    Kokkos::deep_copy( export_ranks, comm_rank );
+    Kokkos::View<int *, DeviceType> export_indices( "export_indices", n );
+    Iota<DeviceType> iota_functor( export_indices );
+    Kokkos::parallel_for( REGION_NAME( "set_indices" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n ),
+                          iota_functor );
+    Kokkos::fence();
+
+    Kokkos::View<Box *, DeviceType> imports( "rendezvous_boxes", n_imports );
+    Kokkos::realloc( original_ranks, n_imports );
+    Kokkos::realloc( original_indices, n_imports );
+    DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, bounding_boxes, imports );
+    DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_ranks, original_ranks );
+    DistributedSearchTreeImpl<DeviceType>::sendAcrossNetwork(
+        distributor, export_indices, original_indices );
+
+    return imports;
+}
+
+} // end namespace Details
+} // end namespace DataTransferKit
+
+#endif
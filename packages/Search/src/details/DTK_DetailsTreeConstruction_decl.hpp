@@ -49,6 +49,8 @@ struct TreeConstruction
     sortObjects( Kokkos::View<unsigned int *, DeviceType> morton_codes,
                  Kokkos::View<int *, DeviceType> object_ids );
 
+    // The leaf nodes must be stored right after the internal nodes (i.e. both
+    // views are subviews of the same allocation).
     static Node *generateHierarchy(
         Kokkos::View<unsigned int *, DeviceType> sorted_morton_codes,
         Kokkos::View<Node *, DeviceType> leaf_nodes,
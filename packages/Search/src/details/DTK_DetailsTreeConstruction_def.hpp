@@ -12,6 +12,7 @@
 
 #include "DTK_ConfigDefs.hpp"
 
+#include <DTK_DBC.hpp>
 #include <DTK_DetailsAlgorithms.hpp>
 #include <DTK_KokkosHelpers.hpp>
 
@@ -95,28 +96,31 @@ class GenerateHierarchyFunctor
         int split = TreeConstruction<DeviceType>::findSplit(
             _sorted_morton_codes, first, last );
 
-        // Select childA.
+        // Select childA. The leaves are stored right after the internal
+        // nodes.
 
-        Node *childA;
+        int const n_internal_nodes = _internal_nodes.extent( 0 );
+        int childA;
         if ( split == first )
-            childA = &_leaf_nodes[split];
+            childA = n_internal_nodes + split;
         else
-            childA = &_internal_nodes[split];
+            childA = split;
 
         // Select childB.
 
-        Node *childB;
+        int childB;
         if ( split + 1 == last )
-            childB = &_leaf_nodes[split + 1];
+            childB = n_internal_nodes + split + 1;
         else
-            childB = &_internal_nodes[split + 1];
+            childB = split + 1;
 
         // Record parent-child relationships.
 
-        _internal_nodes[i].children.first = childA;
-        _internal_nodes[i].children.second = childB;
-        childA->parent = &_internal_nodes[i];
-        childB->parent = &_internal_nodes[i];
+        Node *nodes = _internal_nodes.data();
+        nodes[i].children.first = childA;
+        nodes[i].children.second = childB;
+        nodes[childA].parent = i;
+        nodes[childB].parent = i;
     }
 
   private:
@@ -141,15 +145,18 @@ class CalculateBoundingBoxesFunctor
     KOKKOS_INLINE_FUNCTION
     void operator()( int const i ) const
     {
-        Node *node = _leaf_nodes[i].parent;
-        while ( node != _root )
+        // the root is the first node so that positions are also offsets from
+        // the root
+        int node = _leaf_nodes[i].parent;
+        while ( node != 0 )
         {
-            if ( Kokkos::atomic_compare_exchange_strong(
-                     &_ready_flags[node - _root], 0, 1 ) )
+            if ( Kokkos::atomic_compare_exchange_strong( &_ready_flags[node], 0,
+                                                         1 ) )
                 break;
-            for ( Node *child : {node->children.first, node->children.second} )
-                expand( node->bounding_box, child->bounding_box );
-            node = node->parent;
+            for ( int child :
+                  {_root[node].children.first, _root[node].children.second} )
+                expand( _root[node].bounding_box, _root[child].bounding_box );
+            node = _root[node].parent;
         }
         // NOTE: could stop at node != root and then just check that what we
         // computed earlier (bounding box of the scene) is indeed the union of
@@ -225,6 +232,9 @@ Node *TreeConstruction<DeviceType>::generateHierarchy(
     Kokkos::View<Node *, DeviceType> leaf_nodes,
     Kokkos::View<Node *, DeviceType> internal_nodes )
 {
+    DTK_REQUIRE( leaf_nodes.data() ==
+                 internal_nodes.data() + internal_nodes.extent( 0 ) );
+
     GenerateHierarchyFunctor<DeviceType> functor( sorted_morton_codes,
                                                   leaf_nodes, internal_nodes );
 
@@ -267,18 +277,12 @@ int TreeConstruction<DeviceType>::findSplit(
     Kokkos::View<unsigned int *, DeviceType> sorted_morton_codes, int first,
     int last )
 {
-    // Identical Morton codes => split the range in the middle.
-
-    unsigned int first_code = sorted_morton_codes[first];
-    unsigned int last_code = sorted_morton_codes[last];
-
-    if ( first_code == last_code )
-        return ( first + last ) >> 1;
-
     // Calculate the number of highest bits that are the same
-    // for all objects, using the count-leading-zeros intrinsic.
+    // for all objects. Duplicate Morton codes are augmented by the bit
+    // representation of their index, as in determineRange(), so that the
+    // split agrees with the ranges of the children.
 
-    int common_prefix = KokkosHelpers::clz( first_code ^ last_code );
+    int common_prefix = commonPrefix( sorted_morton_codes, first, last );
 
     // Use binary search to find where the next bit differs.
     // Specifically, we are looking for the highest object that
@@ -294,8 +298,8 @@ int TreeConstruction<DeviceType>::findSplit(
 
         if ( new_split < last )
         {
-            unsigned int split_code = sorted_morton_codes[new_split];
-            int split_prefix = KokkosHelpers::clz( first_code ^ split_code );
+            int split_prefix =
+                commonPrefix( sorted_morton_codes, first, new_split );
             if ( split_prefix > common_prefix )
                 split = new_split; // accept proposal
         }
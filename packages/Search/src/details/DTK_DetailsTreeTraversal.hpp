@@ -19,10 +19,20 @@
 
 #include <DTK_LinearBVH.hpp>
 
+#include <type_traits>
+#include <utility>
+
 namespace DataTransferKit
 {
 namespace Details
 {
+template <typename DeviceType, typename Geometry, typename LeafDistance,
+          typename Insert>
+KOKKOS_FUNCTION int nearest_query( BVH<DeviceType> const bvh,
+                                   Geometry const &geometry, int k,
+                                   LeafDistance const &leaf_distance,
+                                   Insert const &insert );
+
 template <typename DeviceType>
 struct TreeTraversal
 {
@@ -35,20 +45,61 @@ struct TreeTraversal
                                              Insert const &insert )
     {
         using Tag = typename Predicate::Tag;
+        if ( bvh.empty() )
+            return 0;
         return query_dispatch( bvh, pred, insert, Tag{} );
     }
 
+    /**
+     * Find the k objects nearest to the geometry when the distance to an
+     * object, leaf_distance(index, bounding_box), is not that to its
+     * bounding box but e.g. the exact distance to the object. The callback
+     * insert(index, distance) is called for each of them by increasing
+     * distance.
+     */
+    template <typename Geometry, typename LeafDistance, typename Insert>
+    KOKKOS_INLINE_FUNCTION static int
+    queryNearest( BVH<DeviceType> const bvh, Geometry const &geometry, int k,
+                  LeafDistance const &leaf_distance, Insert const &insert )
+    {
+        if ( bvh.empty() )
+            return 0;
+        return nearest_query( bvh, geometry, k, leaf_distance, insert );
+    }
+
+    /**
+     * Return true if at least one object meets the predicate. The traversal
+     * terminates as soon as a leaf is accepted.
+     */
+    template <typename Predicate>
+    KOKKOS_INLINE_FUNCTION static bool queryAny( BVH<DeviceType> const bvh,
+                                                 Predicate const &pred )
+    {
+        static_assert(
+            std::is_same<typename Predicate::Tag, SpatialPredicateTag>::value,
+            "any-hit queries are only supported for spatial predicates" );
+        if ( bvh.empty() )
+            return false;
+        return spatial_query_any( bvh, pred );
+    }
+
     /**
      * Return true if the node is a leaf.
      */
     KOKKOS_INLINE_FUNCTION
     static bool isLeaf( BVH<DeviceType> bvh, Node const *node )
     {
-        // COMMENT: could also check that pointer is in the range [leaf_nodes,
-        // leaf_nodes+n]
         (void)bvh;
-        return ( node->children.first == nullptr ) &&
-               ( node->children.second == nullptr );
+        return ( node->children.first < 0 ) && ( node->children.second < 0 );
+    }
+
+    /**
+     * Return the node at the given position in the hierarchy.
+     */
+    KOKKOS_INLINE_FUNCTION
+    static Node const *getNode( BVH<DeviceType> bvh, int i )
+    {
+        return bvh._internal_nodes.data() + i;
     }
 
     /**
@@ -61,11 +112,14 @@ struct TreeTraversal
     }
 
     /**
-     * Return the root node of the BVH.
+     * Return the root node of the BVH. It is a leaf if the BVH stores a
+     * single object.
      */
     KOKKOS_INLINE_FUNCTION
     static Node const *getRoot( BVH<DeviceType> bvh )
     {
+        if ( bvh.size() == 1 )
+            return bvh._leaf_nodes.data();
         return bvh._internal_nodes.data();
     }
 };
@@ -81,6 +135,8 @@ KOKKOS_FUNCTION int spatial_query( BVH<DeviceType> const bvh,
     Stack<Node const *> stack;
 
     Node const *node = TreeTraversal<DeviceType>::getRoot( bvh );
+    if ( TreeTraversal<DeviceType>::isLeaf( bvh, node ) && !predicate( node ) )
+        return 0;
     stack.push( node );
     int count = 0;
 
@@ -96,9 +152,10 @@ KOKKOS_FUNCTION int spatial_query( BVH<DeviceType> const bvh,
         }
         else
         {
-            for ( Node const *child :
-                  {node->children.first, node->children.second} )
+            for ( int const i : {node->children.first, node->children.second} )
             {
+                Node const *child =
+                    TreeTraversal<DeviceType>::getNode( bvh, i );
                 if ( predicate( child ) )
                 {
                     stack.push( child );
@@ -109,10 +166,49 @@ KOKKOS_FUNCTION int spatial_query( BVH<DeviceType> const bvh,
     return count;
 }
 
-// query k nearest neighbours
-template <typename DeviceType, typename Insert>
+// Same as spatial_query() but returns as soon as one leaf meets the predicate
+// instead of visiting all of them.
+template <typename DeviceType, typename Predicate>
+KOKKOS_FUNCTION bool spatial_query_any( BVH<DeviceType> const bvh,
+                                        Predicate const &predicate )
+{
+    Stack<Node const *> stack;
+
+    Node const *node = TreeTraversal<DeviceType>::getRoot( bvh );
+    if ( TreeTraversal<DeviceType>::isLeaf( bvh, node ) )
+        return predicate( node );
+    stack.push( node );
+
+    while ( !stack.empty() )
+    {
+        node = stack.top();
+        stack.pop();
+
+        if ( TreeTraversal<DeviceType>::isLeaf( bvh, node ) )
+            return true;
+
+        for ( int const i : {node->children.first, node->children.second} )
+        {
+            Node const *child = TreeTraversal<DeviceType>::getNode( bvh, i );
+            if ( predicate( child ) )
+            {
+                stack.push( child );
+            }
+        }
+    }
+    return false;
+}
+
+// query k nearest neighbours, the distance to an object being given by
+// leaf_distance(index, bounding_box). It may be tighter than the distance to
+// the bounding box, e.g. the exact distance to a triangle, since the distance
+// to the box of a node is a lower bound of the distances to all the objects
+// below it. The leaves still come out of the queue sorted.
+template <typename DeviceType, typename Geometry, typename LeafDistance,
+          typename Insert>
 KOKKOS_FUNCTION int nearest_query( BVH<DeviceType> const bvh,
-                                   Point const &query_point, int k,
+                                   Geometry const &geometry, int k,
+                                   LeafDistance const &leaf_distance,
                                    Insert const &insert )
 {
     using PairNodePtrDistance = Kokkos::pair<Node const *, double>;
@@ -130,9 +226,14 @@ KOKKOS_FUNCTION int nearest_query( BVH<DeviceType> const bvh,
     PriorityQueue<PairNodePtrDistance, CompareDistance> queue;
     // priority does not matter for the root since the node will be
     // processed directly and removed from the priority queue we don't even
-    // bother computing the distance to it
+    // bother computing the distance to it unless it is a leaf that gets
+    // reported
     Node const *node = TreeTraversal<DeviceType>::getRoot( bvh );
-    double node_distance = 0.0;
+    double node_distance =
+        TreeTraversal<DeviceType>::isLeaf( bvh, node )
+            ? leaf_distance( TreeTraversal<DeviceType>::getIndex( bvh, node ),
+                             node->bounding_box )
+            : 0.0;
     queue.push( node, node_distance );
     int count = 0;
 
@@ -140,21 +241,29 @@ KOKKOS_FUNCTION int nearest_query( BVH<DeviceType> const bvh,
     {
         // get the node that is on top of the priority list (i.e. is the
         // closest to the query point)
-        node = queue.top().first; // std::tie(node, std::ignore) = ...
+        node = queue.top().first;
+        node_distance = queue.top().second;
         queue.pop();
         if ( TreeTraversal<DeviceType>::isLeaf( bvh, node ) )
         {
-            insert( TreeTraversal<DeviceType>::getIndex( bvh, node ) );
+            insert( TreeTraversal<DeviceType>::getIndex( bvh, node ),
+                    node_distance );
             count++;
         }
         else
         {
             // insert children of the node in the priority list
-            for ( Node const *child :
-                  {node->children.first, node->children.second} )
+            for ( int const i : {node->children.first, node->children.second} )
             {
+                Node const *child =
+                    TreeTraversal<DeviceType>::getNode( bvh, i );
                 double child_distance =
-                    distance( query_point, child->bounding_box );
+                    TreeTraversal<DeviceType>::isLeaf( bvh, child )
+                        ? leaf_distance(
+                              TreeTraversal<DeviceType>::getIndex( bvh,
+                                                                   child ),
+                              child->bounding_box )
+                        : distance( geometry, child->bounding_box );
                 queue.push( child, child_distance );
             }
         }
@@ -162,6 +271,123 @@ KOKKOS_FUNCTION int nearest_query( BVH<DeviceType> const bvh,
     return count;
 }
 
+template <typename DeviceType, typename Geometry, typename Insert>
+KOKKOS_FUNCTION int nearest_query( BVH<DeviceType> const bvh,
+                                   Geometry const &geometry, int k,
+                                   Insert const &insert )
+{
+    return nearest_query(
+        bvh, geometry, k,
+        [&geometry]( int, Box const &bounding_box ) {
+            return distance( geometry, bounding_box );
+        },
+        insert );
+}
+
+// query k approximate nearest neighbours, i.e. the distance to the i-th
+// object found is within a factor (1 + eps) of the distance to the true i-th
+// nearest neighbour
+template <typename DeviceType, typename Geometry, typename Insert>
+KOKKOS_FUNCTION int
+approx_nearest_query( BVH<DeviceType> const bvh, Geometry const &geometry,
+                      int k, double eps, Insert const &insert )
+{
+    using PairNodePtrDistance = Kokkos::pair<Node const *, double>;
+    using PairIndexDistance = Kokkos::pair<int, double>;
+
+    struct CompareDistance
+    {
+        KOKKOS_INLINE_FUNCTION bool operator()( PairNodePtrDistance const &lhs,
+                                                PairNodePtrDistance const &rhs )
+        {
+            // reverse order (larger distance means lower priority)
+            return lhs.second > rhs.second;
+        }
+    };
+
+    struct CompareCandidateDistance
+    {
+        KOKKOS_INLINE_FUNCTION bool operator()( PairIndexDistance const &lhs,
+                                                PairIndexDistance const &rhs )
+        {
+            // the candidate that is the furthest away is on top so that it
+            // gets evicted first
+            return lhs.second < rhs.second;
+        }
+    };
+
+    if ( k < 1 )
+        return 0;
+
+    // best k objects found so far, fall back to the exact search when they
+    // do not fit in the queue
+    using CandidateQueue =
+        PriorityQueue<PairIndexDistance, CompareCandidateDistance>;
+    if ( k > static_cast<int>( CandidateQueue::maxSize() ) )
+        return nearest_query( bvh, geometry, k, insert );
+    CandidateQueue candidates;
+    auto const consider = [&candidates, k]( int index, double distance ) {
+        if ( static_cast<int>( candidates.size() ) < k )
+            candidates.push( index, distance );
+        else if ( distance < candidates.top().second )
+        {
+            candidates.pop();
+            candidates.push( index, distance );
+        }
+    };
+    // a node is worth visiting only if it may contain an object closer than
+    // the current k-th candidate by more than a factor (1 + eps)
+    auto const prune = [&candidates, k, eps]( double distance ) {
+        return static_cast<int>( candidates.size() ) == k &&
+               distance * ( 1. + eps ) >= candidates.top().second;
+    };
+
+    PriorityQueue<PairNodePtrDistance, CompareDistance> queue;
+    Node const *root = TreeTraversal<DeviceType>::getRoot( bvh );
+    queue.push( root, distance( geometry, root->bounding_box ) );
+    while ( !queue.empty() )
+    {
+        Node const *node = queue.top().first;
+        double const node_distance = queue.top().second;
+        queue.pop();
+        // nodes come out of the queue sorted by distance so none of the
+        // remaining ones can improve the result
+        if ( prune( node_distance ) )
+            break;
+        if ( TreeTraversal<DeviceType>::isLeaf( bvh, node ) )
+        {
+            consider( TreeTraversal<DeviceType>::getIndex( bvh, node ),
+                      node_distance );
+            continue;
+        }
+        for ( int const i : {node->children.first, node->children.second} )
+        {
+            Node const *child = TreeTraversal<DeviceType>::getNode( bvh, i );
+            double const child_distance =
+                distance( geometry, child->bounding_box );
+            // leaves are processed right away to tighten the bound early
+            if ( TreeTraversal<DeviceType>::isLeaf( bvh, child ) )
+                consider( TreeTraversal<DeviceType>::getIndex( bvh, child ),
+                          child_distance );
+            else if ( !prune( child_distance ) )
+                queue.push( child, child_distance );
+        }
+    }
+
+    // the furthest candidate is on top, report them by increasing distance
+    // like nearest_query does
+    PairIndexDistance sorted[CandidateQueue::maxSize()];
+    int const count = candidates.size();
+    for ( int i = count - 1; i >= 0; --i )
+    {
+        sorted[i] = candidates.top();
+        candidates.pop();
+    }
+    for ( int i = 0; i < count; ++i )
+        insert( sorted[i].first, sorted[i].second );
+    return count;
+}
+
 template <typename DeviceType, typename Predicate, typename Insert>
 KOKKOS_INLINE_FUNCTION int
 query_dispatch( BVH<DeviceType> const bvh, Predicate const &pred,
@@ -170,12 +396,67 @@ query_dispatch( BVH<DeviceType> const bvh, Predicate const &pred,
     return spatial_query( bvh, pred, insert );
 }
 
+// The nearest searches report the distance to the objects found along with
+// their index. Callbacks that only accept the index are wrapped.
+template <typename Insert, typename = void>
+struct AcceptsDistance : std::false_type
+{
+};
+
+template <typename Insert>
+struct AcceptsDistance<
+    Insert, decltype( std::declval<Insert const &>()( 0, 0. ), void() )>
+    : std::true_type
+{
+};
+
+template <typename Insert>
+struct IgnoreDistance
+{
+    KOKKOS_INLINE_FUNCTION void operator()( int index, double ) const
+    {
+        _insert( index );
+    }
+
+    Insert const &_insert;
+};
+
+template <typename Insert>
+KOKKOS_INLINE_FUNCTION typename std::enable_if<AcceptsDistance<Insert>::value,
+                                               Insert const &>::type
+withDistance( Insert const &insert )
+{
+    return insert;
+}
+
+template <typename Insert>
+KOKKOS_INLINE_FUNCTION typename std::enable_if<!AcceptsDistance<Insert>::value,
+                                               IgnoreDistance<Insert>>::type
+withDistance( Insert const &insert )
+{
+    return {insert};
+}
+
 template <typename DeviceType, typename Predicate, typename Insert>
 KOKKOS_INLINE_FUNCTION int
 query_dispatch( BVH<DeviceType> const bvh, Predicate const &pred,
                 Insert const &insert, NearestPredicateTag )
 {
-    return nearest_query( bvh, pred._query_point, pred._k, insert );
+    if ( pred._eps > 0. )
+        return approx_nearest_query( bvh, pred._geometry, pred._k, pred._eps,
+                                     withDistance( insert ) );
+    return nearest_query( bvh, pred._geometry, pred._k,
+                          withDistance( insert ) );
+}
+
+template <typename DeviceType, typename Predicate, typename Insert>
+KOKKOS_INLINE_FUNCTION int
+query_dispatch( BVH<DeviceType> const bvh, Predicate const &pred,
+                Insert const &insert, VariantPredicateTag )
+{
+    if ( pred.index() == 0 )
+        return TreeTraversal<DeviceType>::query( bvh, pred.first(), insert );
+    return TreeTraversal<DeviceType>::query( bvh, pred.second(), insert );
 }
 
 } // end namespace Details
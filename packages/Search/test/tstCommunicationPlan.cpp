@@ -0,0 +1,110 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_CommunicationPlan.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <utility>
+#include <vector>
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( CommunicationPlan, exchange, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Each process owns n objects. It requests about half of the objects of
+    // every process, interleaving the processes and in decreasing order of
+    // local index, except for the last process that does not request
+    // anything.
+    int const n = 5;
+    std::vector<std::pair<int, int>> requests;
+    if ( comm_size == 1 || comm_rank != comm_size - 1 )
+        for ( int i = 0; i < n; ++i )
+            for ( int r = 0; r < comm_size; ++r )
+                if ( ( i + r + comm_rank ) % 2 == 0 )
+                    requests.emplace_back( r, n - 1 - i );
+    int const n_requests = requests.size();
+
+    Kokkos::View<int *, DeviceType> ranks( "ranks", n_requests );
+    Kokkos::View<int *, DeviceType> indices( "indices", n_requests );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    for ( int j = 0; j < n_requests; ++j )
+    {
+        ranks_host( j ) = requests[j].first;
+        indices_host( j ) = requests[j].second;
+    }
+    Kokkos::deep_copy( ranks, ranks_host );
+    Kokkos::deep_copy( indices, indices_host );
+
+    DataTransferKit::CommunicationPlan<DeviceType> plan( comm, ranks,
+                                                         indices );
+    TEST_EQUALITY( plan.getNumImports(), static_cast<size_t>( n_requests ) );
+
+    // the plan is built once and used for several exchanges
+    Kokkos::View<double *, DeviceType> source( "source", n );
+    Kokkos::View<double *, DeviceType> target( "target", n_requests );
+    auto source_host = Kokkos::create_mirror_view( source );
+    auto target_host = Kokkos::create_mirror_view( target );
+    for ( int step = 0; step < 3; ++step )
+    {
+        for ( int i = 0; i < n; ++i )
+            source_host( i ) = 100. * step + 10. * comm_rank + i;
+        Kokkos::deep_copy( source, source_host );
+
+        plan.doExchange( source, target );
+
+        Kokkos::deep_copy( target_host, target );
+        for ( int j = 0; j < n_requests; ++j )
+            TEST_EQUALITY( target_host( j ), 100. * step +
+                                                 10. * requests[j].first +
+                                                 requests[j].second );
+    }
+
+    // values with several components
+    int const n_components = 3;
+    Kokkos::View<int **, DeviceType> source_field( "source_field", n,
+                                                   n_components );
+    Kokkos::View<int **, DeviceType> target_field( "target_field",
+                                                   n_requests, n_components );
+    auto source_field_host = Kokkos::create_mirror_view( source_field );
+    for ( int i = 0; i < n; ++i )
+        for ( int d = 0; d < n_components; ++d )
+            source_field_host( i, d ) = 100 * comm_rank + 10 * i + d;
+    Kokkos::deep_copy( source_field, source_field_host );
+
+    plan.doExchange( source_field, target_field );
+
+    auto target_field_host = Kokkos::create_mirror_view( target_field );
+    Kokkos::deep_copy( target_field_host, target_field );
+    for ( int j = 0; j < n_requests; ++j )
+        for ( int d = 0; d < n_components; ++d )
+            TEST_EQUALITY( target_field_host( j, d ),
+                           100 * requests[j].first + 10 * requests[j].second +
+                               d );
+}
+
+// Include the test macros.
+#include "DataTransferKitSearch_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( CommunicationPlan, exchange,         \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -37,6 +37,26 @@ TEUCHOS_UNIT_TEST( DetailsAlgorithms, distance )
     TEST_EQUALITY(
         dtk::distance( DataTransferKit::Point( {-1.0, 2.0, 2.0} ), box ),
         std::sqrt( 3.0 ) );
+
+    // distance is zero if the boxes overlap
+    TEST_EQUALITY(
+        dtk::distance( DataTransferKit::Box( {0.5, 2.0, 0.5, 2.0, 0.5, 2.0} ),
+                       box ),
+        0.0 );
+    // or only share a face
+    TEST_EQUALITY(
+        dtk::distance( DataTransferKit::Box( {1.0, 2.0, 0.0, 1.0, 0.0, 1.0} ),
+                       box ),
+        0.0 );
+    // gap along one direction
+    TEST_EQUALITY(
+        dtk::distance( DataTransferKit::Box( {-3.0, -1.0, 0.5, 2.0, 0.0, 1.0} ),
+                       box ),
+        1.0 );
+    // gap along every direction (corner to corner) and symmetry
+    DataTransferKit::Box other( {2.0, 3.0, 2.0, 3.0, -2.0, -1.0} );
+    TEST_EQUALITY( dtk::distance( box, other ), std::sqrt( 3.0 ) );
+    TEST_EQUALITY( dtk::distance( other, box ), std::sqrt( 3.0 ) );
 }
 
 TEUCHOS_UNIT_TEST( DetailsAlgorithms, overlaps )
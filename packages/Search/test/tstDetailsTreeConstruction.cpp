@@ -289,26 +289,24 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsBVH, example_tree_construction,
     std::cout << "ref=" << ref.str() << "\n";
 
     // hierarchy generation
-    Kokkos::View<DataTransferKit::Node *, DeviceType> leaf_nodes( "leaf_nodes",
-                                                                  n );
-    Kokkos::View<DataTransferKit::Node *, DeviceType> internal_nodes(
-        "internal_nodes", n - 1 );
-    std::function<void( DataTransferKit::Node *, std::ostream & )>
-        traverseRecursive;
-    traverseRecursive = [&leaf_nodes, &internal_nodes, &traverseRecursive](
-        DataTransferKit::Node *node, std::ostream &os ) {
-        if ( std::any_of( leaf_nodes.data(), leaf_nodes.data() + n,
-                          [node]( DataTransferKit::Node const &leaf_node ) {
-                              return std::addressof( leaf_node ) == node;
-                          } ) )
+    Kokkos::View<DataTransferKit::Node *, DeviceType> nodes( "nodes",
+                                                             2 * n - 1 );
+    Kokkos::View<DataTransferKit::Node *, DeviceType> internal_nodes =
+        Kokkos::subview( nodes, Kokkos::make_pair( 0, n - 1 ) );
+    Kokkos::View<DataTransferKit::Node *, DeviceType> leaf_nodes =
+        Kokkos::subview( nodes, Kokkos::make_pair( n - 1, 2 * n - 1 ) );
+    std::function<void( int, std::ostream & )> traverseRecursive;
+    traverseRecursive = [&nodes, &traverseRecursive]( int i,
+                                                      std::ostream &os ) {
+        if ( i >= n - 1 )
         {
-            os << "L" << node - leaf_nodes.data();
+            os << "L" << i - ( n - 1 );
         }
         else
         {
-            os << "I" << node - internal_nodes.data();
-            for ( DataTransferKit::Node *child :
-                  {node->children.first, node->children.second} )
+            os << "I" << i;
+            for ( int child :
+                  {nodes[i].children.first, nodes[i].children.second} )
                 traverseRecursive( child, os );
         }
     };
@@ -317,15 +315,58 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsBVH, example_tree_construction,
         sorted_morton_codes, leaf_nodes, internal_nodes );
 
     DataTransferKit::Node *root = internal_nodes.data();
-    TEST_ASSERT( root->parent == nullptr );
+    TEST_EQUALITY( root->parent, -1 );
 
     std::ostringstream sol;
-    traverseRecursive( root, sol );
+    traverseRecursive( 0, sol );
     std::cout << "sol=" << sol.str() << "\n";
 
     TEST_EQUALITY( sol.str().compare( ref.str() ), 0 );
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsBVH, duplicate_morton_codes,
+                                   DeviceType )
+{
+    // objects with identical bounding boxes, e.g. the tetrahedra obtained by
+    // cutting a hexahedron, have identical Morton codes
+    int const n = 11;
+    Kokkos::View<unsigned int *, DeviceType> sorted_morton_codes(
+        "sorted_morton_codes", n );
+    std::vector<unsigned int> codes{1, 1, 1, 1, 1, 1, 2, 2, 2, 5, 5};
+    for ( int i = 0; i < n; ++i )
+        sorted_morton_codes[i] = codes[i];
+
+    Kokkos::View<DataTransferKit::Node *, DeviceType> nodes( "nodes",
+                                                             2 * n - 1 );
+    Kokkos::View<DataTransferKit::Node *, DeviceType> internal_nodes =
+        Kokkos::subview( nodes, Kokkos::make_pair( 0, n - 1 ) );
+    Kokkos::View<DataTransferKit::Node *, DeviceType> leaf_nodes =
+        Kokkos::subview( nodes, Kokkos::make_pair( n - 1, 2 * n - 1 ) );
+    dtk::TreeConstruction<DeviceType>::generateHierarchy(
+        sorted_morton_codes, leaf_nodes, internal_nodes );
+
+    // every node but the root is the child of its parent and the traversal
+    // from the root visits each leaf exactly once
+    TEST_EQUALITY( nodes[0].parent, -1 );
+    std::vector<int> visits( 2 * n - 1, 0 );
+    std::vector<int> stack{0};
+    while ( !stack.empty() )
+    {
+        int const i = stack.back();
+        stack.pop_back();
+        ++visits[i];
+        if ( i < n - 1 )
+            for ( int child :
+                  {nodes[i].children.first, nodes[i].children.second} )
+            {
+                TEST_EQUALITY( nodes[child].parent, i );
+                stack.push_back( child );
+            }
+    }
+    for ( int i = 0; i < 2 * n - 1; ++i )
+        TEST_EQUALITY( visits[i], 1 );
+}
+
 // Include the test macros.
 #include "DataTransferKitSearch_ETIHelperMacros.h"
 
@@ -341,7 +382,9 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsBVH, example_tree_construction,
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsBVH, common_prefix,           \
                                           DeviceType##NODE )                   \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
-        DetailsBVH, example_tree_construction, DeviceType##NODE )
+        DetailsBVH, example_tree_construction, DeviceType##NODE )             \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsBVH, duplicate_morton_codes,  \
+                                          DeviceType##NODE )
 // Demangle the types
 DTK_ETI_MANGLING_TYPEDEFS()
 
@@ -0,0 +1,344 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_DistributedSearchTree.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_Time.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace details = DataTransferKit::Details;
+
+template <typename DeviceType>
+std::set<std::pair<int, int>>
+gatherResults( Kokkos::View<int *, DeviceType> indices,
+               Kokkos::View<int *, DeviceType> offset,
+               Kokkos::View<int *, DeviceType> ranks, int q )
+{
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    std::set<std::pair<int, int>> results;
+    for ( int j = offset_host( q ); j < offset_host( q + 1 ); ++j )
+        results.emplace( ranks_host( j ), indices_host( j ) );
+    return results;
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DistributedSearchTree, within, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Each process owns n points aligned along the x-axis. The point with
+    // global index g = rank * n + i is located at x = g.
+    int const n = 10;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n; ++i )
+    {
+        double const x = comm_rank * n + i;
+        boxes_host( i ) = {x, x, 0., 0., 0., 0.};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::DistributedSearchTree<DeviceType> tree( comm, boxes );
+
+    // The first query is centered between the last point of this process
+    // and the first one of the next one with a radius large enough to
+    // capture points on three processes. The second one does not find
+    // anything.
+    double const x_0 = ( comm_rank + 1 ) * n - .5;
+    double const radius = 1.2 * n;
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        queries( "queries", 2 );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    queries_host( 0 ) = details::within( {x_0, 0., 0.}, radius );
+    queries_host( 1 ) = details::within( {x_0, 1., 1.}, .5 );
+    Kokkos::deep_copy( queries, queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    TEST_EQUALITY( offset.extent( 0 ), 3 );
+    TEST_EQUALITY( indices.extent( 0 ), ranks.extent( 0 ) );
+
+    std::set<std::pair<int, int>> ref;
+    for ( int g = 0; g < comm_size * n; ++g )
+        if ( std::abs( g - x_0 ) <= radius )
+            ref.emplace( g / n, g % n );
+    TEST_ASSERT( gatherResults( indices, offset, ranks, 0 ) == ref );
+    TEST_ASSERT( gatherResults( indices, offset, ranks, 1 ).empty() );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DistributedSearchTree, negation,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // same points as in the within test
+    int const n = 10;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n; ++i )
+    {
+        double const x = comm_rank * n + i;
+        boxes_host( i ) = {x, x, 0., 0., 0., 0.};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::DistributedSearchTree<DeviceType> tree( comm, boxes );
+
+    // Same as the first query of the within test but the first half of the
+    // points of this process are excluded. The scene box of the process
+    // overlaps the excluded box and yet the process owns points that meet
+    // the predicate.
+    double const x_0 = ( comm_rank + 1 ) * n - .5;
+    double const radius = 1.2 * n;
+    DataTransferKit::Box const excluded( {comm_rank * n - .5,
+                                          comm_rank * n + n / 2 - .5, -1., 1.,
+                                          -1., 1.} );
+    auto const query = details::within( {x_0, 0., 0.}, radius ) &&
+                       !details::overlap( excluded );
+    Kokkos::View<decltype( query ) *, DeviceType> queries( "queries", 1 );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    queries_host( 0 ) = query;
+    Kokkos::deep_copy( queries, queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    std::set<std::pair<int, int>> ref;
+    for ( int g = 0; g < comm_size * n; ++g )
+        if ( std::abs( g - x_0 ) <= radius &&
+             !( g / n == comm_rank && g % n < n / 2 ) )
+            ref.emplace( g / n, g % n );
+    TEST_ASSERT( gatherResults( indices, offset, ranks, 0 ) == ref );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DistributedSearchTree, empty_processes,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // only processes with an even rank own an object, which is a unit cube
+    // at (rank, 0, 0)
+    int const n = ( comm_rank % 2 == 0 ) ? 1 : 0;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    if ( n > 0 )
+        boxes_host( 0 ) = {comm_rank - .5, comm_rank + .5, -.5, .5, -.5, .5};
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::DistributedSearchTree<DeviceType> tree( comm, boxes );
+
+    // every process searches for everything
+    Kokkos::View<details::Overlap *, DeviceType> queries( "queries", 1 );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    queries_host( 0 ) = details::overlap(
+        DataTransferKit::Box( {-1., comm_size + 1., -1., 1., -1., 1.} ) );
+    Kokkos::deep_copy( queries, queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( queries, indices, offset, ranks );
+
+    std::set<std::pair<int, int>> ref;
+    for ( int r = 0; r < comm_size; r += 2 )
+        ref.emplace( r, 0 );
+    TEST_ASSERT( gatherResults( indices, offset, ranks, 0 ) == ref );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DistributedSearchTree, nearest, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Each process owns n points aligned along the x-axis at x = rank * n + i
+    // and an extra one at x = -1 so that the scene boxes all overlap and the
+    // closest process is not necessarily the one that owns the nearest
+    // neighbor.
+    int const n = 4;
+    auto coordinate = [n]( int rank, int i ) {
+        return ( i < n ) ? rank * n + i : -1.;
+    };
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n + 1 );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n + 1; ++i )
+    {
+        double const x = coordinate( comm_rank, i );
+        boxes_host( i ) = {x, x, 0., 0., 0., 0.};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::DistributedSearchTree<DeviceType> tree( comm, boxes );
+
+    // the last query asks for more neighbors than there are objects
+    double const x_0 = ( comm_size - comm_rank ) * n - 1.5;
+    std::vector<int> const k = {1, n + 2, ( n + 1 ) * comm_size + 3};
+    int const n_queries = k.size();
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        queries( "queries", n_queries );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    for ( int q = 0; q < n_queries; ++q )
+        queries_host( q ) = details::nearest( {x_0, 1., 0.}, k[q] );
+    Kokkos::deep_copy( queries, queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    Kokkos::View<double *, DeviceType> distances( "distances" );
+    tree.query( queries, indices, offset, ranks, distances );
+
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    auto distances_host = Kokkos::create_mirror_view( distances );
+    Kokkos::deep_copy( distances_host, distances );
+
+    // brute force
+    std::vector<double> ref;
+    for ( int r = 0; r < comm_size; ++r )
+        for ( int i = 0; i < n + 1; ++i )
+            ref.push_back( std::hypot( coordinate( r, i ) - x_0, 1. ) );
+    std::sort( ref.begin(), ref.end() );
+
+    TEST_EQUALITY( offset_host.extent( 0 ), n_queries + 1 );
+    for ( int q = 0; q < n_queries; ++q )
+    {
+        int const n_found = offset_host( q + 1 ) - offset_host( q );
+        TEST_EQUALITY( n_found, std::min<int>( k[q], ref.size() ) );
+        for ( int j = offset_host( q ); j < offset_host( q + 1 ); ++j )
+        {
+            // objects are sorted by distance and the distances reported are
+            // consistent with the objects found
+            TEST_FLOATING_EQUALITY( distances_host( j ),
+                                    ref[j - offset_host( q )], 1e-14 );
+            TEST_FLOATING_EQUALITY(
+                distances_host( j ),
+                std::hypot(
+                    coordinate( ranks_host( j ), indices_host( j ) ) - x_0,
+                    1. ),
+                1e-14 );
+        }
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DistributedSearchTree, pipelined,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Same points as in the within test except that the processes with an
+    // odd rank do not own any.
+    int const n = ( comm_rank % 2 == 0 ) ? 10 : 0;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes", n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n; ++i )
+    {
+        double const x = comm_rank * 10 + i;
+        boxes_host( i ) = {x, x, 0., 0., 0., 0.};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::DistributedSearchTree<DeviceType> tree( comm, boxes );
+
+    // several queries per process, some of them do not find anything
+    int const n_queries = 5;
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        queries( "queries", n_queries );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    for ( int q = 0; q < n_queries; ++q )
+        queries_host( q ) = details::within(
+            {10. * ( comm_rank + q ) - .5, 0., q % 2 ? 0. : 1.}, 12. );
+    Kokkos::deep_copy( queries, queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    DataTransferKit::QueryPipelineTimings timings;
+    double const start = Teuchos::Time::wallTime();
+    tree.pipelinedQuery( queries, indices, offset, ranks, timings );
+    double const total = Teuchos::Time::wallTime() - start;
+
+    // the stages are timed one after the other within the query
+    double const stages[5] = {timings.find_destinations,
+                              timings.post_communication,
+                              timings.local_search, timings.wait,
+                              timings.sort_results};
+    for ( double const stage : stages )
+    {
+        TEST_COMPARE( stage, >=, 0. );
+        TEST_COMPARE( stage, <=, total );
+    }
+
+    Kokkos::View<int *, DeviceType> ref_indices( "ref_indices" );
+    Kokkos::View<int *, DeviceType> ref_offset( "ref_offset" );
+    Kokkos::View<int *, DeviceType> ref_ranks( "ref_ranks" );
+    tree.query( queries, ref_indices, ref_offset, ref_ranks );
+
+    TEST_EQUALITY( offset.extent( 0 ), n_queries + 1 );
+    TEST_EQUALITY( indices.extent( 0 ), ref_indices.extent( 0 ) );
+    for ( int q = 0; q < n_queries; ++q )
+        TEST_ASSERT( gatherResults( indices, offset, ranks, q ) ==
+                     gatherResults( ref_indices, ref_offset, ref_ranks, q ) );
+    if ( comm_size > 1 )
+        TEST_ASSERT( !gatherResults( indices, offset, ranks, 1 ).empty() );
+}
+
+// Include the test macros.
+#include "DataTransferKitSearch_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DistributedSearchTree, within,       \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DistributedSearchTree, negation,     \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DistributedSearchTree,               \
+                                          empty_processes, DeviceType##NODE )  \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DistributedSearchTree, nearest,      \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DistributedSearchTree, pipelined,    \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_GlobalIdDirectory.hpp>
+
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( GlobalIdDirectory, owners, DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Each process owns the global ids rank * n + i stored in reverse order,
+    // plus a ghost copy of the last global id of the previous process.
+    int const n = 7;
+    int const n_local = ( comm_rank > 0 ) ? n + 1 : n;
+    Kokkos::View<DataTransferKit::GlobalOrdinal *, DeviceType> global_ids(
+        "global_ids", n_local );
+    auto global_ids_host = Kokkos::create_mirror_view( global_ids );
+    for ( int i = 0; i < n; ++i )
+        global_ids_host( i ) = comm_rank * n + n - 1 - i;
+    if ( comm_rank > 0 )
+        global_ids_host( n ) = comm_rank * n - 1;
+    Kokkos::deep_copy( global_ids, global_ids_host );
+
+    DataTransferKit::GlobalIdDirectory<DeviceType> directory( comm,
+                                                              global_ids );
+
+    // the ghost copies are not stored twice
+    int n_entries = 0;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_SUM,
+                        static_cast<int>( directory.size() ),
+                        Teuchos::ptr( &n_entries ) );
+    TEST_EQUALITY( n_entries, comm_size * n );
+
+    // every process asks for all the global ids in decreasing order, and for
+    // one that does not exist
+    int const n_queries = comm_size * n + 1;
+    Kokkos::View<DataTransferKit::GlobalOrdinal *, DeviceType> queries(
+        "queries", n_queries );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    for ( int j = 0; j < n_queries; ++j )
+        queries_host( j ) = n_queries - 1 - j + ( j == 0 ? 10 : 0 );
+    Kokkos::deep_copy( queries, queries_host );
+
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    directory.query( queries, ranks, indices );
+
+    TEST_EQUALITY( ranks.extent( 0 ), n_queries );
+    TEST_EQUALITY( indices.extent( 0 ), n_queries );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    TEST_EQUALITY( ranks_host( 0 ), -1 );
+    TEST_EQUALITY( indices_host( 0 ), -1 );
+    for ( int j = 1; j < n_queries; ++j )
+    {
+        int const id = queries_host( j );
+        TEST_EQUALITY( ranks_host( j ), id / n );
+        TEST_EQUALITY( indices_host( j ), n - 1 - id % n );
+    }
+}
+
+// Include the test macros.
+#include "DataTransferKitSearch_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( GlobalIdDirectory, owners,           \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
@@ -0,0 +1,138 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_DistributedSearchTree.hpp>
+#include <DTK_HybridSearchTree.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <set>
+#include <utility>
+
+namespace details = DataTransferKit::Details;
+
+template <typename DeviceType>
+std::set<std::pair<int, int>>
+gatherResults( Kokkos::View<int *, DeviceType> indices,
+               Kokkos::View<int *, DeviceType> offset,
+               Kokkos::View<int *, DeviceType> ranks, int q )
+{
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    std::set<std::pair<int, int>> results;
+    for ( int j = offset_host( q ); j < offset_host( q + 1 ); ++j )
+        results.emplace( ranks_host( j ), indices_host( j ) );
+    return results;
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( HybridSearchTree, same_as_distributed,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // Every process owns a slab of n^3 points of a structured grid with unit
+    // spacing, stacked along the z-axis.
+    int const n = 4;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes",
+                                                            n * n * n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n * n * n; ++i )
+    {
+        double const x = i % n;
+        double const y = ( i / n ) % n;
+        double const z = comm_rank * n + i / ( n * n );
+        boxes_host( i ) = {{x, x, y, y, z, z}};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::DistributedSearchTree<DeviceType> distributed_tree(
+        comm, boxes );
+    DataTransferKit::HybridSearchTree<DeviceType> hybrid_tree( comm, boxes );
+    TEST_COMPARE( hybrid_tree.getNodeSize(), >=, 1 );
+
+    // the queries straddle the slabs of neighboring processes, the last
+    // process does not have any, and stay clear of ties between the nearest
+    // neighbors
+    int const n_queries = ( comm_rank < comm_size - 1 ) ? 3 : 0;
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        within_queries( "within_queries", n_queries );
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        nearest_queries( "nearest_queries", n_queries );
+    auto within_queries_host = Kokkos::create_mirror_view( within_queries );
+    auto nearest_queries_host = Kokkos::create_mirror_view( nearest_queries );
+    for ( int q = 0; q < n_queries; ++q )
+    {
+        DataTransferKit::Point const p = {
+            {1.1 + 0.9 * q, 2.2 - 0.3 * q, ( comm_rank + 1 ) * n - 0.4}};
+        within_queries_host( q ) = details::within( p, 1.5 + q );
+        nearest_queries_host( q ) = details::nearest( p, 3 + q );
+    }
+    Kokkos::deep_copy( within_queries, within_queries_host );
+    Kokkos::deep_copy( nearest_queries, nearest_queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    Kokkos::View<int *, DeviceType> ref_indices( "ref_indices" );
+    Kokkos::View<int *, DeviceType> ref_offset( "ref_offset" );
+    Kokkos::View<int *, DeviceType> ref_ranks( "ref_ranks" );
+
+    hybrid_tree.query( within_queries, indices, offset, ranks );
+    distributed_tree.query( within_queries, ref_indices, ref_offset,
+                            ref_ranks );
+    TEST_EQUALITY( offset.extent( 0 ), n_queries + 1 );
+    for ( int q = 0; q < n_queries; ++q )
+    {
+        auto const ref_results =
+            gatherResults( ref_indices, ref_offset, ref_ranks, q );
+        TEST_ASSERT( !ref_results.empty() );
+        TEST_ASSERT( gatherResults( indices, offset, ranks, q ) ==
+                     ref_results );
+    }
+
+    hybrid_tree.query( nearest_queries, indices, offset, ranks );
+    distributed_tree.query( nearest_queries, ref_indices, ref_offset,
+                            ref_ranks );
+    TEST_EQUALITY( offset.extent( 0 ), n_queries + 1 );
+    for ( int q = 0; q < n_queries; ++q )
+        TEST_ASSERT( gatherResults( indices, offset, ranks, q ) ==
+                     gatherResults( ref_indices, ref_offset, ref_ranks, q ) );
+}
+
+// Include the test macros.
+#include "DataTransferKitSearch_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( HybridSearchTree,                    \
+                                          same_as_distributed,                 \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests for the nodes whose device can access host memory
+#if defined( HAVE_TPETRA_INST_SERIAL )
+UNIT_TEST_GROUP( Kokkos_Compat_KokkosSerialWrapperNode )
+#endif
+#if defined( HAVE_TPETRA_INST_OPENMP )
+UNIT_TEST_GROUP( Kokkos_Compat_KokkosOpenMPWrapperNode )
+#endif
+#if defined( HAVE_TPETRA_INST_PTHREAD )
+UNIT_TEST_GROUP( Kokkos_Compat_KokkosThreadsWrapperNode )
+#endif
@@ -342,6 +342,31 @@ std::vector<std::array<double, 3>> make_random_cloud( double Lx, double Ly,
     return cloud;
 }
 
+// Cubes of side 2 * half_side centered at the points of the cloud, the
+// points themselves by default.
+template <typename DeviceType>
+Kokkos::View<DataTransferKit::Box *, DeviceType>
+makeBoundingBoxes( std::vector<std::array<double, 3>> const &cloud,
+                   double half_side = 0. )
+{
+    int const n = cloud.size();
+    Kokkos::View<DataTransferKit::Box *, DeviceType> bounding_boxes(
+        "bounding_boxes", n );
+    auto bounding_boxes_host = Kokkos::create_mirror_view( bounding_boxes );
+    for ( int i = 0; i < n; ++i )
+    {
+        double x = std::get<0>( cloud[i] );
+        double y = std::get<1>( cloud[i] );
+        double z = std::get<2>( cloud[i] );
+        bounding_boxes_host[i] = {
+            x - half_side, x + half_side, y - half_side,
+            y + half_side, z - half_side, z + half_side,
+        };
+    }
+    Kokkos::deep_copy( bounding_boxes, bounding_boxes_host );
+    return bounding_boxes;
+}
+
 TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, rtree, DeviceType )
 {
     namespace bg = boost::geometry;
@@ -369,22 +394,7 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, rtree, DeviceType )
         double z = std::get<2>( point );
         rtree.insert( std::make_pair( BPoint( x, y, z ), i ) );
     }
-    Kokkos::View<DataTransferKit::Box *, DeviceType> bounding_boxes(
-        "bounding_boxes", n );
-    auto bounding_boxes_host = Kokkos::create_mirror_view( bounding_boxes );
-    // build bounding volume hierarchy
-    for ( int i = 0; i < n; ++i )
-    {
-        auto const &point = cloud[i];
-        double x = std::get<0>( point );
-        double y = std::get<1>( point );
-        double z = std::get<2>( point );
-        bounding_boxes_host[i] = {
-            x, x, y, y, z, z,
-        };
-    }
-
-    Kokkos::deep_copy( bounding_boxes, bounding_boxes_host );
+    auto const bounding_boxes = makeBoundingBoxes<DeviceType>( cloud );
 
     DataTransferKit::BVH<DeviceType> bvh( bounding_boxes );
 
@@ -451,8 +461,8 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, rtree, DeviceType )
     Kokkos::deep_copy( radii, radii_host );
     Kokkos::deep_copy( k, k_host );
 
-    Kokkos::View<details::Nearest *, DeviceType> nearest_queries(
-        "neatest_queries", n_points );
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        nearest_queries( "neatest_queries", n_points );
     Kokkos::parallel_for( "register_nearest_queries",
                           Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
                           KOKKOS_LAMBDA( int i ) {
@@ -463,8 +473,8 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, rtree, DeviceType )
                           } );
     Kokkos::fence();
 
-    Kokkos::View<details::Within *, DeviceType> within_queries(
-        "within_queries", n_points );
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        within_queries( "within_queries", n_points );
     Kokkos::parallel_for( "register_within_queries",
                           Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
                           KOKKOS_LAMBDA( int i ) {
@@ -511,6 +521,464 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, rtree, DeviceType )
     }
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, any_hit, DeviceType )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    double Lx = 10.0;
+    double Ly = 10.0;
+    double Lz = 10.0;
+    int nx = 11;
+    int ny = 11;
+    int nz = 11;
+    auto cloud = make_stuctured_cloud( Lx, Ly, Lz, nx, ny, nz );
+
+    auto const bounding_boxes = makeBoundingBoxes<DeviceType>( cloud );
+
+    DataTransferKit::BVH<DeviceType> bvh( bounding_boxes );
+
+    // random points with radii small enough that some of the queries do not
+    // find anything
+    int const n_points = 100;
+    auto queries = make_random_cloud( Lx, Ly, Lz, n_points );
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        within_queries( "within_queries", n_points );
+    auto within_queries_host = Kokkos::create_mirror_view( within_queries );
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> distribution_radius( 0.0, 0.6 );
+    for ( int i = 0; i < n_points; ++i )
+    {
+        auto const &point = queries[i];
+        within_queries_host( i ) = details::within(
+            {std::get<0>( point ), std::get<1>( point ), std::get<2>( point )},
+            distribution_radius( generator ) );
+    }
+    Kokkos::deep_copy( within_queries, within_queries_host );
+
+    Kokkos::View<bool *, DeviceType> found( "found" );
+    bvh.queryAny( within_queries, found );
+    TEST_EQUALITY( found.extent( 0 ), n_points );
+
+    // compare against the full query
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    bvh.query( within_queries, indices, offset );
+
+    auto found_host = Kokkos::create_mirror_view( found );
+    Kokkos::deep_copy( found_host, found );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    for ( int i = 0; i < n_points; ++i )
+        TEST_EQUALITY( found_host( i ),
+                       offset_host( i + 1 ) > offset_host( i ) );
+
+    // empty box and a box that contains the whole scene
+    Kokkos::View<details::Overlap *, DeviceType> overlap_queries(
+        "overlap_queries", 2 );
+    Kokkos::parallel_for( "register_overlap_queries",
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, 1 ),
+                          KOKKOS_LAMBDA( int ) {
+                              overlap_queries( 0 ) =
+                                  details::overlap( DataTransferKit::Box() );
+                              overlap_queries( 1 ) =
+                                  details::overlap( DataTransferKit::Box(
+                                      {-1.0, 11.0, -1.0, 11.0, -1.0, 11.0} ) );
+                          } );
+    Kokkos::fence();
+    bvh.queryAny( overlap_queries, found );
+    Kokkos::deep_copy( found_host, found );
+    TEST_ASSERT( !found_host( 0 ) );
+    TEST_ASSERT( found_host( 1 ) );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, predicate_combinators,
+                                   DeviceType )
+{
+    double Lx = 10.0;
+    double Ly = 10.0;
+    double Lz = 10.0;
+    int nx = 11;
+    int ny = 11;
+    int nz = 11;
+    auto cloud = make_stuctured_cloud( Lx, Ly, Lz, nx, ny, nz );
+    int n = cloud.size();
+
+    auto const bounding_boxes = makeBoundingBoxes<DeviceType>( cloud );
+    auto bounding_boxes_host = Kokkos::create_mirror_view( bounding_boxes );
+    Kokkos::deep_copy( bounding_boxes_host, bounding_boxes );
+
+    DataTransferKit::BVH<DeviceType> bvh( bounding_boxes );
+
+    // sphere centered at the middle of the domain and box that covers the
+    // upper half of it
+    DataTransferKit::Point const center = {5.0, 5.0, 5.0};
+    double const radius = 3.0;
+    DataTransferKit::Box const box( {-1.0, 11.0, -1.0, 11.0, 5.0, 11.0} );
+
+    // reference solution
+    std::set<int> ref_and;
+    std::set<int> ref_or;
+    std::set<int> ref_and_not;
+    for ( int i = 0; i < n; ++i )
+    {
+        bool const in_sphere =
+            details::distance( center, bounding_boxes_host[i] ) <= radius;
+        bool const in_box = details::overlaps( box, bounding_boxes_host[i] );
+        if ( in_sphere && in_box )
+            ref_and.insert( i );
+        if ( in_sphere || in_box )
+            ref_or.insert( i );
+        if ( in_sphere && !in_box )
+            ref_and_not.insert( i );
+    }
+
+    auto check = [&out, &success]( std::set<int> const &ref,
+                                   Kokkos::View<int *, DeviceType> indices,
+                                   Kokkos::View<int *, DeviceType> offset ) {
+        auto indices_host = Kokkos::create_mirror_view( indices );
+        Kokkos::deep_copy( indices_host, indices );
+        auto offset_host = Kokkos::create_mirror_view( offset );
+        Kokkos::deep_copy( offset_host, offset );
+        TEST_EQUALITY( offset_host.extent( 0 ), 2 );
+        std::set<int> found;
+        for ( int j = offset_host( 0 ); j < offset_host( 1 ); ++j )
+            found.insert( indices_host( j ) );
+        TEST_EQUALITY( found.size(), offset_host( 1 ) );
+        TEST_ASSERT( found == ref );
+    };
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+
+    using WithinAndOverlap =
+        details::And<details::Within<DataTransferKit::Point>, details::Overlap>;
+    Kokkos::View<WithinAndOverlap *, DeviceType> and_queries( "and_queries",
+                                                              1 );
+    auto and_queries_host = Kokkos::create_mirror_view( and_queries );
+    and_queries_host( 0 ) =
+        details::within( center, radius ) && details::overlap( box );
+    Kokkos::deep_copy( and_queries, and_queries_host );
+    bvh.query( and_queries, indices, offset );
+    check( ref_and, indices, offset );
+
+    using WithinOrOverlap =
+        details::Or<details::Within<DataTransferKit::Point>, details::Overlap>;
+    Kokkos::View<WithinOrOverlap *, DeviceType> or_queries( "or_queries", 1 );
+    auto or_queries_host = Kokkos::create_mirror_view( or_queries );
+    or_queries_host( 0 ) =
+        details::within( center, radius ) || details::overlap( box );
+    Kokkos::deep_copy( or_queries, or_queries_host );
+    bvh.query( or_queries, indices, offset );
+    check( ref_or, indices, offset );
+
+    using WithinAndNotOverlap =
+        details::And<details::Within<DataTransferKit::Point>,
+                     details::Not<details::Overlap>>;
+    Kokkos::View<WithinAndNotOverlap *, DeviceType> and_not_queries(
+        "and_not_queries", 1 );
+    auto and_not_queries_host = Kokkos::create_mirror_view( and_not_queries );
+    and_not_queries_host( 0 ) =
+        details::within( center, radius ) && !details::overlap( box );
+    Kokkos::deep_copy( and_not_queries, and_not_queries_host );
+    bvh.query( and_not_queries, indices, offset );
+    check( ref_and_not, indices, offset );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, mixed_predicates, DeviceType )
+{
+    double Lx = 10.0;
+    double Ly = 10.0;
+    double Lz = 10.0;
+    int nx = 11;
+    int ny = 11;
+    int nz = 11;
+    auto cloud = make_stuctured_cloud( Lx, Ly, Lz, nx, ny, nz );
+
+    auto const bounding_boxes = makeBoundingBoxes<DeviceType>( cloud );
+
+    DataTransferKit::BVH<DeviceType> bvh( bounding_boxes );
+
+    // interleave nearest and radius searches in a single batch
+    int const n_queries = 20;
+    using Query =
+        details::PredicateVariant<details::Nearest<DataTransferKit::Point>,
+                                  details::Within<DataTransferKit::Point>>;
+    Kokkos::View<Query *, DeviceType> queries( "queries", n_queries );
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        nearest_queries( "nearest_queries", n_queries / 2 );
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        within_queries( "within_queries", n_queries / 2 );
+    auto queries_host = Kokkos::create_mirror_view( queries );
+    auto nearest_queries_host = Kokkos::create_mirror_view( nearest_queries );
+    auto within_queries_host = Kokkos::create_mirror_view( within_queries );
+    for ( int i = 0; i < n_queries / 2; ++i )
+    {
+        DataTransferKit::Point const p = {0.5 * i, 10.0 - 0.5 * i, 0.3 * i};
+        nearest_queries_host( i ) = details::nearest( p, 1 + i % 4 );
+        within_queries_host( i ) = details::within( p, 0.5 + 0.25 * i );
+        // alternate in a pattern that is not trivially sorted
+        queries_host( 2 * i + ( i % 3 == 0 ? 1 : 0 ) ) =
+            nearest_queries_host( i );
+        queries_host( 2 * i + ( i % 3 == 0 ? 0 : 1 ) ) =
+            within_queries_host( i );
+    }
+    Kokkos::deep_copy( queries, queries_host );
+    Kokkos::deep_copy( nearest_queries, nearest_queries_host );
+    Kokkos::deep_copy( within_queries, within_queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    bvh.query( queries, indices, offset );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    TEST_EQUALITY( offset_host.extent( 0 ), n_queries + 1 );
+
+    // compare against the homogeneous batches
+    auto check = [&]( Kokkos::View<int *, DeviceType> ref_indices,
+                      Kokkos::View<int *, DeviceType> ref_offset, int i,
+                      int q ) {
+        auto ref_indices_host = Kokkos::create_mirror_view( ref_indices );
+        Kokkos::deep_copy( ref_indices_host, ref_indices );
+        auto ref_offset_host = Kokkos::create_mirror_view( ref_offset );
+        Kokkos::deep_copy( ref_offset_host, ref_offset );
+        std::set<int> ref;
+        for ( int j = ref_offset_host( i ); j < ref_offset_host( i + 1 ); ++j )
+            ref.insert( ref_indices_host( j ) );
+        std::set<int> found;
+        for ( int j = offset_host( q ); j < offset_host( q + 1 ); ++j )
+            found.insert( indices_host( j ) );
+        TEST_EQUALITY( offset_host( q + 1 ) - offset_host( q ),
+                       ref_offset_host( i + 1 ) - ref_offset_host( i ) );
+        TEST_ASSERT( found == ref );
+    };
+
+    Kokkos::View<int *, DeviceType> nearest_indices( "nearest_indices" );
+    Kokkos::View<int *, DeviceType> nearest_offset( "nearest_offset" );
+    bvh.query( nearest_queries, nearest_indices, nearest_offset );
+    Kokkos::View<int *, DeviceType> within_indices( "within_indices" );
+    Kokkos::View<int *, DeviceType> within_offset( "within_offset" );
+    bvh.query( within_queries, within_indices, within_offset );
+    for ( int i = 0; i < n_queries / 2; ++i )
+    {
+        check( nearest_indices, nearest_offset, i,
+               2 * i + ( i % 3 == 0 ? 1 : 0 ) );
+        check( within_indices, within_offset, i,
+               2 * i + ( i % 3 == 0 ? 0 : 1 ) );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, box_queries, DeviceType )
+{
+    double Lx = 10.0;
+    double Ly = 10.0;
+    double Lz = 10.0;
+    int nx = 11;
+    int ny = 11;
+    int nz = 11;
+    auto cloud = make_stuctured_cloud( Lx, Ly, Lz, nx, ny, nz );
+    int n = cloud.size();
+
+    // cubes of side 0.5 centered at the points of the cloud
+    auto const bounding_boxes = makeBoundingBoxes<DeviceType>( cloud, .25 );
+    auto bounding_boxes_host = Kokkos::create_mirror_view( bounding_boxes );
+    Kokkos::deep_copy( bounding_boxes_host, bounding_boxes );
+
+    DataTransferKit::BVH<DeviceType> bvh( bounding_boxes );
+
+    int const n_queries = 50;
+    auto centers = make_random_cloud( Lx, Ly, Lz, n_queries );
+    Kokkos::View<details::Nearest<DataTransferKit::Box> *, DeviceType>
+        nearest_queries( "nearest_queries", n_queries );
+    Kokkos::View<details::Within<DataTransferKit::Box> *, DeviceType>
+        within_queries( "within_queries", n_queries );
+    auto nearest_queries_host = Kokkos::create_mirror_view( nearest_queries );
+    auto within_queries_host = Kokkos::create_mirror_view( within_queries );
+    std::vector<DataTransferKit::Box> query_boxes( n_queries );
+    std::vector<int> k( n_queries );
+    std::vector<double> radii( n_queries );
+    for ( int i = 0; i < n_queries; ++i )
+    {
+        double x = std::get<0>( centers[i] );
+        double y = std::get<1>( centers[i] );
+        double z = std::get<2>( centers[i] );
+        double h = 0.1 * ( i % 7 );
+        query_boxes[i] = {x - h, x + h, y - 2. * h, y + 2. * h, z, z + h};
+        k[i] = 1 + i % 5;
+        radii[i] = 0.2 * ( i % 4 );
+        nearest_queries_host( i ) = details::nearest( query_boxes[i], k[i] );
+        within_queries_host( i ) = details::within( query_boxes[i], radii[i] );
+    }
+    Kokkos::deep_copy( nearest_queries, nearest_queries_host );
+    Kokkos::deep_copy( within_queries, within_queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+
+    // the nearest boxes are not unique in general so compare the distances
+    bvh.query( nearest_queries, indices, offset );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    for ( int i = 0; i < n_queries; ++i )
+    {
+        std::vector<double> ref( n );
+        for ( int j = 0; j < n; ++j )
+            ref[j] =
+                details::distance( query_boxes[i], bounding_boxes_host[j] );
+        std::sort( ref.begin(), ref.end() );
+        ref.resize( k[i] );
+        std::vector<double> found;
+        for ( int j = offset_host( i ); j < offset_host( i + 1 ); ++j )
+            found.push_back( details::distance(
+                query_boxes[i], bounding_boxes_host[indices_host( j )] ) );
+        std::sort( found.begin(), found.end() );
+        TEST_COMPARE_FLOATING_ARRAYS( found, ref, 1e-14 );
+    }
+
+    bvh.query( within_queries, indices, offset );
+    indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    for ( int i = 0; i < n_queries; ++i )
+    {
+        std::set<int> ref;
+        for ( int j = 0; j < n; ++j )
+            if ( details::distance( query_boxes[i], bounding_boxes_host[j] ) <=
+                 radii[i] )
+                ref.insert( j );
+        std::set<int> found;
+        for ( int j = offset_host( i ); j < offset_host( i + 1 ); ++j )
+            found.insert( indices_host( j ) );
+        TEST_EQUALITY( found.size(), offset_host( i + 1 ) - offset_host( i ) );
+        TEST_ASSERT( found == ref );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, approximate_nearest,
+                                   DeviceType )
+{
+    double Lx = 10.0;
+    double Ly = 10.0;
+    double Lz = 10.0;
+    int n = 2000;
+    auto cloud = make_random_cloud( Lx, Ly, Lz, n );
+
+    auto const bounding_boxes = makeBoundingBoxes<DeviceType>( cloud );
+    auto bounding_boxes_host = Kokkos::create_mirror_view( bounding_boxes );
+    Kokkos::deep_copy( bounding_boxes_host, bounding_boxes );
+
+    DataTransferKit::BVH<DeviceType> bvh( bounding_boxes );
+
+    int const n_queries = 100;
+    auto points = make_random_cloud( Lx, Ly, Lz, n_queries );
+    std::vector<DataTransferKit::Point> query_points( n_queries );
+    std::vector<int> k( n_queries );
+    for ( int i = 0; i < n_queries; ++i )
+    {
+        query_points[i] = {std::get<0>( points[i] ), std::get<1>( points[i] ),
+                           std::get<2>( points[i] )};
+        k[i] = 1 + i % 20;
+    }
+    // more neighbors than the candidate queue of the approximate search can
+    // hold
+    k[0] = 300;
+
+    // the distance to the i-th neighbor found must be within a factor
+    // (1 + eps) of the distance to the true i-th nearest neighbor
+    for ( double eps : {1e-12, 0.1, 1.} )
+    {
+        Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+            queries( "queries", n_queries );
+        auto queries_host = Kokkos::create_mirror_view( queries );
+        for ( int i = 0; i < n_queries; ++i )
+            queries_host( i ) = details::nearest( query_points[i], k[i], eps );
+        Kokkos::deep_copy( queries, queries_host );
+
+        Kokkos::View<int *, DeviceType> indices( "indices" );
+        Kokkos::View<int *, DeviceType> offset( "offset" );
+        bvh.query( queries, indices, offset );
+        auto indices_host = Kokkos::create_mirror_view( indices );
+        Kokkos::deep_copy( indices_host, indices );
+        auto offset_host = Kokkos::create_mirror_view( offset );
+        Kokkos::deep_copy( offset_host, offset );
+
+        for ( int i = 0; i < n_queries; ++i )
+        {
+            std::vector<double> ref( n );
+            for ( int j = 0; j < n; ++j )
+                ref[j] = details::distance( query_points[i],
+                                            bounding_boxes_host[j] );
+            std::sort( ref.begin(), ref.end() );
+            std::vector<double> found;
+            for ( int j = offset_host( i ); j < offset_host( i + 1 ); ++j )
+                found.push_back( details::distance(
+                    query_points[i], bounding_boxes_host[indices_host( j )] ) );
+            // the neighbors are reported by increasing distance
+            TEST_ASSERT( std::is_sorted( found.begin(), found.end() ) );
+            TEST_EQUALITY( static_cast<int>( found.size() ), k[i] );
+            for ( int j = 0; j < static_cast<int>( found.size() ); ++j )
+                TEST_COMPARE( found[j], <=, ( 1. + eps ) * ref[j] );
+        }
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, degenerate_trees, DeviceType )
+{
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+
+    Kokkos::View<details::Overlap *, DeviceType> overlap_queries(
+        "overlap_queries", 2 );
+    auto overlap_queries_host = Kokkos::create_mirror_view( overlap_queries );
+    overlap_queries_host( 0 ) =
+        details::overlap( DataTransferKit::Box( {0., 1., 0., 1., 0., 1.} ) );
+    overlap_queries_host( 1 ) =
+        details::overlap( DataTransferKit::Box( {2., 3., 2., 3., 2., 3.} ) );
+    Kokkos::deep_copy( overlap_queries, overlap_queries_host );
+
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        nearest_queries( "nearest_queries", 1 );
+    auto nearest_queries_host = Kokkos::create_mirror_view( nearest_queries );
+    nearest_queries_host( 0 ) = details::nearest( {5., 5., 5.}, 2 );
+    Kokkos::deep_copy( nearest_queries, nearest_queries_host );
+
+    // tree with no object does not find anything
+    Kokkos::View<DataTransferKit::Box *, DeviceType> no_box( "no_box", 0 );
+    DataTransferKit::BVH<DeviceType> empty_bvh( no_box );
+    TEST_ASSERT( empty_bvh.empty() );
+    TEST_EQUALITY( empty_bvh.size(), 0 );
+    TEST_ASSERT( !details::overlaps( empty_bvh.bounds(),
+                                     empty_bvh.bounds() ) );
+    empty_bvh.query( overlap_queries, indices, offset );
+    TEST_EQUALITY( indices.extent( 0 ), 0 );
+    empty_bvh.query( nearest_queries, indices, offset );
+    TEST_EQUALITY( indices.extent( 0 ), 0 );
+
+    // the root of a tree with a single object is a leaf
+    Kokkos::View<DataTransferKit::Box *, DeviceType> one_box( "one_box", 1 );
+    auto one_box_host = Kokkos::create_mirror_view( one_box );
+    one_box_host( 0 ) = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5};
+    Kokkos::deep_copy( one_box, one_box_host );
+    DataTransferKit::BVH<DeviceType> bvh( one_box );
+    TEST_ASSERT( !bvh.empty() );
+    TEST_EQUALITY( bvh.size(), 1 );
+    bvh.query( overlap_queries, indices, offset );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    TEST_EQUALITY( offset_host( 0 ), 0 );
+    TEST_EQUALITY( offset_host( 1 ), 1 );
+    TEST_EQUALITY( offset_host( 2 ), 1 );
+    TEST_EQUALITY( indices_host( 0 ), 0 );
+    bvh.query( nearest_queries, indices, offset );
+    TEST_EQUALITY( indices.extent( 0 ), 1 );
+}
+
 // Include the test macros.
 #include "DataTransferKitSearch_ETIHelperMacros.h"
 
@@ -521,7 +989,19 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( LinearBVH, rtree, DeviceType )
                                           DeviceType##NODE )                   \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, structured_grid,          \
                                           DeviceType##NODE )                   \
-    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, rtree, DeviceType##NODE )
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, rtree, DeviceType##NODE ) \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, any_hit,                  \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, predicate_combinators,    \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, mixed_predicates,         \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, box_queries,              \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, approximate_nearest,      \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( LinearBVH, degenerate_trees,         \
+                                          DeviceType##NODE )
 
 // Demangle the types
 DTK_ETI_MANGLING_TYPEDEFS()
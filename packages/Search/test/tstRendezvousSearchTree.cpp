@@ -0,0 +1,140 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_RendezvousSearchTree.hpp>
+
+#include <Teuchos_CommHelpers.hpp>
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <cmath>
+#include <set>
+#include <utility>
+
+namespace details = DataTransferKit::Details;
+
+template <typename DeviceType>
+std::set<std::pair<int, int>>
+gatherResults( Kokkos::View<int *, DeviceType> indices,
+               Kokkos::View<int *, DeviceType> offset,
+               Kokkos::View<int *, DeviceType> ranks, int q )
+{
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    std::set<std::pair<int, int>> results;
+    for ( int j = offset_host( q ); j < offset_host( q + 1 ); ++j )
+        results.emplace( ranks_host( j ), indices_host( j ) );
+    return results;
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( RendezvousSearchTree, unbalanced,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+    int const comm_size = comm->getSize();
+
+    // All the objects are owned by the first process. They are the points
+    // of a structured grid with n^3 points and unit spacing.
+    int const n = 8;
+    auto coordinates = []( int i, double x[3] ) {
+        x[0] = i % n;
+        x[1] = ( i / n ) % n;
+        x[2] = i / ( n * n );
+    };
+    int const n_local = ( comm_rank == 0 ) ? n * n * n : 0;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes",
+                                                            n_local );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n_local; ++i )
+    {
+        double x[3];
+        coordinates( i, x );
+        boxes_host( i ) = {x[0], x[0], x[1], x[1], x[2], x[2]};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::RendezvousSearchTree<DeviceType> tree( comm, boxes );
+
+    // the objects are spread evenly over the processes
+    int const n_rendezvous = tree.size();
+    int n_total = 0;
+    int n_max = 0;
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_SUM, n_rendezvous,
+                        Teuchos::ptr( &n_total ) );
+    Teuchos::reduceAll( *comm, Teuchos::REDUCE_MAX, n_rendezvous,
+                        Teuchos::ptr( &n_max ) );
+    TEST_EQUALITY( n_total, n * n * n );
+    TEST_COMPARE( n_max, <=, 2 * n * n * n / comm_size );
+
+    // every process searches around a different point
+    double const x_0[3] = {1. + comm_rank, 2., 3.};
+    double const radius = 1.5;
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        within_queries( "within_queries", 1 );
+    auto within_queries_host = Kokkos::create_mirror_view( within_queries );
+    within_queries_host( 0 ) =
+        details::within( {x_0[0], x_0[1], x_0[2]}, radius );
+    Kokkos::deep_copy( within_queries, within_queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ranks( "ranks" );
+    tree.query( within_queries, indices, offset, ranks );
+
+    auto distance = [&x_0, &coordinates]( int i ) {
+        double x[3];
+        coordinates( i, x );
+        return std::sqrt( ( x[0] - x_0[0] ) * ( x[0] - x_0[0] ) +
+                          ( x[1] - x_0[1] ) * ( x[1] - x_0[1] ) +
+                          ( x[2] - x_0[2] ) * ( x[2] - x_0[2] ) );
+    };
+    std::set<std::pair<int, int>> ref;
+    for ( int i = 0; i < n * n * n; ++i )
+        if ( distance( i ) <= radius )
+            ref.emplace( 0, i );
+    TEST_ASSERT( !ref.empty() );
+    TEST_ASSERT( gatherResults( indices, offset, ranks, 0 ) == ref );
+
+    // the nearest neighbor is also mapped back to its original owner
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        nearest_queries( "nearest_queries", 1 );
+    auto nearest_queries_host = Kokkos::create_mirror_view( nearest_queries );
+    nearest_queries_host( 0 ) =
+        details::nearest( {x_0[0] + .1, x_0[1], x_0[2]}, 1 );
+    Kokkos::deep_copy( nearest_queries, nearest_queries_host );
+
+    tree.query( nearest_queries, indices, offset, ranks );
+
+    ref.clear();
+    ref.emplace( 0, static_cast<int>( x_0[0] ) +
+                        n * ( static_cast<int>( x_0[1] ) +
+                              n * static_cast<int>( x_0[2] ) ) );
+    TEST_ASSERT( gatherResults( indices, offset, ranks, 0 ) == ref );
+}
+
+// Include the test macros.
+#include "DataTransferKitSearch_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( RendezvousSearchTree, unbalanced,    \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
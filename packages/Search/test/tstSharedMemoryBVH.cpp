@@ -0,0 +1,113 @@
+/****************************************************************************
+ * Copyright (c) 2012-2017 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ ****************************************************************************/
+
+#include <DTK_LinearBVH.hpp>
+#include <DTK_SharedMemoryBVH.hpp>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <set>
+
+namespace details = DataTransferKit::Details;
+
+template <typename DeviceType>
+std::set<int> gatherResults( Kokkos::View<int *, DeviceType> indices,
+                             Kokkos::View<int *, DeviceType> offset, int q )
+{
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    Kokkos::deep_copy( indices_host, indices );
+    auto offset_host = Kokkos::create_mirror_view( offset );
+    Kokkos::deep_copy( offset_host, offset );
+    return std::set<int>( indices_host.data() + offset_host( q ),
+                          indices_host.data() + offset_host( q + 1 ) );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SharedMemoryBVH, same_as_local_bvh,
+                                   DeviceType )
+{
+    Teuchos::RCP<const Teuchos::Comm<int>> comm =
+        Teuchos::DefaultComm<int>::getComm();
+    int const comm_rank = comm->getRank();
+
+    // The objects are the points of a structured grid with n^3 points and
+    // unit spacing. Every process passes them but only the first process on
+    // each node actually uses them.
+    int const n = 8;
+    Kokkos::View<DataTransferKit::Box *, DeviceType> boxes( "boxes",
+                                                            n * n * n );
+    auto boxes_host = Kokkos::create_mirror_view( boxes );
+    for ( int i = 0; i < n * n * n; ++i )
+    {
+        double const x = i % n;
+        double const y = ( i / n ) % n;
+        double const z = i / ( n * n );
+        boxes_host( i ) = {x, x, y, y, z, z};
+    }
+    Kokkos::deep_copy( boxes, boxes_host );
+
+    DataTransferKit::BVH<DeviceType> local_bvh( boxes );
+    DataTransferKit::SharedMemoryBVH<DeviceType> shared_bvh( comm, boxes );
+
+    TEST_EQUALITY( shared_bvh.size(), local_bvh.size() );
+    for ( int d = 0; d < 6; ++d )
+        TEST_EQUALITY( shared_bvh.bounds()[d], local_bvh.bounds()[d] );
+
+    // every process searches around a different point
+    DataTransferKit::Point const p = {1. + comm_rank, 2.1, 3.2};
+    Kokkos::View<details::Within<DataTransferKit::Point> *, DeviceType>
+        within_queries( "within_queries", 1 );
+    auto within_queries_host = Kokkos::create_mirror_view( within_queries );
+    within_queries_host( 0 ) = details::within( p, 1.5 );
+    Kokkos::deep_copy( within_queries, within_queries_host );
+
+    Kokkos::View<int *, DeviceType> indices( "indices" );
+    Kokkos::View<int *, DeviceType> offset( "offset" );
+    Kokkos::View<int *, DeviceType> ref_indices( "ref_indices" );
+    Kokkos::View<int *, DeviceType> ref_offset( "ref_offset" );
+    shared_bvh.query( within_queries, indices, offset );
+    local_bvh.query( within_queries, ref_indices, ref_offset );
+    TEST_ASSERT( !gatherResults( ref_indices, ref_offset, 0 ).empty() );
+    TEST_ASSERT( gatherResults( indices, offset, 0 ) ==
+                 gatherResults( ref_indices, ref_offset, 0 ) );
+
+    Kokkos::View<details::Nearest<DataTransferKit::Point> *, DeviceType>
+        nearest_queries( "nearest_queries", 1 );
+    auto nearest_queries_host = Kokkos::create_mirror_view( nearest_queries );
+    nearest_queries_host( 0 ) = details::nearest( p, 5 );
+    Kokkos::deep_copy( nearest_queries, nearest_queries_host );
+
+    shared_bvh.query( nearest_queries, indices, offset );
+    local_bvh.query( nearest_queries, ref_indices, ref_offset );
+    TEST_ASSERT( gatherResults( indices, offset, 0 ) ==
+                 gatherResults( ref_indices, ref_offset, 0 ) );
+}
+
+// Include the test macros.
+#include "DataTransferKitSearch_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SharedMemoryBVH, same_as_local_bvh,  \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests for the nodes whose device can access host memory
+#if defined( HAVE_TPETRA_INST_SERIAL )
+UNIT_TEST_GROUP( Kokkos_Compat_KokkosSerialWrapperNode )
+#endif
+#if defined( HAVE_TPETRA_INST_OPENMP )
+UNIT_TEST_GROUP( Kokkos_Compat_KokkosOpenMPWrapperNode )
+#endif
+#if defined( HAVE_TPETRA_INST_PTHREAD )
+UNIT_TEST_GROUP( Kokkos_Compat_KokkosThreadsWrapperNode )
+#endif